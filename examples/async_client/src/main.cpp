@@ -0,0 +1,92 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        auto server = nanorpc::http::easy::make_server("127.0.0.1", "55602", 4, "/api/",
+                std::pair{"slow", [] (int value)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+                        return value * 2;
+                    }
+                }
+            );
+
+        // The client has one worker, the calls wait for their responses at the same time.
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55602", 1, "/api/");
+        using result_type = decltype(client)::result_type;
+
+        auto const start = std::chrono::steady_clock::now();
+
+        std::vector<std::future<result_type>> futures;
+        for (int i = 0 ; i < 4 ; ++i)
+            futures.push_back(client.async_call("slow", i));
+
+        for (int i = 0 ; i < 4 ; ++i)
+        {
+            int value = futures[i].get();
+            if (value != i * 2)
+                throw std::runtime_error{"Unexpected response of \"slow\"."};
+        }
+
+        auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        std::cout << "Client. 4 calls of \"slow\" took " << time << " ms." << std::endl;
+        if (time >= 4 * 200)
+            throw std::runtime_error{"The calls of \"slow\" have not been made at the same time."};
+
+        // The callback is called on a thread of the client.
+        std::promise<int> done;
+        client.async_call([&done] (std::exception_ptr exception, result_type result)
+                {
+                    if (exception)
+                        done.set_exception(exception);
+                    else
+                        done.set_value(result.as<int>());
+                },
+                "slow", 5
+            );
+
+        auto const value = done.get_future().get();
+        std::cout << "Client. Callback of \"slow\" Output: " << value << std::endl;
+        if (value != 10)
+            throw std::runtime_error{"Unexpected response of \"slow\" in the callback."};
+
+        try
+        {
+            client.async_call("unknown").get();
+            throw std::runtime_error{"The call of an unknown method has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"unknown\" Error: " << e.what() << std::endl;
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
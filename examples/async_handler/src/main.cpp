@@ -0,0 +1,120 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/promise.h>
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    std::mutex lock;
+    std::vector<std::thread> threads;
+
+    auto join = [&]
+        {
+            std::lock_guard guard{lock};
+            for (auto &i : threads)
+                i.join();
+            threads.clear();
+        };
+
+    try
+    {
+        // The server has one worker, it doesn't wait for the asynchronous handlers.
+        auto server = nanorpc::http::easy::make_server("127.0.0.1", "55601", 1, "/api/",
+                std::pair{"slow", [&] (int value, nanorpc::core::promise<int> promise)
+                    {
+                        std::lock_guard guard{lock};
+                        threads.emplace_back([value, promise]
+                                {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+                                    promise.set_value(value * 2);
+                                }
+                            );
+                    }
+                },
+                std::pair{"fail", [] (nanorpc::core::promise<std::string> promise)
+                    {
+                        promise.set_exception(std::make_exception_ptr(std::runtime_error{"Failed."}));
+                    }
+                },
+                // The promise is dropped without a value, the call fails.
+                std::pair{"drop", [] (nanorpc::core::promise<void>) {} }
+            );
+
+        auto const start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> callers;
+        std::vector<int> results(8);
+        for (int i = 0 ; i < 8 ; ++i)
+        {
+            callers.emplace_back([i, &results]
+                    {
+                        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55601", 1, "/api/");
+                        results[i] = client.call("slow", i);
+                    }
+                );
+        }
+
+        for (auto &i : callers)
+            i.join();
+
+        auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        std::cout << "Client. 8 calls of \"slow\" took " << time << " ms." << std::endl;
+        if (time >= 8 * 200)
+            throw std::runtime_error{"The calls of \"slow\" have not been run at the same time."};
+
+        for (int i = 0 ; i < 8 ; ++i)
+        {
+            if (results[i] != i * 2)
+                throw std::runtime_error{"Unexpected response of \"slow\"."};
+        }
+
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55601", 1, "/api/");
+
+        try
+        {
+            client.call("fail");
+            throw std::runtime_error{"The \"fail\" call has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"fail\" Error: " << e.what() << std::endl;
+        }
+
+        try
+        {
+            client.call("drop");
+            throw std::runtime_error{"The \"drop\" call has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"drop\" Error: " << e.what() << std::endl;
+        }
+
+        join();
+    }
+    catch (std::exception const &e)
+    {
+        join();
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        auto server = nanorpc::http::easy::make_server("127.0.0.1", "55603", 4, "/api/",
+                std::pair{"slow", [] (int value)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+                        return value * 2;
+                    }
+                },
+                std::pair{"fail", [] () -> int { throw std::runtime_error{"Failed."}; } }
+            );
+
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55603", 1, "/api/");
+        using result_type = decltype(client)::result_type;
+
+        // All the calls are sent by one request, the server runs them at the same time.
+        auto batch = client.batch();
+
+        std::vector<std::future<result_type>> results;
+        for (int i = 0 ; i < 4 ; ++i)
+            results.push_back(batch.call("slow", i));
+        auto failed = batch.call("fail");
+
+        auto const start = std::chrono::steady_clock::now();
+        batch.send();
+        auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Client. The batch of 4 calls of \"slow\" took " << time << " ms." << std::endl;
+        if (time >= 4 * 200)
+            throw std::runtime_error{"The calls of the batch have not been run at the same time."};
+
+        for (int i = 0 ; i < 4 ; ++i)
+        {
+            int value = results[i].get();
+            if (value != i * 2)
+                throw std::runtime_error{"Unexpected response of \"slow\"."};
+        }
+
+        // A failed call doesn't fail the others.
+        try
+        {
+            failed.get();
+            throw std::runtime_error{"The \"fail\" call has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"fail\" Error: " << e.what() << std::endl;
+        }
+
+        // The batch can be used again after send.
+        auto next = batch.call("slow", 7);
+        batch.send();
+        if (next.get().as<int>() != 14)
+            throw std::runtime_error{"Unexpected response of \"slow\" in the second batch."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
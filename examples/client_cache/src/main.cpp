@@ -0,0 +1,120 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        std::atomic<int> executions{0};
+        std::atomic<int> rate{10};
+
+        // The server invalidates the cached responses by the core server shared with the http server.
+        auto core_server = std::make_shared<nanorpc::core::server<nanorpc::packer::plain_text>>();
+        core_server->handle("rate", [&] (std::string const &currency)
+                {
+                    ++executions;
+                    return currency + " " + std::to_string(rate.load());
+                }
+            );
+        core_server->handle("double", [&] (int value)
+                {
+                    ++executions;
+                    return value * 2;
+                }
+            );
+
+        nanorpc::core::type::async_executor_map executors;
+        executors.emplace("/api/", [core_server]
+                (nanorpc::core::type::buffer request, nanorpc::core::type::completion done)
+                {
+                    core_server->execute(std::move(request), std::move(done));
+                }
+            );
+
+        nanorpc::http::server server("127.0.0.1", "55616", 2, std::move(executors));
+        server.run();
+
+        // The client "tracking" gets the invalidations by a push, the client "polling"
+        // sees them by the epoch of its next response.
+        auto tracking = nanorpc::http::easy::make_client("127.0.0.1", "55616", 1, "/api/");
+        auto polling = nanorpc::http::easy::make_client("127.0.0.1", "55616", 1, "/api/");
+
+        for (auto *client : {&tracking, &polling})
+        {
+            client->cache("rate", {std::chrono::milliseconds{10000}});
+            client->cache("double", {std::chrono::milliseconds{10000}});
+        }
+
+        nanorpc::core::subscribe_options options;
+        options.hold = std::chrono::milliseconds{200};
+        auto invalidations = tracking.track_invalidations(options);
+
+        auto call = [&executions] (auto &client, std::string const &name, std::string const &expected,
+                                   int expected_executions)
+            {
+                std::string value = client.call("rate", std::string{"USD"});
+                std::cout << "Client \"" << name << "\". Method \"rate\" Output: " << value
+                          << " Executions: " << executions << std::endl;
+
+                if (value != expected || executions != expected_executions)
+                    throw std::runtime_error{"Unexpected response of \"rate\"."};
+            };
+
+        // The repeated calls are answered by the caches of the clients without a round trip.
+        call(tracking, "tracking", "USD 10", 1);
+        call(tracking, "tracking", "USD 10", 1);
+        call(polling, "polling", "USD 10", 2);
+        call(polling, "polling", "USD 10", 2);
+
+        if (static_cast<int>(tracking.call("double", 2)) != 4 || static_cast<int>(polling.call("double", 2)) != 4)
+            throw std::runtime_error{"Unexpected response of \"double\"."};
+        if (executions != 4)
+            throw std::runtime_error{"Unexpected executions of \"double\"."};
+
+        // The data of "rate" is changed, the server advances its epoch.
+        rate = 11;
+        core_server->invalidate("rate");
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+        // The tracking client has dropped the responses of "rate" only.
+        call(tracking, "tracking", "USD 11", 5);
+        if (static_cast<int>(tracking.call("double", 2)) != 4 || executions != 5)
+            throw std::runtime_error{"The tracking client has dropped the responses of \"double\"."};
+
+        // The polling client returns the stale response until a response brings the new epoch,
+        // then it drops all its cached responses.
+        call(polling, "polling", "USD 10", 5);
+        if (static_cast<int>(polling.call("double", 3)) != 6 || executions != 6)
+            throw std::runtime_error{"Unexpected response of \"double\"."};
+        call(polling, "polling", "USD 11", 7);
+
+        // The responses of a method can be dropped by the client itself.
+        tracking.invalidate("double");
+        if (static_cast<int>(tracking.call("double", 2)) != 4 || executions != 8)
+            throw std::runtime_error{"The response of \"double\" has not been dropped."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
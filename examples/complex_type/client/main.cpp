@@ -13,6 +13,7 @@
 #include <nanorpc/http/easy.h>
 
 // THIS
+#include "common/api.h"
 #include "common/data.h"
 
 int main()
@@ -34,7 +35,7 @@ int main()
             employee.job.push_back({"Task 1", "Do something."});
             employee.job.push_back({"Task 2", "Do something more."});
 
-            employee_id = client.call("create", employee_id, employee).as<std::string>();
+            employee_id = client.call(api::create, employee_id, employee);
             std::cout << "added employee with id \"" << employee_id << "\"." << std::endl;
         }
 
@@ -54,26 +55,26 @@ int main()
                 }
             };
 
-        data::employee employee = client.call("read", employee_id);
+        auto employee = client.call(api::read, employee_id);
 
         std::cout << "about employee with id \"" << employee_id << "\"" << std::endl;
         show_employee_info(employee);
 
         employee.occupation = data::occupation_type::manager;
 
-        client.call("update", employee_id, employee);
+        client.call(api::update, employee_id, employee);
         std::cout << "the employee has been promoted ..." << std::endl;
 
-        employee = client.call("read", employee_id).as<data::employee>();
+        employee = client.call(api::read, employee_id);
 
         std::cout << "new info about employee with id \"" << employee_id << "\"" << std::endl;
         show_employee_info(employee);
 
-        client.call("delete", employee_id);
+        client.call(api::remove, employee_id);
         std::cout << "the employee has been fired ..." << std::endl;
 
         std::cout << "you can't fire an employee twice" << std::endl;
-        client.call("delete", employee_id);
+        client.call(api::remove, employee_id);
     }
     catch (std::exception const &e)
     {
@@ -0,0 +1,33 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __EXAMPLES_COMPLEX_TYPE_API_H__
+#define __EXAMPLES_COMPLEX_TYPE_API_H__
+
+// STD
+#include <string>
+
+// NANORPC
+#include <nanorpc/core/method.h>
+
+// THIS
+#include "common/data.h"
+
+namespace api
+{
+
+using nanorpc::core::method;
+using nanorpc::method_id;
+
+inline constexpr method<method_id("create"), std::string (std::string, data::employee)> create;
+inline constexpr method<method_id("read"), data::employee (std::string)> read;
+inline constexpr method<method_id("update"), void (std::string, data::employee)> update;
+inline constexpr method<method_id("delete"), void (std::string)> remove;
+
+}
+
+#endif  // !__EXAMPLES_COMPLEX_TYPE_API_H__
@@ -0,0 +1,102 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/core/stop_token.h>
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        std::atomic<bool> stopped{false};
+
+        auto server = nanorpc::http::easy::make_server("127.0.0.1", "55605", 2, "/api/",
+                std::pair{"sleep", [] (int time)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{time});
+                        return time;
+                    }
+                },
+                // The handler sees the deadline of the call by the last parameter and stops in time.
+                std::pair{"work", [&stopped] (int time, nanorpc::core::stop_token token)
+                    {
+                        auto const end = std::chrono::steady_clock::now() + std::chrono::milliseconds{time};
+                        while (!token.stop_requested() && std::chrono::steady_clock::now() < end)
+                            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                        stopped = token.stop_requested();
+                        return time;
+                    }
+                }
+            );
+
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55605", 1, "/api/");
+
+        int time = client.call_for(std::chrono::seconds{1}, "sleep", 10);
+        if (time != 10)
+            throw std::runtime_error{"Unexpected response of \"sleep\"."};
+
+        auto timeout = [] (auto &&call)
+            {
+                auto const start = std::chrono::steady_clock::now();
+
+                try
+                {
+                    call();
+                    throw std::runtime_error{"The call has not timed out."};
+                }
+                catch (nanorpc::core::exception::timeout const &e)
+                {
+                    auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+                    std::cout << "Client. Timeout after " << time << " ms. Error: " << e.what() << std::endl;
+                    if (time >= 500)
+                        throw std::runtime_error{"The client has waited after the deadline."};
+                }
+            };
+
+        // The client stops waiting at the deadline.
+        timeout([&client] { client.call_for(std::chrono::milliseconds{100}, "sleep", 1000); });
+        timeout([&client] { client.call_for(std::chrono::milliseconds{100}, "work", 1000); });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        if (!stopped)
+            throw std::runtime_error{"The handler of \"work\" has not been stopped at the deadline."};
+
+        // The client with only a synchronous executor stops waiting at the deadline as well.
+        auto core_server = std::make_shared<nanorpc::core::server<nanorpc::packer::plain_text>>();
+        core_server->handle("sleep", [] (int time)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{time});
+                    return time;
+                }
+            );
+
+        nanorpc::core::client<nanorpc::packer::plain_text> sync_client{
+                [core_server] (nanorpc::core::type::buffer request)
+                { return core_server->execute(std::move(request)); }
+            };
+
+        timeout([&sync_client] { sync_client.call_for(std::chrono::milliseconds{100}, "sleep", 300); });
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
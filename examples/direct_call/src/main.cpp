@@ -0,0 +1,72 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/direct.h>
+#include <nanorpc/core/exception.h>
+#include <nanorpc/core/promise.h>
+#include <nanorpc/packer/plain_text.h>
+
+using packer = nanorpc::packer::plain_text;
+
+int main()
+{
+    try
+    {
+        auto server = std::make_shared<nanorpc::core::server<packer>>();
+        server->handle("size", [] (std::vector<int> const &items) { return items.size(); });
+        server->handle("name", [] () { return "nanorpc"; });
+        server->handle("range", [] (int count)
+                {
+                    std::vector<int> items;
+                    for (int i = 0 ; i < count ; ++i)
+                        items.push_back(i);
+                    return items;
+                }
+            );
+        // The asynchronous handlers are called by the packed requests.
+        server->handle("twice", [] (int value, nanorpc::core::promise<int> promise) { promise.set_value(value * 2); });
+
+        auto client = nanorpc::core::make_direct_client(server);
+
+        // The vector is moved to the handler without the packer.
+        std::vector<int> items(1000, 1);
+        std::size_t size = client.call("size", std::move(items));
+        std::cout << "Client. Method \"size\" Output: " << size << std::endl;
+        if (size != 1000)
+            throw std::runtime_error{"Unexpected response of \"size\"."};
+
+        // The results of other types are converted as the results of the remote calls are.
+        std::string name = client.call("name");
+        auto range = client.call("range", 3).as<std::list<long>>();
+        long count = client.call("size", std::vector<int>(5));
+        std::cout << "Client. Method \"name\" Output: " << name << std::endl;
+        if (name != "nanorpc" || range != std::list<long>{0, 1, 2} || count != 5)
+            throw std::runtime_error{"Unexpected converted response."};
+
+        int twice = client.call("twice", 21);
+        std::cout << "Client. Method \"twice\" Output: " << twice << std::endl;
+        if (twice != 42)
+            throw std::runtime_error{"Unexpected response of \"twice\"."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
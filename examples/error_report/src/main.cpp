@@ -0,0 +1,98 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        std::mutex lock;
+        int reported = 0;
+        int summaries = 0;
+
+        // The handler is called on the thread of the error reporter, not on the io threads.
+        // Every component reports at most 10 errors per second, the rest of them are
+        // reported as one summary at the end of the second.
+        auto error_handler = [&] (std::exception_ptr e)
+            {
+                std::string message;
+                try
+                {
+                    std::rethrow_exception(e);
+                }
+                catch (std::exception const &ex)
+                {
+                    message = nanorpc::core::exception::to_string(ex);
+                }
+
+                std::lock_guard guard{lock};
+                if (message.find("suppressed") != std::string::npos)
+                {
+                    ++summaries;
+                    std::cout << "Server. Summary: " << message << std::endl;
+                }
+                else if (++reported == 1)
+                {
+                    std::cout << "Server. Error: " << message << std::endl;
+                }
+            };
+
+        nanorpc::core::type::executor_map executors;
+        executors.emplace("/api/", [] (nanorpc::core::type::buffer request) { return request; });
+
+        nanorpc::http::server server("127.0.0.1", "55617", 2, std::move(executors), error_handler);
+        server.run();
+
+        // The requests to an unknown location fail on the server.
+        int failed = 0;
+        {
+            auto client = nanorpc::http::easy::make_client("127.0.0.1", "55617", 2, "/unknown/");
+            for (int i = 0 ; i < 200 ; ++i)
+            {
+                try
+                {
+                    client.call("ping");
+                }
+                catch (nanorpc::core::exception::client const &)
+                {
+                    ++failed;
+                }
+            }
+        }
+
+        std::cout << "Client. Failed calls: " << failed << std::endl;
+
+        // The summaries are reported at the end of the interval.
+        std::this_thread::sleep_for(std::chrono::milliseconds{1200});
+
+        std::lock_guard guard{lock};
+        std::cout << "Server. Reported errors: " << reported << " Summaries: " << summaries << std::endl;
+
+        if (failed != 200)
+            throw std::runtime_error{"Unexpected responses of the server."};
+        if (!reported || reported > 20 || !summaries)
+            throw std::runtime_error{"The errors have not been limited."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        // The server i answers in 50 * (i + 1) ms, the last one fails.
+        std::vector<nanorpc::http::server> servers;
+        nanorpc::http::endpoints endpoints;
+        for (int i = 0 ; i < 4 ; ++i)
+        {
+            auto const port = std::to_string(55607 + i);
+            servers.push_back(nanorpc::http::easy::make_server("127.0.0.1", port, 1, "/api/",
+                    std::pair{"shard", [i] ()
+                        {
+                            std::this_thread::sleep_for(std::chrono::milliseconds{50 * (i + 1)});
+                            if (i == 3)
+                                throw std::runtime_error{"The shard is not available."};
+                            return i;
+                        }
+                    }
+                ));
+            endpoints.push_back({"127.0.0.1", port});
+        }
+
+        // The servers share the workers of one client.
+        auto fan_out = nanorpc::http::easy::make_fan_out(endpoints, 2, "/api/");
+
+        // The request is sent to all servers at once, the call takes the time of the slowest one.
+        auto start = std::chrono::steady_clock::now();
+        auto results = fan_out.gather("shard");
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        std::cout << "Client. Gather took " << time << " ms." << std::endl;
+
+        for (int i = 0 ; i < 3 ; ++i)
+        {
+            if (!results[i] || results[i]->as<int>() != i)
+                throw std::runtime_error{"Unexpected response of a shard."};
+        }
+
+        if (results[3] || results[3].error().code != nanorpc::core::errc::logic)
+            throw std::runtime_error{"The failed shard has not been reported."};
+        std::cout << "Client. Shard 3 Error: " << results[3].error().message << std::endl;
+
+        // The call is completed by the first 2 good responses, the later ones are dropped.
+        std::mutex lock;
+        std::vector<std::size_t> answered;
+        auto const count = fan_out.call({2}, [&] (std::size_t index, auto)
+                {
+                    std::lock_guard guard{lock};
+                    answered.push_back(index);
+                },
+                "shard"
+            ).get();
+
+        std::cout << "Client. The quorum of " << count << " was reached by the shards";
+        for (auto i : answered)
+            std::cout << " " << i;
+        std::cout << "." << std::endl;
+
+        if (count != 2 || answered != std::vector<std::size_t>{0, 1})
+            throw std::runtime_error{"Unexpected quorum."};
+
+        // The dropped calls are let complete, so the servers are not stopped in the middle of them.
+        std::this_thread::sleep_for(std::chrono::milliseconds{250});
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/handler_pool.h>
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        auto core_server = std::make_shared<nanorpc::core::server<nanorpc::packer::plain_text>>();
+        core_server->handle("report", [] ()
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{300});
+                    return 1;
+                }
+            );
+        core_server->handle("add", [] (int x, int y) { return x + y; });
+        core_server->handle("version", [] () { return 2; });
+
+        nanorpc::core::type::async_executor_map executors;
+        executors.emplace("/api/", [core_server]
+                (nanorpc::core::type::buffer request, nanorpc::core::type::completion done)
+                {
+                    core_server->execute(std::move(request), std::move(done));
+                }
+            );
+
+        // The handlers run on 2 shared workers apart from the only I/O thread, the slow "report"
+        // has 2 workers of its own and the quick "version" is run on the I/O thread.
+        nanorpc::core::handler_options options;
+        options.workers = 2;
+        options.dedicated.emplace(nanorpc::method_id("report"), 2);
+        options.cheap.insert(nanorpc::method_id("version"));
+
+        nanorpc::http::server server("127.0.0.1", "55620", 1, std::move(executors), options);
+        server.run();
+
+        auto slow_client = nanorpc::http::easy::make_client("127.0.0.1", "55620", 2, "/api/");
+        auto fast_client = nanorpc::http::easy::make_client("127.0.0.1", "55620", 1, "/api/");
+
+        std::vector<std::thread> reports;
+        for (int i = 0 ; i < 2 ; ++i)
+            reports.emplace_back([&slow_client] { slow_client.call("report"); });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+
+        // The slow calls don't hold the I/O thread and the shared workers.
+        long long worst = 0;
+        for (int i = 0 ; i < 10 ; ++i)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            int const sum = fast_client.call("add", i, 1);
+            worst = std::max<long long>(worst, std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            if (sum != i + 1)
+                throw std::runtime_error{"Unexpected response of \"add\"."};
+        }
+
+        int const version = fast_client.call("version");
+
+        for (auto &i : reports)
+            i.join();
+
+        std::cout << "Client. The slowest of 10 calls of \"add\" during \"report\" took " << worst << " ms." << std::endl;
+        std::cout << "Client. Method \"version\" Output: " << version << std::endl;
+
+        if (worst >= 300)
+            throw std::runtime_error{"The calls of \"add\" have waited for \"report\"."};
+        if (version != 2)
+            throw std::runtime_error{"Unexpected response of \"version\"."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
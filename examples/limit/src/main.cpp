@@ -0,0 +1,86 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/client.h>
+#include <nanorpc/core/exception.h>
+#include <nanorpc/core/server.h>
+#include <nanorpc/packer/plain_text.h>
+
+using packer = nanorpc::packer::plain_text;
+
+int main()
+{
+    try
+    {
+        nanorpc::core::server<packer> server;
+        server.handle("slow", [] ()
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+                    return 1;
+                }
+            );
+        server.handle("fast", [] () { return 2; });
+
+        // Only 2 calls of "slow" are executed at the same time, the others are rejected at once.
+        // The adaptive limit (adaptive = true) would follow the latency of the calls.
+        server.limit("slow", nanorpc::core::limit_options{2, false, 1, 16});
+
+        nanorpc::core::client<packer> client{[&server] (nanorpc::core::type::buffer request)
+                { return server.execute(std::move(request)); }
+            };
+
+        std::atomic<int> executed{0};
+        std::atomic<int> rejected{0};
+        std::vector<std::thread> callers;
+
+        for (int i = 0 ; i < 8 ; ++i)
+        {
+            callers.emplace_back([&client, &executed, &rejected]
+                    {
+                        try
+                        {
+                            client.call("slow");
+                            ++executed;
+                        }
+                        catch (nanorpc::core::exception::overload const &)
+                        {
+                            ++rejected;
+                        }
+                    }
+                );
+        }
+
+        for (auto &i : callers)
+            i.join();
+
+        std::cout << "Client. Method \"slow\" Executed: " << executed << " Rejected: " << rejected << std::endl;
+        if (!executed || !rejected || executed + rejected != 8)
+            throw std::runtime_error{"The calls of \"slow\" were not limited."};
+
+        // The other methods are not limited.
+        int fast = client.call("fast");
+        if (fast != 2)
+            throw std::runtime_error{"Unexpected response of \"fast\"."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/client.h>
+#include <nanorpc/core/exception.h>
+#include <nanorpc/core/server.h>
+#include <nanorpc/packer/plain_text.h>
+
+using packer = nanorpc::packer::plain_text;
+
+int main()
+{
+    try
+    {
+        std::atomic<std::size_t> executions{0};
+        std::atomic<std::size_t> max_size{0};
+
+        nanorpc::core::server<packer> server;
+
+        // The concurrent calls of "get" are collected for 20 ms, by 8 calls at most.
+        server.handle_batch("get", [&] (std::vector<int> ids)
+                {
+                    ++executions;
+                    if (ids.size() > max_size)
+                        max_size = ids.size();
+
+                    std::vector<std::string> names;
+                    for (auto id : ids)
+                        names.push_back("user " + std::to_string(id));
+                    return names;
+                },
+                nanorpc::core::batch_options{std::chrono::milliseconds{20}, 8}
+            );
+
+        // The handler of several parameters takes the vector of their tuples.
+        server.handle_batch("add", [] (std::vector<std::tuple<int, int>> items)
+                {
+                    std::vector<int> sums;
+                    for (auto const &[a, b] : items)
+                        sums.push_back(a + b);
+                    return sums;
+                }
+            );
+
+        nanorpc::core::client<packer> client{[&server] (nanorpc::core::type::buffer request)
+                { return server.execute(std::move(request)); }
+            };
+
+        std::atomic<bool> failed{false};
+        std::vector<std::thread> callers;
+        for (int i = 0 ; i < 32 ; ++i)
+        {
+            callers.emplace_back([i, &client, &failed]
+                    {
+                        std::string name = client.call("get", i);
+                        if (name != "user " + std::to_string(i))
+                            failed = true;
+                    }
+                );
+        }
+
+        for (auto &i : callers)
+            i.join();
+
+        std::cout << "Server. 32 calls of \"get\" were executed by " << executions
+                  << " calls of the handler, " << max_size << " calls at most." << std::endl;
+
+        if (failed)
+            throw std::runtime_error{"Unexpected response of \"get\"."};
+        if (executions >= 32 || max_size > 8)
+            throw std::runtime_error{"The calls of \"get\" were not collected into batches."};
+
+        int sum = client.call("add", 2, 3);
+        std::cout << "Client. Method \"add\" Output: " << sum << std::endl;
+        if (sum != 5)
+            throw std::runtime_error{"Unexpected response of \"add\"."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
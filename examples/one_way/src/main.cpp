@@ -0,0 +1,70 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        std::atomic<int> messages{0};
+
+        auto server = nanorpc::http::easy::make_server("127.0.0.1", "55604", 2, "/api/",
+                std::pair{"log", [&messages] (std::string const &message)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+                        std::cout << "Server. Method \"log\" Input: " << message << std::endl;
+                        ++messages;
+                    }
+                },
+                std::pair{"fail", [&messages] () { ++messages; throw std::runtime_error{"Failed."}; } },
+                std::pair{"count", [&messages] () { return messages.load(); } }
+            );
+
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55604", 1, "/api/");
+
+        // The client doesn't wait for the handlers, their results and errors are dropped.
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0 ; i < 3 ; ++i)
+            client.notify("log", "message " + std::to_string(i));
+        client.notify("fail");
+        client.notify("unknown");
+        auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Client. 5 notifications took " << time << " ms." << std::endl;
+        if (time >= 100)
+            throw std::runtime_error{"The client has waited for the handlers."};
+
+        int count = 0;
+        for (int i = 0 ; i < 50 && count != 4 ; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            count = client.call("count");
+        }
+
+        if (count != 4)
+            throw std::runtime_error{"Not all the notifications have been handled."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        // The server publishes the updates by the core server shared with the http server.
+        auto core_server = std::make_shared<nanorpc::core::server<nanorpc::packer::plain_text>>();
+        core_server->handle("ping", [] () { return std::string{"pong"}; });
+
+        nanorpc::core::type::async_executor_map executors;
+        executors.emplace("/api/", [core_server]
+                (nanorpc::core::type::buffer request, nanorpc::core::type::completion done)
+                {
+                    core_server->execute(std::move(request), std::move(done));
+                }
+            );
+
+        nanorpc::http::server server("127.0.0.1", "55615", 2, std::move(executors));
+        server.run();
+
+        // The subscriber gets the last update published before the subscription.
+        core_server->publish("price", 1.5);
+
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55615", 2, "/api/");
+
+        std::mutex lock;
+        std::vector<double> prices;
+        std::vector<std::string> news;
+
+        // The polls are held by the server for 200 ms, then they are sent again.
+        nanorpc::core::subscribe_options options;
+        options.hold = std::chrono::milliseconds{200};
+
+        auto price = client.subscribe("price", [&] (auto value)
+                {
+                    std::lock_guard guard{lock};
+                    prices.push_back(value.template as<double>());
+                    std::cout << "Client. Topic \"price\" Update: " << prices.back() << std::endl;
+                },
+                options
+            );
+
+        auto headline = client.subscribe("news", [&] (auto value)
+                {
+                    std::lock_guard guard{lock};
+                    news.push_back(value.template as<std::string>());
+                    std::cout << "Client. Topic \"news\" Update: " << news.back() << std::endl;
+                }
+            );
+
+        auto wait = [&] (std::size_t count)
+            {
+                for (int i = 0 ; i < 100 ; ++i)
+                {
+                    {
+                        std::lock_guard guard{lock};
+                        if (prices.size() + news.size() >= count)
+                            return;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+                }
+                throw std::runtime_error{"No updates."};
+            };
+
+        wait(1);
+
+        // The calls and the polls of the subscriptions go side by side.
+        std::string pong = client.call("ping");
+        std::cout << "Client. Method \"ping\" Output: " << pong << std::endl;
+
+        for (int i = 0 ; i < 3 ; ++i)
+            core_server->publish("price", 2.0 + i);
+        core_server->publish("news", std::string{"The market is open."});
+        wait(5);
+
+        // The updates come after the held polls have been sent again.
+        std::this_thread::sleep_for(std::chrono::milliseconds{500});
+        core_server->publish("price", 9.0);
+        wait(6);
+
+        // The cancelled subscription gets no updates.
+        headline.cancel();
+        core_server->publish("news", std::string{"The market is closed."});
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+        std::lock_guard guard{lock};
+        if (prices != std::vector<double>{1.5, 2.0, 3.0, 4.0, 9.0})
+            throw std::runtime_error{"Unexpected updates of the prices."};
+        if (news != std::vector<std::string>{"The market is open."})
+            throw std::runtime_error{"Unexpected updates of the news."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
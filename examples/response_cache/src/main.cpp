@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/core/client.h>
+#include <nanorpc/core/exception.h>
+#include <nanorpc/core/server.h>
+#include <nanorpc/packer/plain_text.h>
+
+using packer = nanorpc::packer::plain_text;
+
+int main()
+{
+    try
+    {
+        int executions = 0;
+
+        nanorpc::core::server<packer> server;
+        server.handle("square", [&executions] (int value)
+                {
+                    ++executions;
+                    if (value < 0)
+                        throw std::runtime_error{"The value must not be negative."};
+                    return value * value;
+                }
+            );
+
+        // The responses are kept for 200 ms in 64 KB split into 4 shards.
+        server.cache("square", nanorpc::core::cache_options{std::chrono::milliseconds{200}, 64 * 1024, 4});
+
+        nanorpc::core::client<packer> client{[&server] (nanorpc::core::type::buffer request)
+                { return server.execute(std::move(request)); }
+            };
+
+        auto check = [&client, &executions] (int value, int expected_executions)
+            {
+                try
+                {
+                    int square = client.call("square", value);
+                    if (square != value * value)
+                        throw std::runtime_error{"Unexpected response of \"square\"."};
+                }
+                catch (nanorpc::core::exception::logic const &)
+                {
+                }
+
+                std::cout << "Server. Method \"square\" Input: " << value
+                          << " Executions: " << executions << std::endl;
+
+                if (executions != expected_executions)
+                    throw std::runtime_error{"Unexpected executions of \"square\"."};
+            };
+
+        check(3, 1);
+        // The same arguments are answered by the cached response.
+        check(3, 1);
+        check(4, 2);
+        // The errors are not cached.
+        check(-1, 3);
+        check(-1, 4);
+
+        // The response has expired.
+        std::this_thread::sleep_for(std::chrono::milliseconds{250});
+        check(3, 5);
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
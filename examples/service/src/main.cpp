@@ -0,0 +1,94 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// NANORPC
+#include <nanorpc/core/client.h>
+#include <nanorpc/core/exception.h>
+#include <nanorpc/core/server.h>
+#include <nanorpc/core/service.h>
+#include <nanorpc/packer/plain_text.h>
+
+using packer = nanorpc::packer::plain_text;
+
+int main()
+{
+    try
+    {
+        int total = 0;
+
+        // The handlers are called without std::function and without a lookup in a map.
+        auto service = nanorpc::core::make_service<packer>(
+                nanorpc::core::handle<nanorpc::method_id("echo")>([] (std::string const &s) { return "echo \"" + s + "\""; }),
+                nanorpc::core::handle<nanorpc::method_id("add")>([&total] (int a, int b) { total += a + b; }),
+                nanorpc::core::handle<nanorpc::method_id("fail")>([] () -> int { throw std::runtime_error{"Failed."}; })
+            );
+
+        nanorpc::core::client<packer> client{[&service] (nanorpc::core::type::buffer request)
+                { return service.execute(std::move(request)); }
+            };
+
+        std::string echo = client.call("echo", "hello world !!!");
+        std::cout << "Client. Method \"echo\" Output: " << echo << std::endl;
+        if (echo != "echo \"hello world !!!\"")
+            throw std::runtime_error{"Unexpected response of \"echo\"."};
+
+        client.call("add", 3, 4);
+        if (total != 7)
+            throw std::runtime_error{"The \"add\" handler was not called."};
+
+        try
+        {
+            client.call("fail");
+            throw std::runtime_error{"The \"fail\" call has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"fail\" Error: " << e.what() << std::endl;
+        }
+
+        try
+        {
+            client.call("unknown");
+            throw std::runtime_error{"The call of an unknown method has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"unknown\" Error: " << e.what() << std::endl;
+        }
+
+        // The dynamic server without handlers fails every call.
+        nanorpc::core::server<packer> empty_server;
+        nanorpc::core::client<packer> empty_client{[&empty_server] (nanorpc::core::type::buffer request)
+                { return empty_server.execute(std::move(request)); }
+            };
+
+        try
+        {
+            empty_client.call("echo", "hello");
+            throw std::runtime_error{"The call of the server without handlers has not failed."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Empty server Error: " << e.what() << std::endl;
+            if (std::string{e.what()}.find("No handlers.") == std::string::npos)
+                throw std::runtime_error{"Unexpected error of the server without handlers."};
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/method.h>
+#include <nanorpc/http/easy.h>
+
+namespace api
+{
+
+inline constexpr nanorpc::core::method<nanorpc::method_id("put"), void (std::string, std::string)> put;
+inline constexpr nanorpc::core::method<nanorpc::method_id("get"), std::string (std::string)> get;
+
+}   // namespace api
+
+int main()
+{
+    try
+    {
+        // Every server keeps the values of its own keys.
+        struct storage
+        {
+            std::mutex lock;
+            std::map<std::string, std::string> values;
+        };
+
+        std::vector<std::shared_ptr<storage>> storages;
+        std::vector<nanorpc::http::server> servers;
+        nanorpc::http::endpoints endpoints;
+
+        for (int i = 0 ; i < 4 ; ++i)
+        {
+            auto data = std::make_shared<storage>();
+            auto const port = std::to_string(55611 + i);
+
+            servers.push_back(nanorpc::http::easy::make_server("127.0.0.1", port, 1, "/api/",
+                    std::pair{"put", [data] (std::string const &key, std::string const &value)
+                        {
+                            std::lock_guard guard{data->lock};
+                            data->values[key] = value;
+                        }
+                    },
+                    std::pair{"get", [data] (std::string const &key)
+                        {
+                            std::lock_guard guard{data->lock};
+                            auto const iter = data->values.find(key);
+                            return iter != std::end(data->values) ? iter->second : std::string{};
+                        }
+                    }
+                ));
+
+            storages.push_back(std::move(data));
+            endpoints.push_back({"127.0.0.1", port});
+        }
+
+        // The calls are routed by the key through the hash ring of the first 3 servers.
+        auto make_client = [] (nanorpc::http::endpoints const &shards)
+            {
+                auto client = nanorpc::http::easy::make_sharded_client(shards, 1, "/api/");
+                client.route(api::put, [] (std::string const &key, std::string const &) { return key; });
+                client.route(api::get, [] (std::string const &key) { return key; });
+                return client;
+            };
+
+        auto client = make_client({std::begin(endpoints), std::begin(endpoints) + 3});
+
+        constexpr int keys = 300;
+        for (int i = 0 ; i < keys ; ++i)
+            client.call(api::put, "key " + std::to_string(i), "value " + std::to_string(i));
+
+        for (int i = 0 ; i < keys ; ++i)
+        {
+            if (client.call(api::get, "key " + std::to_string(i)) != "value " + std::to_string(i))
+                throw std::runtime_error{"The key has been routed to another server."};
+        }
+
+        for (std::size_t i = 0 ; i < 3 ; ++i)
+        {
+            std::cout << "Server " << i << ". Keys: " << storages[i]->values.size() << std::endl;
+            if (storages[i]->values.empty())
+                throw std::runtime_error{"The keys have not been spread over the servers."};
+        }
+
+        // With one more server on the ring only about a quarter of the keys move to it.
+        auto grown_client = make_client(endpoints);
+
+        int moved = 0;
+        for (int i = 0 ; i < keys ; ++i)
+        {
+            auto const value = grown_client.call(api::get, "key " + std::to_string(i));
+            if (value.empty())
+                ++moved;
+            else if (value != "value " + std::to_string(i))
+                throw std::runtime_error{"Unexpected value of the key."};
+        }
+
+        std::cout << "Client. " << moved << " of " << keys << " keys moved to the new server." << std::endl;
+        if (moved == 0 || moved > keys / 2)
+            throw std::runtime_error{"Unexpected count of the moved keys."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// NANORPC
+#include <nanorpc/shm/easy.h>
+
+int main()
+{
+    try
+    {
+        // The rings of the segment are of 64 KB, the larger messages are passed in parts.
+        nanorpc::shm::options options;
+        options.capacity = 64 * 1024;
+
+        auto server = nanorpc::shm::easy::make_server("nanorpc_shm_example", 2, options,
+                std::pair{"add", [] (int x, int y) { return x + y; } },
+                std::pair{"echo", [] (std::string const &message) { return message; } }
+            );
+
+        auto client = nanorpc::shm::easy::make_client("nanorpc_shm_example");
+
+        int result = client.call("add", 2, 3);
+        std::cout << "Client. Method \"add\" Output: " << result << std::endl;
+        if (result != 5)
+            throw std::runtime_error{"Unexpected response of \"add\"."};
+
+        std::string const large(1024 * 1024, 'x');
+        if (client.call("echo", large).as<std::string>() != large)
+            throw std::runtime_error{"Unexpected response of \"echo\"."};
+
+        // The segment has one client at a time.
+        auto other = nanorpc::shm::easy::make_client("nanorpc_shm_example");
+        try
+        {
+            other.call("add", 1, 1);
+            throw std::runtime_error{"The segment has two clients."};
+        }
+        catch (nanorpc::core::exception::client const &e)
+        {
+            std::cout << "Other client. Error: " << e.what() << std::endl;
+        }
+
+        // The completions are called off the thread reading the responses,
+        // so they can make asynchronous calls.
+        std::promise<int> sum;
+        client.async_call([&client, &sum] (std::exception_ptr exception, auto value)
+                {
+                    if (exception)
+                    {
+                        sum.set_exception(exception);
+                        return;
+                    }
+
+                    client.async_call([&sum] (std::exception_ptr exception, auto value)
+                            {
+                                if (exception)
+                                    sum.set_exception(exception);
+                                else
+                                    sum.set_value(value.template as<int>());
+                            },
+                            "add", value.template as<int>(), 10
+                        );
+                },
+                "add", 1, 2
+            );
+
+        result = sum.get_future().get();
+        std::cout << "Client. Nested call of \"add\" Output: " << result << std::endl;
+        if (result != 13)
+            throw std::runtime_error{"Unexpected response of the nested call."};
+
+        // The client attaches the segment of the restarted server by the next call.
+        server.stop();
+        server.run();
+
+        result = client.call("add", 4, 4);
+        std::cout << "Client. Method \"add\" after restart Output: " << result << std::endl;
+        if (result != 8)
+            throw std::runtime_error{"Unexpected response of \"add\"."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NANORPC
+#include <nanorpc/core/client.h>
+#include <nanorpc/core/exception.h>
+#include <nanorpc/core/server.h>
+#include <nanorpc/packer/plain_text.h>
+
+using packer = nanorpc::packer::plain_text;
+
+int main()
+{
+    try
+    {
+        std::atomic<int> executions{0};
+
+        nanorpc::core::server<packer> server;
+        server.handle("load", [&executions] (std::string const &key)
+                {
+                    ++executions;
+                    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+                    if (key.empty())
+                        throw std::runtime_error{"The key must not be empty."};
+                    return "value of " + key;
+                }
+            );
+
+        // The identical requests in flight are completed by the response of the first one.
+        server.coalesce("load");
+
+        nanorpc::core::client<packer> client{[&server] (nanorpc::core::type::buffer request)
+                { return server.execute(std::move(request)); }
+            };
+
+        std::atomic<int> failed{0};
+        std::atomic<int> errors{0};
+        std::vector<std::thread> callers;
+
+        for (int i = 0 ; i < 10 ; ++i)
+        {
+            callers.emplace_back([i, &client, &failed]
+                    {
+                        auto const key = "key " + std::to_string(i % 2);
+                        std::string value = client.call("load", key);
+                        if (value != "value of " + key)
+                            ++failed;
+                    }
+                );
+        }
+
+        // The error is delivered to all the joined requests.
+        for (int i = 0 ; i < 3 ; ++i)
+        {
+            callers.emplace_back([&client, &errors]
+                    {
+                        try
+                        {
+                            client.call("load", std::string{});
+                        }
+                        catch (nanorpc::core::exception::logic const &)
+                        {
+                            ++errors;
+                        }
+                    }
+                );
+        }
+
+        for (auto &i : callers)
+            i.join();
+
+        std::cout << "Server. 13 calls of \"load\" were executed " << executions << " times." << std::endl;
+
+        if (failed || errors != 3)
+            throw std::runtime_error{"Unexpected response of \"load\"."};
+        if (executions >= 13)
+            throw std::runtime_error{"The identical calls of \"load\" were not coalesced."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
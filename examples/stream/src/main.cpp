@@ -0,0 +1,229 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/http/client.h>
+#include <nanorpc/http/server.h>
+
+using buffer = nanorpc::core::type::buffer;
+
+// Writes every chunk back as soon as it's read. No thread waits for the stream.
+class echo final
+    : public std::enable_shared_from_this<echo>
+{
+public:
+    echo(nanorpc::core::type::async_chunk_reader read, nanorpc::core::type::async_chunk_writer write,
+            nanorpc::core::type::stream_completion done)
+        : read_{std::move(read)}
+        , write_{std::move(write)}
+        , done_{std::move(done)}
+    {
+    }
+
+    void run()
+    {
+        read_([self = shared_from_this()] (std::exception_ptr error, std::optional<buffer> chunk)
+                {
+                    if (error || !chunk)
+                    {
+                        self->done_(error);
+                        return;
+                    }
+
+                    self->write_(std::move(*chunk), [self] (std::exception_ptr error)
+                            {
+                                if (error)
+                                {
+                                    self->done_(error);
+                                    return;
+                                }
+
+                                self->run();
+                            }
+                        );
+                }
+            );
+    }
+
+private:
+    nanorpc::core::type::async_chunk_reader read_;
+    nanorpc::core::type::async_chunk_writer write_;
+    nanorpc::core::type::stream_completion done_;
+};
+
+int main()
+{
+    try
+    {
+        nanorpc::core::type::stream_executor_map streams;
+
+        // The request is read by chunks, only its size is kept.
+        streams.emplace("/count/", [] (nanorpc::core::type::chunk_reader read, nanorpc::core::type::chunk_writer write)
+                {
+                    std::uint64_t size = 0;
+                    while (auto chunk = read())
+                        size += chunk->size();
+
+                    auto const result = std::to_string(size);
+                    write(buffer{std::begin(result), std::end(result)});
+                }
+            );
+
+        // Every chunk of the response is written as soon as the chunk of the request is read.
+        streams.emplace("/upper/", [] (nanorpc::core::type::chunk_reader read, nanorpc::core::type::chunk_writer write)
+                {
+                    while (auto chunk = read())
+                    {
+                        for (auto &i : *chunk)
+                            i = static_cast<char>(std::toupper(static_cast<unsigned char>(i)));
+                        write(std::move(*chunk));
+                    }
+                }
+            );
+
+        streams.emplace("/wait/", [] (nanorpc::core::type::chunk_reader read, nanorpc::core::type::chunk_writer)
+                {
+                    while (read())
+                        ;
+                }
+            );
+
+        nanorpc::http::server server("127.0.0.1", "55619", 2, {}, std::move(streams));
+        server.run();
+
+        nanorpc::core::type::async_stream_executor_map async_streams;
+
+        async_streams.emplace("/echo/", [] (nanorpc::core::type::async_chunk_reader read,
+                nanorpc::core::type::async_chunk_writer write, nanorpc::core::type::stream_completion done)
+                {
+                    std::make_shared<echo>(std::move(read), std::move(write), std::move(done))->run();
+                }
+            );
+
+        nanorpc::http::server async_server("127.0.0.1", "55621", 2, {}, std::move(async_streams));
+        async_server.run();
+
+        nanorpc::http::client client("127.0.0.1", "55619", 2, "/api/");
+        client.run();
+
+        // 64 MB are sent by chunks of 1 MB, neither side keeps the whole request.
+        {
+            std::uint64_t const size = 64ull << 20;
+            std::uint64_t sent = 0;
+            std::string result;
+
+            client.make_stream_executor("/count/")([&sent, size] () -> std::optional<buffer>
+                    {
+                        if (sent == size)
+                            return {};
+                        sent += 1 << 20;
+                        return buffer(1 << 20, 'x');
+                    },
+                    [&result] (buffer chunk) { result.append(std::begin(chunk), std::end(chunk)); }
+                );
+
+            std::cout << "Client. Stream \"/count/\" Output: " << result << std::endl;
+            if (result != std::to_string(size))
+                throw std::runtime_error{"Unexpected response of \"/count/\"."};
+        }
+
+        {
+            int chunks = 0;
+            std::string result;
+
+            client.make_stream_executor("/upper/")([&chunks] () -> std::optional<buffer>
+                    {
+                        if (chunks++ == 3)
+                            return {};
+                        std::string const chunk = "chunk ";
+                        return buffer{std::begin(chunk), std::end(chunk)};
+                    },
+                    [&result] (buffer chunk) { result.append(std::begin(chunk), std::end(chunk)); }
+                );
+
+            std::cout << "Client. Stream \"/upper/\" Output: " << result << std::endl;
+            if (result != "CHUNK CHUNK CHUNK ")
+                throw std::runtime_error{"Unexpected response of \"/upper/\"."};
+        }
+
+        {
+            nanorpc::http::client async_client("127.0.0.1", "55621", 1, "/api/");
+            async_client.run();
+
+            std::uint64_t const size = 16ull << 20;
+            std::uint64_t sent = 0;
+            std::uint64_t received = 0;
+
+            async_client.make_stream_executor("/echo/")([&sent, size] () -> std::optional<buffer>
+                    {
+                        if (sent == size)
+                            return {};
+                        sent += 1 << 20;
+                        return buffer(1 << 20, 'x');
+                    },
+                    [&received] (buffer chunk) { received += chunk.size(); }
+                );
+
+            std::cout << "Client. Stream \"/echo/\" Output: " << received << " bytes" << std::endl;
+            if (received != size)
+                throw std::runtime_error{"Unexpected response of \"/echo/\"."};
+
+            async_client.stop();
+        }
+
+        // The stop breaks the streams in progress.
+        std::string error;
+        std::thread stream{[&client, &error]
+                {
+                    try
+                    {
+                        client.make_stream_executor("/wait/")([] () -> std::optional<buffer>
+                                {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                                    return buffer(1, 'x');
+                                },
+                                [] (buffer) {}
+                            );
+                    }
+                    catch (std::exception const &e)
+                    {
+                        error = e.what();
+                    }
+                }
+            };
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+        server.stop();
+        stream.join();
+
+        std::cout << "Client. Stream \"/wait/\" Error: " << error << std::endl;
+        if (error.empty())
+            throw std::runtime_error{"The stream has not been broken by the stop."};
+
+        client.stop();
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
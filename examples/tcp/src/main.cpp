@@ -0,0 +1,78 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// NANORPC
+#include <nanorpc/tcp/easy.h>
+
+int main()
+{
+    try
+    {
+        auto server = nanorpc::tcp::easy::make_server("127.0.0.1", "55618", 4,
+                std::pair{"echo", [] (std::string const &message) { return message; } },
+                std::pair{"sleep", [] (int ms)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{ms});
+                        return ms;
+                    }
+                },
+                std::pair{"fail", [] () { throw std::runtime_error{"Failed."}; } }
+            );
+
+        // One connection carries all calls of the client.
+        auto client = nanorpc::tcp::easy::make_client("127.0.0.1", "55618", 2);
+
+        std::string result = client.call("echo", std::string{"Hello world!"});
+        std::cout << "Client. Method \"echo\" Output: " << result << std::endl;
+        if (result != "Hello world!")
+            throw std::runtime_error{"Unexpected response of \"echo\"."};
+
+        // The response of the fast call comes before the response of the slow one.
+        auto const start = std::chrono::steady_clock::now();
+        auto slow = client.async_call("sleep", 300);
+        auto fast = client.async_call("sleep", 50);
+
+        int const fast_result = fast.get();
+        auto const time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        int const slow_result = slow.get();
+
+        std::cout << "Client. Method \"sleep\" Output: " << fast_result << " after " << time << " ms." << std::endl;
+        if (fast_result != 50 || slow_result != 300 || time >= 300)
+            throw std::runtime_error{"The fast call has waited for the slow one."};
+
+        // The large messages are sent in one frame.
+        std::string const large(4 * 1024 * 1024, 'x');
+        if (client.call("echo", large).as<std::string>() != large)
+            throw std::runtime_error{"Unexpected response of \"echo\"."};
+
+        try
+        {
+            client.call("fail");
+            throw std::runtime_error{"No error of \"fail\"."};
+        }
+        catch (nanorpc::core::exception::logic const &e)
+        {
+            std::cout << "Client. Method \"fail\" Error: " << e.what() << std::endl;
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// NANORPC
+#include <nanorpc/core/expected.h>
+#include <nanorpc/http/easy.h>
+
+int main()
+{
+    try
+    {
+        auto server = nanorpc::http::easy::make_server("127.0.0.1", "55606", 1, "/api/",
+                std::pair{"divide", [] (int a, int b)
+                    {
+                        if (!b)
+                            throw std::invalid_argument{"Division by zero."};
+                        return a / b;
+                    }
+                }
+            );
+
+        auto client = nanorpc::http::easy::make_client("127.0.0.1", "55606", 1, "/api/");
+
+        // The errors are returned as core::error without exceptions.
+        auto quotient = client.try_call("divide", 10, 2);
+        if (!quotient || quotient->as<int>() != 5)
+            throw std::runtime_error{"Unexpected response of \"divide\"."};
+
+        auto failed = client.try_call("divide", 1, 0);
+        if (failed || failed.error().code != nanorpc::core::errc::logic)
+            throw std::runtime_error{"The \"divide\" call has not failed by the handler."};
+        std::cout << "Client. Method \"divide\" Error: " << failed.error().message << std::endl;
+
+        auto unknown = client.try_call("unknown");
+        if (unknown || unknown.error().code != nanorpc::core::errc::logic)
+            throw std::runtime_error{"The call of an unknown method has not failed."};
+        std::cout << "Client. Method \"unknown\" Error: " << unknown.error().message << std::endl;
+
+        // The errors of the transport are returned as well.
+        auto no_server = nanorpc::http::easy::make_client("127.0.0.1", "55699", 1, "/api/");
+        auto lost = no_server.try_call("divide", 1, 1);
+        if (lost || lost.error().code != nanorpc::core::errc::transport)
+            throw std::runtime_error{"The call without a server has not failed by the transport."};
+        std::cout << "Client. No server Error: " << lost.error().message << std::endl;
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
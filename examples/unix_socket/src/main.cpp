@@ -0,0 +1,79 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// POSIX
+#include <sys/stat.h>
+
+// NANORPC
+#include <nanorpc/http/easy.h>
+#include <nanorpc/tcp/easy.h>
+
+namespace
+{
+
+bool exists(char const *path)
+{
+    struct stat info;
+    return !::stat(path, &info);
+}
+
+}   // namespace
+
+int main()
+{
+    try
+    {
+        // The address "unix:/path" runs the transports over a unix domain socket,
+        // the port is not used.
+        {
+            auto server = nanorpc::http::easy::make_server("unix:/tmp/nanorpc_http.sock", "", 2, "/api/",
+                    std::pair{"add", [] (int x, int y) { return x + y; } }
+                );
+
+            if (!exists("/tmp/nanorpc_http.sock"))
+                throw std::runtime_error{"No socket file of the http server."};
+
+            auto client = nanorpc::http::easy::make_client("unix:/tmp/nanorpc_http.sock", "", 1, "/api/");
+            int result = client.call("add", 2, 3);
+            std::cout << "Http client. Method \"add\" Output: " << result << std::endl;
+            if (result != 5)
+                throw std::runtime_error{"Unexpected response of \"add\"."};
+        }
+
+        // The socket file is removed by the stopped server.
+        if (exists("/tmp/nanorpc_http.sock"))
+            throw std::runtime_error{"The socket file of the http server has not been removed."};
+
+        {
+            auto server = nanorpc::tcp::easy::make_server("unix:/tmp/nanorpc_tcp.sock", "", 2,
+                    std::pair{"concat", [] (std::string const &x, std::string const &y) { return x + y; } }
+                );
+
+            auto client = nanorpc::tcp::easy::make_client("unix:/tmp/nanorpc_tcp.sock", "", 1);
+            std::string result = client.call("concat", std::string{"Hello "}, std::string{"world!"});
+            std::cout << "Tcp client. Method \"concat\" Output: " << result << std::endl;
+            if (result != "Hello world!")
+                throw std::runtime_error{"Unexpected response of \"concat\"."};
+        }
+
+        if (exists("/tmp/nanorpc_tcp.sock"))
+            throw std::runtime_error{"The socket file of the tcp server has not been removed."};
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "Error: " << nanorpc::core::exception::to_string(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
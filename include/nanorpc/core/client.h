@@ -10,92 +10,809 @@
 
 // STD
 #include <any>
+#include <chrono>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#endif  // !__cpp_impl_coroutine
 
 // NANORPC
+#include "nanorpc/core/detail/blocking_calls.h"
+#include "nanorpc/core/detail/client_cache.h"
+#include "nanorpc/core/detail/header.h"
 #include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/detail/subscriber.h"
 #include "nanorpc/core/exception.h"
+#include "nanorpc/core/expected.h"
+#include "nanorpc/core/method.h"
+#include "nanorpc/core/method_id.h"
+#include "nanorpc/core/stop_token.h"
+#include "nanorpc/core/subscription.h"
 #include "nanorpc/core/type.h"
 #include "nanorpc/version/core.h"
 
 namespace nanorpc::core
 {
 
+template <typename TPacker>
+class fan_out;
+
 template <typename TPacker>
 class client final
 {
 private:
     class result;
+    class batch_call;
 
 public:
+    using result_type = result;
+    using result_handler = std::function<void (std::exception_ptr, result_type)>;
+    using update_handler = std::function<void (result_type)>;
+    using batch_type = batch_call;
+
     client(type::executor executor)
         : executor_{std::move(executor)}
     {
     }
 
+    client(type::async_executor executor)
+        : async_executor_{std::move(executor)}
+    {
+    }
+
+    client(type::executor executor, type::async_executor async_executor)
+        : executor_{std::move(executor)}
+        , async_executor_{std::move(async_executor)}
+    {
+    }
+
+    // The direct executor takes the arguments as std::tuple and puts the result into std::any
+    // without the packer. If it can't execute the call (e.g. the types of the arguments differ
+    // from the handler's ones), the call is packed and executed by the executor.
+    client(type::direct_executor direct_executor, type::executor executor)
+        : executor_{std::move(executor)}
+        , direct_executor_{std::move(direct_executor)}
+    {
+    }
+
     template <typename ... TArgs>
     result call(std::string_view name, TArgs && ... args)
     {
-        return call(std::hash<std::string_view>{}(name), std::forward<TArgs>(args) ... );
+        return call(method_id(name), std::forward<TArgs>(args) ... );
     }
 
     template <typename ... TArgs>
     result call(type::id id, TArgs && ... args)
     {
-        auto data = std::make_tuple(std::forward<TArgs>(args) ... );
+        if (!direct_executor_)
+            return make_result(execute(make_request(id, std::forward<TArgs>(args) ... )));
+
+        std::any data = std::tuple<direct_type_t<TArgs> ... >{std::forward<TArgs>(args) ... };
+        std::any value;
+        type::result_packer packer = nullptr;
+        if (direct_executor_(id, data, value, packer))
+            return {std::move(value), packer};
+
+        return make_result(execute(pack_request(id, std::any_cast<std::tuple<direct_type_t<TArgs> ... > const &>(data))));
+    }
+
+    // The call of a described method. The arguments are converted to the declared types
+    // and the result is returned as the declared type.
+    template <type::id Id, typename TSignature, typename ... TArgs>
+    typename method<Id, TSignature>::result_type call(method<Id, TSignature>, TArgs && ... args)
+    {
+        using method_type = method<Id, TSignature>;
+        using result_type = typename method_type::result_type;
+        using arguments_type = typename method_type::arguments_type;
+
+        static_assert(sizeof ... (TArgs) == std::tuple_size_v<arguments_type>,
+                "[nanorpc::core::client::call] Wrong number of the arguments.");
+
+        arguments_type arguments{std::forward<TArgs>(args) ... };
+
+        if (!direct_executor_)
+            return make_result(execute(pack_request(Id, arguments))).template take<result_type>();
+
+        std::any data = std::move(arguments);
+        std::any value;
+        type::result_packer packer = nullptr;
+        if (direct_executor_(Id, data, value, packer))
+            return result{std::move(value), packer}.template take<result_type>();
+
+        return make_result(execute(pack_request(Id, std::any_cast<arguments_type const &>(data))))
+                .template take<result_type>();
+    }
+
+    // The call without exceptions for the failed responses. The errors of the server come
+    // as the status of the response and are returned as core::error, so a failed call costs
+    // as much as a successful one. The errors of the transport are returned the same way.
+    template <typename ... TArgs>
+    expected<result> try_call(std::string_view name, TArgs && ... args)
+    {
+        return try_call(method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    expected<result> try_call(type::id id, TArgs && ... args)
+    {
+        try
+        {
+            if (!direct_executor_)
+                return try_make_result(execute(make_request(id, std::forward<TArgs>(args) ... )));
+
+            std::any data = std::tuple<direct_type_t<TArgs> ... >{std::forward<TArgs>(args) ... };
+            std::any value;
+            type::result_packer packer = nullptr;
+            if (direct_executor_(id, data, value, packer))
+                return result{std::move(value), packer};
+
+            return try_make_result(execute(pack_request(id,
+                    std::any_cast<std::tuple<direct_type_t<TArgs> ... > const &>(data))));
+        }
+        catch (...)
+        {
+            return error::from_exception(std::current_exception());
+        }
+    }
+
+    // The call with the deadline. The remaining time is sent with the request, so the server
+    // drops the call if it can't be started in time and the client stops waiting for it.
+    // If the deadline has passed, exception::timeout is thrown. The call takes the cached
+    // response and the direct executor as the call without the deadline does. With only
+    // a synchronous executor the call is made on a small pool of threads of the client
+    // (detail::blocking_calls); the calls stuck there are given up on destruction.
+    template <typename TRep, typename TPeriod, typename ... TArgs>
+    result call_for(std::chrono::duration<TRep, TPeriod> const &timeout, std::string_view name, TArgs && ... args)
+    {
+        return call_until(stop_token::clock_type::now() + timeout, method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename TRep, typename TPeriod, typename ... TArgs>
+    result call_for(std::chrono::duration<TRep, TPeriod> const &timeout, type::id id, TArgs && ... args)
+    {
+        return call_until(stop_token::clock_type::now() + timeout, id, std::forward<TArgs>(args) ... );
+    }
+
+    template <typename TDuration, typename ... TArgs>
+    result call_until(std::chrono::time_point<stop_token::clock_type, TDuration> const &deadline,
+            std::string_view name, TArgs && ... args)
+    {
+        return call_until(deadline, method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename TDuration, typename ... TArgs>
+    result call_until(std::chrono::time_point<stop_token::clock_type, TDuration> const &deadline,
+            type::id id, TArgs && ... args)
+    {
+        stop_token const token{std::chrono::time_point_cast<stop_token::clock_type::duration>(deadline)};
+        if (token.stop_requested())
+            throw exception::timeout{"[nanorpc::core::client::call] The deadline has passed."};
+
+        type::buffer request;
+
+        if (direct_executor_)
+        {
+            std::any data = std::tuple<direct_type_t<TArgs> ... >{std::forward<TArgs>(args) ... };
+            std::any value;
+            type::result_packer packer = nullptr;
+            if (direct_executor_(id, data, value, packer))
+                return {std::move(value), packer};
+
+            request = pack_request(id, std::any_cast<std::tuple<direct_type_t<TArgs> ... > const &>(data));
+        }
+        else
+        {
+            request = make_request(id, std::forward<TArgs>(args) ... );
+        }
+
+        detail::header request_header;
+        request_header.read(request);
+        request_header.budget = token.budget();
+        request_header.write(request);
+
+        return make_result(execute(std::move(request), token));
+    }
+
+    template <typename ... TArgs>
+    std::future<result> async_call(std::string_view name, TArgs && ... args)
+    {
+        return async_call(method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    std::future<result> async_call(type::id id, TArgs && ... args)
+    {
+        auto promise = std::make_shared<std::promise<result>>();
+        auto future = promise->get_future();
+
+        async_call([promise] (std::exception_ptr exception, result value)
+                {
+                    if (exception)
+                        promise->set_exception(std::move(exception));
+                    else
+                        promise->set_value(std::move(value));
+                },
+                id, std::forward<TArgs>(args) ... );
+
+        return future;
+    }
+
+    template <type::id Id, typename TSignature, typename ... TArgs>
+    std::future<typename method<Id, TSignature>::result_type> async_call(method<Id, TSignature>, TArgs && ... args)
+    {
+        using method_type = method<Id, TSignature>;
+        using result_type = typename method_type::result_type;
+        using arguments_type = typename method_type::arguments_type;
+
+        static_assert(sizeof ... (TArgs) == std::tuple_size_v<arguments_type>,
+                "[nanorpc::core::client::async_call] Wrong number of the arguments.");
+
+        auto promise = std::make_shared<std::promise<result_type>>();
+        auto future = promise->get_future();
+
+        auto request = pack_request(Id, arguments_type{std::forward<TArgs>(args) ... });
+        async_execute(std::move(request), [promise] (std::exception_ptr exception, result value)
+                {
+                    if (exception)
+                    {
+                        promise->set_exception(std::move(exception));
+                        return;
+                    }
+
+                    try
+                    {
+                        if constexpr (std::is_void_v<result_type>)
+                            promise->set_value();
+                        else
+                            promise->set_value(value.template take<result_type>());
+                    }
+                    catch (...)
+                    {
+                        promise->set_exception(std::current_exception());
+                    }
+                }
+            );
+
+        return future;
+    }
+
+    // The handler is called on a thread of the transport. If the client has only
+    // a synchronous executor, the handler is called before async_call returns.
+    template <typename ... TArgs>
+    void async_call(result_handler handler, std::string_view name, TArgs && ... args)
+    {
+        async_call(std::move(handler), method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    void async_call(result_handler handler, type::id id, TArgs && ... args)
+    {
+        async_execute(make_request(id, std::forward<TArgs>(args) ... ), std::move(handler));
+    }
+
+    // One-way call. The server completes it before the handler is executed and drops
+    // the result and the errors of the handler. With an asynchronous executor the call
+    // doesn't wait for the transport and its errors are dropped too, otherwise they are thrown.
+    template <typename ... TArgs>
+    void notify(std::string_view name, TArgs && ... args)
+    {
+        notify(method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    void notify(type::id id, TArgs && ... args)
+    {
+        auto request = make_request(id, std::forward<TArgs>(args) ... );
+
+        detail::header request_header;
+        request_header.read(request);
+        request_header.flags |= detail::header::flag_one_way;
+        request_header.write(request);
+
+        if (async_executor_)
+        {
+            async_executor_(std::move(request), [] (std::exception_ptr, type::buffer) {});
+            return;
+        }
+
+        execute(std::move(request));
+    }
+
+    // The handler gets the updates which the server publishes to the topic. All subscriptions
+    // of the client are polled by one request held by the server until there are updates.
+    // The handler gets the last update at once, then it's called on the thread of the
+    // subscriptions. It needs an asynchronous executor; the options of the first subscription
+    // are used for all subscriptions of the client.
+    subscription subscribe(std::string_view topic, update_handler handler, subscribe_options const &options = {})
+    {
+        return subscribe(method_id(topic), std::move(handler), options);
+    }
+
+    subscription subscribe(type::id topic, update_handler handler, subscribe_options const &options = {})
+    {
+        if (!async_executor_)
+            throw exception::client{"[nanorpc::core::client::subscribe] No asynchronous executor."};
+
+        if (!subscriber_)
+            subscriber_ = std::make_shared<detail::subscriber<packer_type>>(async_executor_, options);
+
+        return subscription{subscriber_->subscribe(topic, [func = std::move(handler)] (type::buffer message)
+                {
+                    func(result{packer_type{}.from_buffer(std::move(message), detail::header::size)});
+                }
+            )};
+    }
+
+    // The good responses of the method are kept for the time to live and returned for the calls
+    // with the same packed arguments without a round trip. They are dropped when the server
+    // invalidates the data: by a push if the client tracks the invalidations, otherwise
+    // by the epoch of the next response. The calls inside of batches, the one-way calls
+    // and the calls by the direct executor are not cached. The methods are configured
+    // before the calls.
+    void cache(std::string_view name, cache_options options)
+    {
+        cache(method_id(name), std::move(options));
+    }
+
+    void cache(type::id id, cache_options options)
+    {
+        if (!cache_)
+            cache_ = std::make_shared<detail::client_cache>();
+        cache_->add(id, std::move(options));
+    }
+
+    // Drops the cached responses of the method.
+    void invalidate(std::string_view name)
+    {
+        invalidate(method_id(name));
+    }
+
+    void invalidate(type::id id)
+    {
+        if (cache_)
+            cache_->invalidate(id);
+    }
+
+    // Subscribes to the invalidations of the server, so the cached responses of a method are
+    // dropped as soon as the server invalidates it and the others are kept.
+    subscription track_invalidations(subscribe_options const &options = {})
+    {
+        if (!cache_)
+            cache_ = std::make_shared<detail::client_cache>();
+
+        return subscribe(detail::invalidate_topic, [cache = cache_] (result_type value)
+                {
+                    auto const [id, epoch] = value.template as<std::tuple<type::id, std::uint32_t>>();
+                    cache->invalidate(id, epoch);
+                },
+                options
+            );
+    }
+
+    // Collects many calls into one request. The results are available by the futures
+    // returned from batch_type::call after batch_type::send.
+    batch_type batch()
+    {
+        return batch_type{*this};
+    }
+
+#ifdef __cpp_impl_coroutine
+    // co_await client.co_call(...) suspends the coroutine until the response arrives.
+    // The coroutine is resumed on a thread of the transport.
+    template <typename ... TArgs>
+    auto co_call(std::string_view name, TArgs && ... args)
+    {
+        return co_call(method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    auto co_call(type::id id, TArgs && ... args)
+    {
+        return awaitable{*this, make_request(id, std::forward<TArgs>(args) ... )};
+    }
+#endif  // !__cpp_impl_coroutine
+
+private:
+    template <typename>
+    friend class fan_out;
+
+    using packer_type = TPacker;
+    using deserializer_type = typename packer_type::deserializer_type;
+
+    type::executor executor_;
+    type::async_executor async_executor_;
+    type::direct_executor direct_executor_;
+    std::shared_ptr<detail::subscriber<packer_type>> subscriber_;
+    std::shared_ptr<detail::client_cache> cache_;
+    std::shared_ptr<detail::blocking_calls> blocking_calls_ = std::make_shared<detail::blocking_calls>();
+
+    // String literals are passed to the direct executor as std::string, like after unpacking.
+    template <typename T>
+    using direct_type_t = std::conditional_t<
+            std::is_same_v<std::decay_t<T>, char const *> || std::is_same_v<std::decay_t<T>, char *>,
+            std::string, std::decay_t<T>
+        >;
+
+    template <typename ... TArgs>
+    static type::buffer make_request(type::id id, TArgs && ... args)
+    {
+        return pack_request(id, std::make_tuple(std::forward<TArgs>(args) ... ));
+    }
 
-        packer_type packer;
-        auto request = packer
-                .pack(version::core::protocol::value)
-                .pack(detail::pack::meta::type::request)
-                .pack(id)
+    template <typename TData>
+    static type::buffer pack_request(type::id id, TData const &data)
+    {
+        auto request = packer_type{}
+                .append_to(detail::header::make_buffer())
                 .pack(data)
                 .to_buffer();
 
-        auto buffer = executor_(std::move(request));
-        auto response = packer.from_buffer(std::move(buffer));
+        detail::header request_header;
+        request_header.type = detail::pack::meta::type::request;
+        request_header.id = id;
+        request_header.write(request);
+
+        return request;
+    }
+
+    static result make_result(type::buffer buffer)
+    {
+        return try_make_result(std::move(buffer)).value();
+    }
+
+    static expected<result> try_make_result(type::buffer buffer)
+    {
+        detail::header response_header;
+        if (!response_header.read(buffer))
+            return error{errc::protocol, "[nanorpc::core::client::call] Bad response header."};
+
+        if (response_header.version != version::core::protocol::value)
+        {
+            return error{errc::protocol, "[nanorpc::core::client::call] Unsupported protocol version \"" +
+                    std::to_string(response_header.version) + "\"."};
+        }
+
+        if (response_header.type != detail::pack::meta::type::response)
+            return error{errc::protocol, "[nanorpc::core::client::call] Bad response type."};
+
+        if (response_header.payload_size > buffer.size() - detail::header::size)
+            return error{errc::protocol, "[nanorpc::core::client::call] Bad payload size."};
+
+        auto response = packer_type{}.from_buffer(std::move(buffer), detail::header::size);
+
+        if (response_header.status != detail::pack::meta::status::good)
+        {
+            std::string message;
+            response = response.unpack(message);
+            if (response_header.status == detail::pack::meta::status::overload)
+                return error{errc::overload, std::move(message)};
+            if (response_header.status == detail::pack::meta::status::timeout)
+                return error{errc::timeout, std::move(message)};
+            return error{errc::logic, std::move(message)};
+        }
+
+        return result{std::move(response)};
+    }
+
+    type::buffer execute(type::buffer request, stop_token const &token = {})
+    {
+        std::optional<detail::request_key> key;
+        auto const cache = cache_ ? cache_->find(request, key) : nullptr;
+        if (!cache)
+            return transmit(std::move(request), token);
+
+        if (auto response = cache->get(*key))
+            return std::move(*response);
+
+        auto response = transmit(std::move(request), token);
+        cache_->update(*cache, std::move(*key), response);
+        return response;
+    }
+
+    type::buffer transmit(type::buffer request, stop_token const &token)
+    {
+        if (token.stop_possible())
+            return transmit_until(std::move(request), *token.deadline());
+
+        if (executor_)
+            return executor_(std::move(request));
+
+        if (!async_executor_)
+            throw exception::client{"[nanorpc::core::client::call] No executor."};
+
+        std::promise<type::buffer> promise;
+        auto future = promise.get_future();
+        async_executor_(std::move(request), [&promise] (std::exception_ptr exception, type::buffer response)
+                {
+                    if (exception)
+                        promise.set_exception(std::move(exception));
+                    else
+                        promise.set_value(std::move(response));
+                }
+            );
+        return future.get();
+    }
+
+    // The asynchronous executor is preferred, the synchronous one is called on the blocking threads.
+    // The call which has waited there past its deadline isn't made.
+    type::buffer transmit_until(type::buffer request, stop_token::clock_type::time_point deadline)
+    {
+        auto promise = std::make_shared<std::promise<type::buffer>>();
+        auto future = promise->get_future();
+
+        auto done = [promise] (std::exception_ptr exception, type::buffer response)
+            {
+                if (exception)
+                    promise->set_exception(std::move(exception));
+                else
+                    promise->set_value(std::move(response));
+            };
+
+        if (async_executor_)
+        {
+            async_executor_(std::move(request), std::move(done));
+        }
+        else if (executor_)
+        {
+            blocking_calls_->run([executor = executor_, done = std::move(done), deadline,
+                    request = std::make_shared<type::buffer>(std::move(request))]
+                {
+                    if (stop_token::clock_type::now() >= deadline)
+                        return;
+
+                    std::exception_ptr exception;
+                    type::buffer response;
+
+                    try
+                    {
+                        response = executor(std::move(*request));
+                    }
+                    catch (...)
+                    {
+                        exception = std::current_exception();
+                    }
+
+                    done(std::move(exception), std::move(response));
+                }
+            );
+        }
+        else
+        {
+            throw exception::client{"[nanorpc::core::client::call] No executor."};
+        }
+
+        if (future.wait_until(deadline) != std::future_status::ready)
+            throw exception::timeout{"[nanorpc::core::client::call] Timeout."};
+
+        return future.get();
+    }
+
+    void async_execute(type::buffer request, result_handler handler)
+    {
+        std::optional<detail::request_key> key;
+        auto const cache = cache_ ? cache_->find(request, key) : nullptr;
+
+        if (cache)
+        {
+            if (auto response = cache->get(*key))
+            {
+                handler(nullptr, make_result(std::move(*response)));
+                return;
+            }
+        }
+
+        auto on_response = [handler, owner = cache_, cache, key = std::move(key)]
+            (std::exception_ptr exception, type::buffer response) mutable
+            {
+                if (!exception && cache)
+                    owner->update(*cache, std::move(*key), response);
+
+                if (exception)
+                {
+                    handler(std::move(exception), result{});
+                    return;
+                }
+
+                auto value = try_make_result(std::move(response));
+                if (value)
+                    handler(nullptr, std::move(*value));
+                else
+                    handler(value.error().to_exception(), result{});
+            };
+
+        if (async_executor_)
+        {
+            async_executor_(std::move(request), std::move(on_response));
+            return;
+        }
+
+        std::exception_ptr error;
+        type::buffer response;
+
+        try
+        {
+            if (!executor_)
+                throw exception::client{"[nanorpc::core::client::async_call] No executor."};
+
+            response = executor_(std::move(request));
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        on_response(std::move(error), std::move(response));
+    }
+
+    class batch_call final
+    {
+    public:
+        batch_call(batch_call &&) noexcept = default;
+        batch_call& operator = (batch_call &&) noexcept = default;
+        ~batch_call() noexcept = default;
+
+        template <typename ... TArgs>
+        std::future<result> call(std::string_view name, TArgs && ... args)
+        {
+            return call(method_id(name), std::forward<TArgs>(args) ... );
+        }
+
+        template <typename ... TArgs>
+        std::future<result> call(type::id id, TArgs && ... args)
+        {
+            auto request = make_request(id, std::forward<TArgs>(args) ... );
+            request_.insert(std::end(request_), std::begin(request), std::end(request));
+
+            promises_.emplace_back();
+            return promises_.back().get_future();
+        }
 
+        // Sends all collected calls in one request and waits for the response. The errors
+        // of the transport are thrown and also passed to every future, the errors of
+        // the calls are passed only to their futures. The batch can be used again after send.
+        void send()
         {
-            version::core::protocol::value_type protocol{};
-            response = response.unpack(protocol);
-            if (protocol != version::core::protocol::value)
+            auto promises = std::move(promises_);
+            promises_.clear();
+
+            auto request = std::move(request_);
+            request_ = detail::header::make_buffer();
+
+            if (promises.empty())
+                return;
+
+            detail::header request_header;
+            request_header.type = detail::pack::meta::type::batch_request;
+            request_header.write(request);
+
+            std::vector<type::buffer> responses;
+
+            try
+            {
+                responses = make_responses(owner_->execute(std::move(request)));
+                if (responses.size() != promises.size())
+                    throw exception::client{"[nanorpc::core::client::batch::send] Bad count of the responses."};
+            }
+            catch (...)
             {
-                throw exception::client{"[nanorpc::core::client::call] Unsupported protocol version \"" +
-                        std::to_string(protocol) + "\"."};
+                for (auto &i : promises)
+                    i.set_exception(std::current_exception());
+                throw;
+            }
+
+            for (std::size_t i = 0 ; i < promises.size() ; ++i)
+            {
+                auto value = try_make_result(std::move(responses[i]));
+                if (value)
+                    promises[i].set_value(std::move(*value));
+                else
+                    promises[i].set_exception(value.error().to_exception());
             }
         }
 
+    private:
+        friend class client;
+
+        client *owner_;
+        type::buffer request_ = detail::header::make_buffer();
+        std::vector<std::promise<result>> promises_;
+
+        explicit batch_call(client &owner)
+            : owner_{&owner}
         {
-            detail::pack::meta::type type{};
-            response = response.unpack(type);
-            if (type != detail::pack::meta::type::response)
-                throw exception::client{"[nanorpc::core::client::call] Bad response type."};
         }
 
+        batch_call(batch_call const &) = delete;
+        batch_call& operator = (batch_call const &) = delete;
+
+        static std::vector<type::buffer> make_responses(type::buffer buffer)
         {
-            detail::pack::meta::status status{};
-            response = response.unpack(status);
-            if (status != detail::pack::meta::status::good)
+            detail::header response_header;
+            if (!response_header.read(buffer))
+                throw exception::client{"[nanorpc::core::client::batch::send] Bad response header."};
+
+            if (response_header.version != version::core::protocol::value)
+            {
+                throw exception::client{"[nanorpc::core::client::batch::send] Unsupported protocol version \"" +
+                        std::to_string(response_header.version) + "\"."};
+            }
+
+            if (response_header.type != detail::pack::meta::type::batch_response)
+                throw exception::client{"[nanorpc::core::client::batch::send] Bad response type."};
+
+            if (response_header.payload_size > buffer.size() - detail::header::size)
+                throw exception::client{"[nanorpc::core::client::batch::send] Bad payload size."};
+
+            if (response_header.status != detail::pack::meta::status::good)
             {
                 std::string message;
-                response = response.unpack(message);
+                packer_type{}.from_buffer(std::move(buffer), detail::header::size).unpack(message);
+                if (response_header.status == detail::pack::meta::status::overload)
+                    throw exception::overload{message};
+                if (response_header.status == detail::pack::meta::status::timeout)
+                    throw exception::timeout{message};
                 throw exception::logic{message};
             }
+
+            std::vector<type::buffer> responses;
+            if (!detail::split_messages(buffer, detail::header::size, responses))
+                throw exception::client{"[nanorpc::core::client::batch::send] Bad batch response."};
+
+            return responses;
         }
+    };
 
-        return {std::move(response)};
-    }
+#ifdef __cpp_impl_coroutine
+    class awaitable final
+    {
+    public:
+        awaitable(client &owner, type::buffer request)
+            : owner_{owner}
+            , request_{std::move(request)}
+        {
+        }
 
-private:
-    using packer_type = TPacker;
-    using deserializer_type = typename packer_type::deserializer_type;
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
 
-    type::executor executor_;
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            owner_.async_execute(std::move(request_), [this, handle] (std::exception_ptr exception, result value)
+                    {
+                        exception_ = std::move(exception);
+                        value_.emplace(std::move(value));
+                        handle.resume();
+                    }
+                );
+        }
+
+        result await_resume()
+        {
+            if (exception_)
+                std::rethrow_exception(exception_);
+            return std::move(*value_);
+        }
+
+    private:
+        client &owner_;
+        type::buffer request_;
+        std::exception_ptr exception_;
+        std::optional<result> value_;
+    };
+#endif  // !__cpp_impl_coroutine
 
     class result final
     {
@@ -124,7 +841,16 @@ private:
                  deserializer_.reset();
             }
 
-            return std::any_cast<Type>(*value_);
+            if (auto const *value = std::any_cast<Type>(&*value_))
+                return *value;
+
+            // The result of a direct call is converted by the packer as the packed result is.
+            if (!packer_)
+                throw exception::client{"[nanorpc::core::client::result::as] Bad type of the result."};
+
+            Type data{};
+            packer_type{}.from_buffer(packer_(*value_)).unpack(data);
+            return data;
         }
 
         template <typename T>
@@ -139,14 +865,44 @@ private:
 
         mutable std::optional<deserializer_type> deserializer_;
         mutable std::optional<std::any> value_;
+        type::result_packer packer_ = nullptr;
+
+        result() = default;
 
         result(deserializer_type deserializer)
             : deserializer_{std::move(deserializer)}
         {
         }
 
+        result(std::any value, type::result_packer packer = nullptr)
+            : value_{std::move(value)}
+            , packer_{packer}
+        {
+        }
+
         result(result const &) = delete;
         result& operator = (result const &) = delete;
+
+        // Moves the value out of the result without a copy into std::any.
+        template <typename T>
+        T take()
+        {
+            if constexpr (!std::is_void_v<T>)
+            {
+                if (deserializer_)
+                {
+                    T data{};
+                    deserializer_->unpack(data);
+                    deserializer_.reset();
+                    return data;
+                }
+
+                if (auto *value = value_ ? std::any_cast<T>(&*value_) : nullptr)
+                    return std::move(*value);
+
+                return as<T>();
+            }
+        }
     };
 };
 
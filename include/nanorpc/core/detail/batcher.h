@@ -0,0 +1,316 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_BATCHER_H__
+#define __NANO_RPC_CORE_DETAIL_BATCHER_H__
+
+// STD
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/execute.h"
+#include "nanorpc/core/detail/function_meta.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct batch_options final
+{
+    // How long the first call of a batch waits for the others.
+    std::chrono::microseconds window{1000};
+    // The batch is executed at once when it has this number of calls.
+    std::size_t max_size = 64;
+};
+
+namespace detail
+{
+
+template <typename>
+struct is_tuple
+    : std::false_type
+{
+};
+
+template <typename ... T>
+struct is_tuple<std::tuple<T ... >>
+    : std::true_type
+{
+};
+
+// Collects the concurrent calls of a method and executes them by one call of the batch handler.
+// The handler takes std::vector of the arguments (a single value or std::tuple for many arguments)
+// and returns std::vector of the results in the same order.
+// The closed batch is given to the scheduler of the server, so neither the thread of the call
+// which fills it nor the thread of the window waits for the handler. Without the scheduler
+// (or if it fails) the batch is executed by the thread which closed it.
+template <typename TPacker, typename TFunc>
+class batcher final
+{
+public:
+    using function_type = TFunc;
+    using function_meta = callable_meta<function_type>;
+    using arguments_tuple_type = typename function_meta::arguments_tuple_type;
+
+    static_assert(std::tuple_size_v<arguments_tuple_type> == 1,
+            "[nanorpc::core::server::handle_batch] The batch handler must have one parameter.");
+
+    using items_type = std::tuple_element_t<0, arguments_tuple_type>;
+    using item_type = typename items_type::value_type;
+    using results_type = typename function_meta::return_type;
+
+    static_assert(std::is_same_v<items_type, std::vector<item_type>>,
+            "[nanorpc::core::server::handle_batch] The batch handler must take std::vector.");
+    static_assert(std::is_same_v<results_type, std::vector<typename results_type::value_type>>,
+            "[nanorpc::core::server::handle_batch] The batch handler must return std::vector.");
+
+    using reply_type = reply<TPacker>;
+    using replies_type = std::vector<reply_type>;
+
+    batcher(function_type func, batch_options options, type::scheduler scheduler)
+        : func_{std::make_shared<function_type>(std::move(func))}
+        , options_{std::move(options)}
+        , scheduler_{std::move(scheduler)}
+    {
+        if (!options_.max_size)
+            throw std::invalid_argument{"[nanorpc::core::server::handle_batch] The max size must be greater than 0."};
+
+        flusher_ = std::thread{[this] { run(); }};
+    }
+
+    ~batcher() noexcept
+    {
+        {
+            std::lock_guard lock{lock_};
+            stopped_ = true;
+        }
+
+        ready_.notify_one();
+        flusher_.join();
+    }
+
+    template <typename TDeserializer>
+    void operator () (TDeserializer &request, reply_type &response)
+    {
+        std::conditional_t<is_tuple<item_type>::value, item_type, std::tuple<item_type>> data;
+        request = request.unpack(data);
+
+        items_type items;
+        replies_type replies;
+
+        {
+            std::lock_guard lock{lock_};
+
+            if constexpr (is_tuple<item_type>::value)
+                items_.push_back(std::move(data));
+            else
+                items_.push_back(std::move(std::get<0>(data)));
+
+            replies_.push_back(std::move(response));
+
+            if (items_.size() < options_.max_size)
+            {
+                if (items_.size() == 1)
+                {
+                    deadline_ = std::chrono::steady_clock::now() + options_.window;
+                    ready_.notify_one();
+                }
+                return;
+            }
+
+            items = std::exchange(items_, items_type{});
+            replies = std::exchange(replies_, replies_type{});
+        }
+
+        flush(std::move(items), std::move(replies));
+    }
+
+private:
+    struct batch_type final
+    {
+        items_type items;
+        replies_type replies;
+    };
+
+    // The handler is shared with the scheduled batches, they may outlive the batcher.
+    std::shared_ptr<function_type> func_;
+    batch_options options_;
+    type::scheduler scheduler_;
+
+    std::mutex lock_;
+    std::condition_variable ready_;
+    items_type items_;
+    replies_type replies_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool stopped_ = false;
+
+    std::thread flusher_;
+
+    batcher(batcher const &) = delete;
+    batcher& operator = (batcher const &) = delete;
+
+    void run() noexcept
+    {
+        for (;;)
+        {
+            items_type items;
+            replies_type replies;
+
+            {
+                std::unique_lock lock{lock_};
+                ready_.wait(lock, [this] { return stopped_ || !items_.empty(); });
+
+                if (!stopped_)
+                {
+                    ready_.wait_until(lock, deadline_, [this]
+                            { return stopped_ || items_.empty() || std::chrono::steady_clock::now() >= deadline_; }
+                        );
+                }
+
+                if (stopped_ && items_.empty())
+                    return;
+
+                items = std::exchange(items_, items_type{});
+                replies = std::exchange(replies_, replies_type{});
+            }
+
+            if (!items.empty())
+                flush(std::move(items), std::move(replies));
+        }
+    }
+
+    void flush(items_type items, replies_type replies) noexcept
+    {
+        if (!scheduler_)
+        {
+            execute(*func_, std::move(items), std::move(replies));
+            return;
+        }
+
+        std::shared_ptr<batch_type> batch;
+
+        try
+        {
+            batch = std::make_shared<batch_type>();
+            batch->items = std::move(items);
+            batch->replies = std::move(replies);
+
+            scheduler_([func = func_, batch]
+                    { execute(*func, std::move(batch->items), std::move(batch->replies)); }
+                );
+            return;
+        }
+        catch (...)
+        {
+        }
+
+        if (batch)
+            execute(*func_, std::move(batch->items), std::move(batch->replies));
+        else
+            execute(*func_, std::move(items), std::move(replies));
+    }
+
+    static void execute(function_type &func, items_type items, replies_type replies) noexcept
+    {
+        drop_expired(items, replies);
+        if (items.empty())
+            return;
+
+        try
+        {
+            auto const results = func(std::move(items));
+            if (results.size() != replies.size())
+            {
+                throw exception::server{"[nanorpc::core::server::handle_batch] The batch handler returned " +
+                        std::to_string(results.size()) + " results for " + std::to_string(replies.size()) + " calls."};
+            }
+
+            for (std::size_t i = 0 ; i < replies.size() ; ++i)
+                send(replies[i], results[i]);
+        }
+        catch (...)
+        {
+            auto const message = to_message(std::current_exception());
+            for (auto &i : replies)
+                fail(i, message);
+        }
+    }
+
+    // The calls which deadlines have passed while they were waiting for the batch are not executed.
+    static void drop_expired(items_type &items, replies_type &replies) noexcept
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0 ; i < replies.size() ; ++i)
+        {
+            if (replies[i].get_stop_token().stop_requested())
+            {
+                try
+                {
+                    replies[i].expire("[nanorpc::core::server::handle_batch] The deadline has passed.");
+                }
+                catch (...)
+                {
+                }
+                continue;
+            }
+
+            if (count != i)
+            {
+                items[count] = std::move(items[i]);
+                replies[count] = std::move(replies[i]);
+            }
+            ++count;
+        }
+
+        items.erase(std::next(std::begin(items), count), std::end(items));
+        replies.erase(std::next(std::begin(replies), count), std::end(replies));
+    }
+
+    template <typename T>
+    static void send(reply_type &response, T const &value) noexcept
+    {
+        try
+        {
+            response.send(value);
+        }
+        catch (std::exception const &e)
+        {
+            fail(response, e.what());
+        }
+    }
+
+    static void fail(reply_type &response, std::string const &message) noexcept
+    {
+        try
+        {
+            if (response)
+                response.fail(message);
+        }
+        catch (...)
+        {
+        }
+    }
+};
+
+}   // namespace detail
+}   // namespace nanorpc::core
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_BATCHER_H__
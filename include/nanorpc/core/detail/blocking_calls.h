@@ -0,0 +1,145 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_BLOCKING_CALLS_H__
+#define __NANO_RPC_CORE_DETAIL_BLOCKING_CALLS_H__
+
+// STD
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core::detail
+{
+
+// Runs the calls of a synchronous executor on a few threads of their own, so the caller can stop
+// waiting for them at the deadline. The threads are made when all the others are busy, up to
+// max_threads, the next calls wait for them; an idle thread ends after idle_timeout.
+// The threads are detached: the calls stuck in the executor are given up by the destructor
+// and the calls not started yet are dropped, so the tasks must not refer to their owner.
+class blocking_calls final
+{
+public:
+    static constexpr std::size_t max_threads = 16;
+    static constexpr std::chrono::seconds idle_timeout{30};
+
+    blocking_calls()
+        : state_{std::make_shared<state>()}
+    {
+    }
+
+    ~blocking_calls() noexcept
+    {
+        std::deque<type::task> tasks;
+
+        {
+            std::lock_guard lock{state_->lock};
+            state_->stopped = true;
+            std::swap(tasks, state_->tasks);
+        }
+
+        state_->ready.notify_all();
+    }
+
+    void run(type::task task)
+    {
+        auto &calls = *state_;
+
+        {
+            std::lock_guard lock{calls.lock};
+            calls.tasks.push_back(std::move(task));
+
+            // Every idle thread takes one of the tasks.
+            if (calls.tasks.size() <= calls.idle || calls.threads == max_threads)
+            {
+                calls.ready.notify_one();
+                return;
+            }
+
+            ++calls.threads;
+        }
+
+        try
+        {
+            std::thread{[self = state_] { work(*self); }}.detach();
+        }
+        catch (...)
+        {
+            std::lock_guard lock{calls.lock};
+            --calls.threads;
+            throw;
+        }
+    }
+
+private:
+    struct state final
+    {
+        std::mutex lock;
+        std::condition_variable ready;
+        std::deque<type::task> tasks;
+        std::size_t threads = 0;
+        std::size_t idle = 0;
+        bool stopped = false;
+    };
+
+    std::shared_ptr<state> state_;
+
+    blocking_calls(blocking_calls const &) = delete;
+    blocking_calls& operator = (blocking_calls const &) = delete;
+
+    static void work(state &calls) noexcept
+    {
+        std::unique_lock lock{calls.lock};
+
+        for (;;)
+        {
+            if (calls.stopped)
+                break;
+
+            if (!calls.tasks.empty())
+            {
+                auto task = std::move(calls.tasks.front());
+                calls.tasks.pop_front();
+                lock.unlock();
+
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                }
+
+                task = nullptr;
+                lock.lock();
+                continue;
+            }
+
+            ++calls.idle;
+            auto const woken = calls.ready.wait_for(lock, idle_timeout,
+                    [&calls] { return calls.stopped || !calls.tasks.empty(); });
+            --calls.idle;
+
+            if (!woken)
+                break;
+        }
+
+        --calls.threads;
+    }
+};
+
+}   // namespace nanorpc::core::detail
+
+#endif  // !__NANO_RPC_CORE_DETAIL_BLOCKING_CALLS_H__
@@ -0,0 +1,126 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_BOUNDED_QUEUE_H__
+#define __NANO_RPC_CORE_DETAIL_BOUNDED_QUEUE_H__
+
+// STD
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace nanorpc::core::detail
+{
+
+// A lock-free queue of a fixed capacity for many producers and consumers (D. Vyukov's bounded
+// MPMC queue). Every cell has a sequence number which tells whether it's free for the producer
+// of the position or filled for the consumer of it, so the threads only race for the positions.
+template <typename T>
+class bounded_queue final
+{
+public:
+    // The capacity is rounded up to a power of two.
+    explicit bounded_queue(std::size_t capacity)
+    {
+        if (!capacity)
+            throw std::invalid_argument{"[nanorpc::core::detail::bounded_queue] The capacity must be greater than 0."};
+
+        std::size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+
+        mask_ = size - 1;
+        cells_ = std::make_unique<cell[]>(size);
+        for (std::size_t i = 0 ; i < size ; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Returns false if the queue is full.
+    bool try_push(T &value)
+    {
+        auto position = tail_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto &item = cells_[position & mask_];
+            auto const sequence = item.sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (!diff)
+            {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    item.value = std::move(value);
+                    item.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::optional<T> try_pop()
+    {
+        auto position = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto &item = cells_[position & mask_];
+            auto const sequence = item.sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+            if (!diff)
+            {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    std::optional<T> value{std::move(item.value)};
+                    item.value = T{};
+                    item.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return value;
+                }
+            }
+            else if (diff < 0)
+            {
+                return std::nullopt;
+            }
+            else
+            {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct cell final
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::size_t mask_ = 0;
+    std::unique_ptr<cell[]> cells_;
+
+    // The positions are apart to not share a cache line.
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<std::size_t> head_{0};
+
+    bounded_queue(bounded_queue const &) = delete;
+    bounded_queue& operator = (bounded_queue const &) = delete;
+};
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_BOUNDED_QUEUE_H__
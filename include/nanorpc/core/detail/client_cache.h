@@ -0,0 +1,126 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_CLIENT_CACHE_H__
+#define __NANO_RPC_CORE_DETAIL_CLIENT_CACHE_H__
+
+// STD
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/detail/request_key.h"
+#include "nanorpc/core/detail/response_cache.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core::detail
+{
+
+// The cached responses of the methods on the client side.
+//
+// Every response of the server carries the epoch of the server, the count of its invalidations.
+// A response with a newer epoch than the client has seen drops the responses of all methods,
+// since the client doesn't know which of them has been changed; a response with an older epoch
+// was built before an invalidation and isn't cached. The clients which track the invalidations
+// get the method and the new epoch by a push and drop only the responses of that method.
+class client_cache final
+{
+public:
+    // The methods are configured before the calls.
+    void add(type::id id, cache_options options)
+    {
+        caches_[id] = std::make_shared<response_cache>(std::move(options));
+    }
+
+    // Returns the cache of the method of the request and its key, nullptr if the request isn't cached.
+    std::shared_ptr<response_cache> find(type::buffer const &request, std::optional<request_key> &key) const
+    {
+        header request_header;
+        if (!request_header.read(request) || request_header.type != pack::meta::type::request ||
+                (request_header.flags & header::flag_one_way))
+        {
+            return nullptr;
+        }
+
+        auto const iter = caches_.find(request_header.id);
+        if (iter == std::end(caches_))
+            return nullptr;
+
+        key = make_request_key(request_header, request);
+        return key ? iter->second : nullptr;
+    }
+
+    // An invalidation which comes while the response is being put clears the cache
+    // and the response isn't put.
+    void update(response_cache &cache, request_key key, type::buffer const &response)
+    {
+        header response_header;
+        if (!response_header.read(response))
+            return;
+
+        auto const generation = cache.generation();
+        if (advance(response_header.epoch))
+            cache.put(std::move(key), response, generation);
+    }
+
+    void invalidate(type::id id)
+    {
+        if (auto const iter = caches_.find(id) ; iter != std::end(caches_))
+            iter->second->clear();
+    }
+
+    // The data of the method has been changed in the epoch. If the client has seen the previous
+    // epoch, the other methods are kept, otherwise some invalidations have been missed.
+    void invalidate(type::id id, std::uint32_t epoch)
+    {
+        invalidate(id);
+
+        if (auto previous = epoch - 1 ; !epoch_.compare_exchange_strong(previous, epoch, std::memory_order_acq_rel))
+            advance(epoch);
+    }
+
+    void invalidate()
+    {
+        for (auto &i : caches_)
+            i.second->clear();
+    }
+
+private:
+    std::map<type::id, std::shared_ptr<response_cache>> caches_;
+    std::atomic<std::uint32_t> epoch_{0};
+
+    // Returns false if the epoch is older than the last seen one, 0 - the server doesn't invalidate.
+    bool advance(std::uint32_t epoch)
+    {
+        auto last = epoch_.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (epoch < last)
+                return false;
+
+            if (epoch == last)
+                return true;
+
+            if (epoch_.compare_exchange_weak(last, epoch, std::memory_order_acq_rel))
+            {
+                invalidate();
+                return true;
+            }
+        }
+    }
+};
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_CLIENT_CACHE_H__
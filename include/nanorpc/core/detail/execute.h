@@ -0,0 +1,602 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_EXECUTE_H__
+#define __NANO_RPC_CORE_DETAIL_EXECUTE_H__
+
+// STD
+#include <any>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/function_meta.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/promise.h"
+#include "nanorpc/core/stop_token.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/version/core.h"
+
+namespace nanorpc::core::detail
+{
+
+// The pending response of a call. It's completed only once by send or fail.
+// The reply without a completion (e.g. of a one-way call) ignores send and fail.
+// The completion of a one-way call, called already, is held by the reply till the end
+// of the call, so what it keeps (e.g. the limits of the server) lasts as long as the call.
+template <typename TPacker>
+class reply final
+{
+public:
+    reply(header response_header, type::completion done, stop_token token = {}, type::completion held = nullptr)
+        : header_{std::move(response_header)}
+        , done_{std::move(done)}
+        , token_{std::move(token)}
+        , held_{std::move(held)}
+    {
+    }
+
+    reply(reply &&) noexcept = default;
+    reply& operator = (reply &&) noexcept = default;
+    ~reply() noexcept = default;
+
+    explicit operator bool () const noexcept
+    {
+        return static_cast<bool>(done_);
+    }
+
+    void send()
+    {
+        if (done_)
+            complete(TPacker{}.append_to(header::make_buffer()).to_buffer(), pack::meta::status::good);
+    }
+
+    template <typename T>
+    void send(T const &value)
+    {
+        if (done_)
+            complete(TPacker{}.append_to(header::make_buffer()).pack(value).to_buffer(), pack::meta::status::good);
+    }
+
+    // The buffer has a room for the header, its payload is written as is.
+    void send_raw(type::buffer buffer)
+    {
+        if (done_)
+            complete(std::move(buffer), pack::meta::status::good);
+    }
+
+    void fail(std::string const &message)
+    {
+        if (done_)
+            complete(TPacker{}.append_to(header::make_buffer()).pack(message).to_buffer(), pack::meta::status::fail);
+    }
+
+    // The call was not executed, the caller can try it again later.
+    void reject(std::string const &message)
+    {
+        if (done_)
+            complete(TPacker{}.append_to(header::make_buffer()).pack(message).to_buffer(), pack::meta::status::overload);
+    }
+
+    // The call was not executed, the caller doesn't wait for it anymore.
+    void expire(std::string const &message)
+    {
+        if (done_)
+            complete(TPacker{}.append_to(header::make_buffer()).pack(message).to_buffer(), pack::meta::status::timeout);
+    }
+
+    stop_token const& get_stop_token() const noexcept
+    {
+        return token_;
+    }
+
+private:
+    header header_;
+    type::completion done_;
+    stop_token token_;
+    type::completion held_;
+
+    reply(reply const &) = delete;
+    reply& operator = (reply const &) = delete;
+
+    void complete(type::buffer buffer, pack::meta::status status)
+    {
+        header_.status = status;
+        header_.write(buffer);
+        auto done = std::move(done_);
+        done_ = nullptr;
+        done(nullptr, std::move(buffer));
+    }
+};
+
+inline std::string to_message(std::exception_ptr exception)
+{
+    try
+    {
+        std::rethrow_exception(exception);
+    }
+    catch (std::exception const &e)
+    {
+        return e.what();
+    }
+    catch (...)
+    {
+        return "Unknown error.";
+    }
+}
+
+template <typename TPacker, typename T>
+class reply_promise_state_base
+    : public promise_state<T>
+{
+public:
+    explicit reply_promise_state_base(reply<TPacker> response)
+        : reply_{std::move(response)}
+    {
+    }
+
+    virtual ~reply_promise_state_base() noexcept
+    {
+        if (this->acquire())
+            fail("[nanorpc::core::server::execute] The promise was destroyed without a result.");
+    }
+
+    virtual void set_exception(std::exception_ptr exception) noexcept override final
+    {
+        fail(to_message(std::move(exception)));
+    }
+
+    virtual stop_token get_stop_token() const noexcept override final
+    {
+        return reply_.get_stop_token();
+    }
+
+protected:
+    template <typename ... TValue>
+    void send(TValue const & ... value) noexcept
+    {
+        try
+        {
+            reply_.send(value ... );
+        }
+        catch (std::exception const &e)
+        {
+            fail(e.what());
+        }
+    }
+
+private:
+    reply<TPacker> reply_;
+
+    void fail(std::string const &message) noexcept
+    {
+        try
+        {
+            if (reply_)
+                reply_.fail(message);
+        }
+        catch (...)
+        {
+        }
+    }
+};
+
+template <typename TPacker, typename T>
+class reply_promise_state final
+    : public reply_promise_state_base<TPacker, T>
+{
+public:
+    using reply_promise_state_base<TPacker, T>::reply_promise_state_base;
+
+    virtual void set_value(T value) noexcept override
+    {
+        this->send(value);
+    }
+};
+
+template <typename TPacker>
+class reply_promise_state<TPacker, void> final
+    : public reply_promise_state_base<TPacker, void>
+{
+public:
+    using reply_promise_state_base<TPacker, void>::reply_promise_state_base;
+
+    virtual void set_value() noexcept override
+    {
+        this->send();
+    }
+};
+
+template <typename T, std::size_t ... I>
+std::tuple<std::tuple_element_t<I, T> ... > tuple_head(std::index_sequence<I ... >);
+
+template <typename T, std::size_t N>
+using tuple_head_t = decltype(tuple_head<T>(std::make_index_sequence<N>{}));
+
+template <typename TFunc>
+constexpr bool is_async_handler() noexcept
+{
+    using arguments_tuple_type = typename callable_meta<TFunc>::arguments_tuple_type;
+    constexpr auto arity = std::tuple_size_v<arguments_tuple_type>;
+    if constexpr (arity != 0)
+        return is_promise_v<std::tuple_element_t<arity - 1, arguments_tuple_type>>;
+    else
+        return false;
+}
+
+// The last parameter of a synchronous handler can be core::stop_token.
+template <typename TFunc>
+constexpr bool has_stop_token() noexcept
+{
+    using arguments_tuple_type = typename callable_meta<TFunc>::arguments_tuple_type;
+    constexpr auto arity = std::tuple_size_v<arguments_tuple_type>;
+    if constexpr (arity != 0)
+        return is_stop_token_v<std::tuple_element_t<arity - 1, arguments_tuple_type>>;
+    else
+        return false;
+}
+
+// The parameters of the handler which are unpacked from the request.
+template <typename TFunc>
+using request_arguments_t = tuple_head_t<typename callable_meta<TFunc>::arguments_tuple_type,
+        std::tuple_size_v<typename callable_meta<TFunc>::arguments_tuple_type> -
+        ((is_async_handler<TFunc>() || has_stop_token<TFunc>()) ? 1 : 0)>;
+
+// Synchronous handlers complete the call before return. The last parameter of asynchronous
+// handlers is core::promise, the call is completed when the promise gets a result.
+template <typename TPacker, typename TFunc, typename TDeserializer>
+void invoke(TFunc &func, TDeserializer &request, reply<TPacker> &response)
+{
+    using function_meta = callable_meta<TFunc>;
+    using arguments_tuple_type = typename function_meta::arguments_tuple_type;
+
+    if constexpr (is_async_handler<TFunc>())
+    {
+        constexpr auto arity = std::tuple_size_v<arguments_tuple_type>;
+        using promise_type = std::tuple_element_t<arity - 1, arguments_tuple_type>;
+        using value_type = typename promise_type::value_type;
+        using data_type = tuple_head_t<arguments_tuple_type, arity - 1>;
+
+        data_type data;
+        request = request.unpack(data);
+
+        promise_type promise{std::make_shared<reply_promise_state<TPacker, value_type>>(std::move(response))};
+
+        try
+        {
+            std::apply([&func, &promise] (auto && ... args)
+                    { func(std::move(args) ... , promise); },
+                    std::move(data)
+                );
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    }
+    else if constexpr (has_stop_token<TFunc>())
+    {
+        constexpr auto arity = std::tuple_size_v<arguments_tuple_type>;
+        using data_type = tuple_head_t<arguments_tuple_type, arity - 1>;
+
+        data_type data;
+        request = request.unpack(data);
+
+        auto call = [&func, token = response.get_stop_token()] (auto && ... args)
+            { return func(std::move(args) ... , token); };
+
+        using return_type = decltype(std::apply(call, std::declval<data_type>()));
+
+        if constexpr (std::is_same_v<std::decay_t<return_type>, void>)
+        {
+            std::apply(call, std::move(data));
+            response.send();
+        }
+        else
+        {
+            response.send(std::apply(call, std::move(data)));
+        }
+    }
+    else
+    {
+        using return_type = decltype(std::apply(func, std::declval<arguments_tuple_type>()));
+
+        arguments_tuple_type data;
+        request = request.unpack(data);
+
+        if constexpr (std::is_same_v<std::decay_t<return_type>, void>)
+        {
+            std::apply(func, std::move(data));
+            response.send();
+        }
+        else
+        {
+            response.send(std::apply(func, std::move(data)));
+        }
+    }
+}
+
+template <typename TPacker, typename TDispatcher>
+void async_execute(type::buffer buffer, type::completion done, TDispatcher &&dispatch,
+        type::scheduler const &schedule, stop_token token = {});
+
+// The calls of a batch are independent, so each of them is given to the scheduler.
+// The responses are written in the order of the requests when the last call is completed.
+template <typename TPacker, typename TDispatcher>
+void async_execute_batch(type::buffer buffer, reply<TPacker> &response, TDispatcher dispatch,
+        type::scheduler const &schedule)
+{
+    std::vector<type::buffer> requests;
+    if (!split_messages(buffer, header::size, requests))
+    {
+        response.fail("[nanorpc::core::server::execute] Bad batch.");
+        return;
+    }
+
+    for (auto const &i : requests)
+    {
+        header request_header;
+        request_header.read(i);
+        if (request_header.type != pack::meta::type::request)
+        {
+            response.fail("[nanorpc::core::server::execute] Bad request type in the batch.");
+            return;
+        }
+    }
+
+    struct batch_state
+    {
+        std::mutex lock;
+        std::size_t pending = 0;
+        std::vector<type::buffer> responses;
+        reply<TPacker> response;
+
+        explicit batch_state(reply<TPacker> batch_response)
+            : response{std::move(batch_response)}
+        {
+        }
+
+        void complete(std::size_t index, type::buffer buffer)
+        {
+            {
+                std::lock_guard guard{lock};
+                responses[index] = std::move(buffer);
+            }
+
+            release();
+        }
+
+        void release()
+        {
+            {
+                std::lock_guard guard{lock};
+                if (--pending)
+                    return;
+            }
+
+            auto message = header::make_buffer();
+            for (auto const &i : responses)
+                message.insert(std::end(message), std::begin(i), std::end(i));
+
+            response.send_raw(std::move(message));
+        }
+    };
+
+    auto const token = response.get_stop_token();
+    auto state = std::make_shared<batch_state>(std::move(response));
+    state->responses.resize(requests.size());
+    // The extra count keeps the batch from being completed while the calls are being scheduled.
+    state->pending = requests.size() + 1;
+
+    for (std::size_t i = 0 ; i < requests.size() ; ++i)
+    {
+        auto task = [state, i, dispatch, token, request = std::make_shared<type::buffer>(std::move(requests[i]))]
+            {
+                async_execute<TPacker>(std::move(*request),
+                        [state, i] (std::exception_ptr, type::buffer buffer)
+                        { state->complete(i, std::move(buffer)); },
+                        dispatch, type::scheduler{}, token
+                    );
+            };
+
+        if (schedule)
+        {
+            try
+            {
+                schedule(task);
+                continue;
+            }
+            catch (...)
+            {
+            }
+        }
+
+        task();
+    }
+
+    state->release();
+}
+
+// Calls a synchronous handler with the arguments as is. Returns false if the arguments are not
+// of the handler's types. The errors of the handler are thrown as they come from a remote call.
+// The packer of the result is set for the conversion of the result to another type.
+template <typename TPacker, typename TFunc>
+bool invoke_direct(TFunc &func, std::any &arguments, std::any &result, type::result_packer &packer)
+{
+    using function_meta = callable_meta<TFunc>;
+    using arguments_tuple_type = typename function_meta::arguments_tuple_type;
+    constexpr auto arity = std::tuple_size_v<arguments_tuple_type>;
+    using data_type = std::conditional_t<has_stop_token<TFunc>(),
+            tuple_head_t<arguments_tuple_type, (arity ? arity - 1 : 0)>, arguments_tuple_type>;
+
+    auto call = [&func] (auto && ... args)
+        {
+            if constexpr (has_stop_token<TFunc>())
+                return func(std::move(args) ... , stop_token{});
+            else
+                return func(std::move(args) ... );
+        };
+
+    using return_type = decltype(std::apply(call, std::declval<data_type>()));
+
+    auto *data = std::any_cast<data_type>(&arguments);
+    if (!data)
+        return false;
+
+    try
+    {
+        if constexpr (std::is_same_v<std::decay_t<return_type>, void>)
+        {
+            std::apply(call, std::move(*data));
+        }
+        else
+        {
+            result = std::apply(call, std::move(*data));
+            packer = [] (std::any const &value)
+                {
+                    return TPacker{}.pack(std::any_cast<std::decay_t<return_type> const &>(value)).to_buffer();
+                };
+        }
+    }
+    catch (std::exception const &e)
+    {
+        throw exception::logic{e.what()};
+    }
+
+    return true;
+}
+
+// Returns the error message if the request can't be executed.
+inline std::optional<std::string> check_request(bool valid, header const &request_header, std::size_t size)
+{
+    if (!valid)
+        return "[nanorpc::core::server::execute] Bad header.";
+
+    if (request_header.version != version::core::protocol::value)
+    {
+        return "[nanorpc::core::server::execute] Unsupported protocol version \"" +
+                std::to_string(request_header.version) + "\".";
+    }
+
+    if (request_header.type != pack::meta::type::request && request_header.type != pack::meta::type::batch_request)
+        return "[nanorpc::core::server::execute] Bad request type.";
+
+    if (request_header.payload_size > size - header::size)
+        return "[nanorpc::core::server::execute] Bad payload size.";
+
+    return std::nullopt;
+}
+
+// The dispatcher is called as bool (type::id, deserializer &, reply &) and returns false
+// if there is no handler for the id. It's a template parameter, so it can be inlined into execute.
+// The scheduler runs the calls of a batch; without it they are run one by one on the calling thread.
+// The call is dropped before the arguments are unpacked if its deadline has passed. The deadline
+// is taken from the budget of the request if the token (e.g. of the batch) has no deadline.
+template <typename TPacker, typename TDispatcher>
+void async_execute(type::buffer buffer, type::completion done, TDispatcher &&dispatch,
+        type::scheduler const &schedule, stop_token token)
+{
+    header request_header;
+    auto const valid = request_header.read(buffer);
+    auto const batch = valid && request_header.type == pack::meta::type::batch_request;
+
+    // The one-way call is completed at once with an empty response, its result and errors are dropped.
+    type::completion held;
+    if (valid && (request_header.flags & header::flag_one_way))
+    {
+        done(nullptr, {});
+        held = std::move(done);
+        done = nullptr;
+    }
+
+    header response_header;
+    response_header.type = batch ? pack::meta::type::batch_response : pack::meta::type::response;
+    response_header.id = request_header.id;
+    response_header.request_id = request_header.request_id;
+
+    if (valid && !token.stop_possible())
+        token = stop_token::from_budget(request_header.budget);
+
+    reply<TPacker> response{std::move(response_header), std::move(done), token, std::move(held)};
+
+    if (auto const error = check_request(valid, request_header, buffer.size()))
+    {
+        response.fail(*error);
+        return;
+    }
+
+    if (token.stop_requested())
+    {
+        response.expire("[nanorpc::core::server::execute] The deadline has passed.");
+        return;
+    }
+
+    // Only the packer and the handlers can throw, all errors of the core are sent as is.
+    try
+    {
+        if (batch)
+        {
+            buffer.resize(header::size + request_header.payload_size);
+            async_execute_batch<TPacker>(std::move(buffer), response, dispatch, schedule);
+            return;
+        }
+
+        auto request = TPacker{}.from_buffer(std::move(buffer), header::size);
+
+        if (dispatch(request_header.id, request, response))
+            return;
+    }
+    catch (std::exception const &e)
+    {
+        response.fail(e.what());
+        return;
+    }
+
+    response.fail("[nanorpc::core::server::execute] Function not found.");
+}
+
+// Waits for the completion of an asynchronous execution. Synchronous handlers complete
+// the call before the executor returns, so only calls of asynchronous handlers wait.
+template <typename TExecutor>
+type::buffer execute(type::buffer buffer, TExecutor &&executor)
+{
+    struct
+    {
+        std::mutex lock;
+        std::condition_variable done;
+        std::optional<type::buffer> response;
+    } state;
+
+    std::forward<TExecutor>(executor)(std::move(buffer),
+            [&state] (std::exception_ptr, type::buffer response)
+            {
+                std::lock_guard lock{state.lock};
+                state.response = std::move(response);
+                state.done.notify_one();
+            }
+        );
+
+    std::unique_lock lock{state.lock};
+    state.done.wait(lock, [&state] { return !!state.response; });
+    return std::move(*state.response);
+}
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_EXECUTE_H__
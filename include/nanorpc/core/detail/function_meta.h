@@ -12,6 +12,7 @@
 #include <functional>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace nanorpc::core::detail
 {
@@ -26,6 +27,10 @@ struct function_meta<std::function<R (T ... )>>
     using arguments_tuple_type = std::tuple<std::decay_t<T> ... >;
 };
 
+// Meta for any callable. Only the type of std::function is deduced, no object is created.
+template <typename TFunc>
+using callable_meta = function_meta<decltype(std::function{std::declval<std::decay_t<TFunc>>()})>;
+
 }   // namespace nanorpc::core::detail
 
 
@@ -0,0 +1,136 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_HASH_RING_H__
+#define __NANO_RPC_CORE_DETAIL_HASH_RING_H__
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/method_id.h"
+
+namespace nanorpc::core::detail
+{
+
+// The finalizer of splitmix64. FNV-1a of similar strings (e.g. the names of the virtual nodes)
+// differ mostly in the low bits, the finalizer spreads them over the ring.
+constexpr std::uint64_t mix_hash(std::uint64_t value) noexcept
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+// The hash of a routing key. It doesn't depend on the standard library, so all clients
+// route a key to the same server.
+template <typename T>
+std::uint64_t key_hash(T const &key) noexcept
+{
+    if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+    {
+        return mix_hash(static_cast<std::uint64_t>(key));
+    }
+    else
+    {
+        static_assert(std::is_convertible_v<T const &, std::string_view>,
+                "[nanorpc::core::detail::key_hash] The key must be an integer or a string.");
+        return mix_hash(method_id(std::string_view{key}));
+    }
+}
+
+// Consistent hashing with virtual nodes and bounded loads. A key goes to the first node
+// clockwise from its hash whose load (the count of the calls in flight) is below
+// load_factor * average load (and at least min_load), so a hot key spills over to the next
+// nodes instead of overloading its own one. The nodes are placed by their names, so adding or removing
+// a server moves only the keys of its neighbours.
+class hash_ring final
+{
+public:
+    hash_ring(std::vector<std::string> const &names, std::size_t virtual_nodes, double load_factor,
+            std::size_t min_load = 1)
+        : size_{names.size()}
+        , load_factor_{load_factor}
+        , min_load_{std::max<std::size_t>(1, min_load)}
+        , loads_{std::make_unique<std::atomic<std::size_t>[]>(names.size())}
+    {
+        virtual_nodes = std::max<std::size_t>(1, virtual_nodes);
+        points_.reserve(names.size() * virtual_nodes);
+
+        for (std::size_t i = 0 ; i < names.size() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < virtual_nodes ; ++j)
+                points_.emplace_back(key_hash(names[i] + "#" + std::to_string(j)), i);
+        }
+
+        std::sort(std::begin(points_), std::end(points_));
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    // Returns the index of the node for the hash of the key.
+    std::size_t find(std::uint64_t hash) const noexcept
+    {
+        auto const start = static_cast<std::size_t>(std::distance(std::begin(points_),
+                std::lower_bound(std::begin(points_), std::end(points_), std::make_pair(hash, std::size_t{0}))));
+
+        if (load_factor_ <= 0)
+            return points_[start % points_.size()].second;
+
+        auto const capacity = std::max(min_load_, static_cast<std::size_t>(std::ceil(load_factor_ *
+                static_cast<double>(total_.load(std::memory_order_relaxed) + 1) / static_cast<double>(size_))));
+
+        for (std::size_t i = 0 ; i < points_.size() ; ++i)
+        {
+            auto const node = points_[(start + i) % points_.size()].second;
+            if (loads_[node].load(std::memory_order_relaxed) < capacity)
+                return node;
+        }
+
+        return points_[start % points_.size()].second;
+    }
+
+    void acquire(std::size_t node) noexcept
+    {
+        loads_[node].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release(std::size_t node) noexcept
+    {
+        loads_[node].fetch_sub(1, std::memory_order_relaxed);
+        total_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::size_t size_;
+    double load_factor_;
+    std::size_t min_load_;
+    std::vector<std::pair<std::uint64_t, std::size_t>> points_;
+    std::unique_ptr<std::atomic<std::size_t>[]> loads_;
+    std::atomic<std::size_t> total_{0};
+};
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_HASH_RING_H__
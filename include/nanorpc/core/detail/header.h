@@ -0,0 +1,173 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_HEADER_H__
+#define __NANO_RPC_CORE_DETAIL_HEADER_H__
+
+// STD
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/version/core.h"
+
+namespace nanorpc::core::detail
+{
+
+// Fixed-size header of every message. It's written and parsed without the packer,
+// the payload after the header is the only part handed to the packer.
+//
+// Layout (all fields are little-endian):
+//   0  magic           u32
+//   4  version         u16
+//   6  type            u8
+//   7  flags           u8
+//   8  status          u32
+//  12  payload size    u32
+//  16  method id       u64
+//  24  request id      u64
+//  32  budget          u32     the time in milliseconds the caller waits for the response, 0 - no limit
+//  36  epoch           u32     the count of the invalidations of the server's data (responses only), 0 - none
+struct header final
+{
+    static constexpr std::size_t size = 40;
+    static constexpr std::uint32_t magic = 0x4350524e;  // "NRPC"
+
+    // The caller doesn't wait for the response, so the server doesn't build it.
+    static constexpr std::uint8_t flag_one_way = 0x01;
+
+    std::uint16_t version = version::core::protocol::value;
+    pack::meta::type type = pack::meta::type::unknown;
+    std::uint8_t flags = 0;
+    pack::meta::status status = pack::meta::status::good;
+    std::uint32_t payload_size = 0;
+    core::type::id id = 0;
+    std::uint64_t request_id = 0;
+    std::uint32_t budget = 0;
+    std::uint32_t epoch = 0;
+
+    // The buffer with a room for the header. The payload is appended to it.
+    static core::type::buffer make_buffer()
+    {
+        return core::type::buffer(size);
+    }
+
+    // Returns false if the buffer is too small or it is not a nanorpc message.
+    bool read(char const *data, std::size_t length) noexcept
+    {
+        if (length < size || get<std::uint32_t>(data) != magic)
+            return false;
+
+        version = get<std::uint16_t>(data + 4);
+        type = static_cast<pack::meta::type>(get<std::uint8_t>(data + 6));
+        flags = get<std::uint8_t>(data + 7);
+        status = static_cast<pack::meta::status>(get<std::uint32_t>(data + 8));
+        payload_size = get<std::uint32_t>(data + 12);
+        id = get<std::uint64_t>(data + 16);
+        request_id = get<std::uint64_t>(data + 24);
+        budget = get<std::uint32_t>(data + 32);
+        epoch = get<std::uint32_t>(data + 36);
+
+        return true;
+    }
+
+    bool read(core::type::buffer const &buffer) noexcept
+    {
+        return read(buffer.data(), buffer.size());
+    }
+
+    // The buffer must have at least 'size' bytes, the payload size is taken from the buffer.
+    void write(core::type::buffer &buffer) noexcept
+    {
+        payload_size = static_cast<std::uint32_t>(buffer.size() - size);
+        write(buffer.data());
+    }
+
+    void write(char *data) const noexcept
+    {
+        put(data, magic);
+        put(data + 4, version);
+        put(data + 6, static_cast<std::uint8_t>(type));
+        put(data + 7, flags);
+        put(data + 8, static_cast<std::uint32_t>(status));
+        put(data + 12, payload_size);
+        put(data + 16, id);
+        put(data + 24, request_id);
+        put(data + 32, budget);
+        put(data + 36, epoch);
+    }
+
+private:
+    template <typename T>
+    static T get(char const *data) noexcept
+    {
+        T value = 0;
+        for (std::size_t i = 0 ; i < sizeof(T) ; ++i)
+            value |= static_cast<T>(static_cast<std::uint8_t>(data[i])) << (i * 8);
+        return value;
+    }
+
+    template <typename T>
+    static void put(char *data, T value) noexcept
+    {
+        for (std::size_t i = 0 ; i < sizeof(T) ; ++i)
+            data[i] = static_cast<char>(static_cast<std::uint8_t>(value >> (i * 8)));
+    }
+};
+
+// A response shared by many requests gets the id of each of them.
+inline void set_request_id(core::type::buffer &buffer, std::uint64_t request_id) noexcept
+{
+    header message_header;
+    if (!message_header.read(buffer))
+        return;
+
+    message_header.request_id = request_id;
+    message_header.write(buffer.data());
+}
+
+inline void set_epoch(core::type::buffer &buffer, std::uint32_t epoch) noexcept
+{
+    header message_header;
+    if (!message_header.read(buffer))
+        return;
+
+    message_header.epoch = epoch;
+    message_header.write(buffer.data());
+}
+
+// Splits the payload of a batch into the messages. Every message has its own header,
+// so they are just written one after another. Returns false if a message is truncated.
+inline bool split_messages(core::type::buffer const &buffer, std::size_t offset,
+        std::vector<core::type::buffer> &messages)
+{
+    while (offset < buffer.size())
+    {
+        header message_header;
+        if (!message_header.read(buffer.data() + offset, buffer.size() - offset))
+            return false;
+
+        auto const length = header::size + message_header.payload_size;
+        if (length > buffer.size() - offset)
+            return false;
+
+        auto const begin = std::next(std::begin(buffer), offset);
+        messages.emplace_back(begin, std::next(begin, length));
+        offset += length;
+    }
+
+    return true;
+}
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_HEADER_H__
@@ -0,0 +1,118 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_LIMITER_H__
+#define __NANO_RPC_CORE_DETAIL_LIMITER_H__
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+
+namespace nanorpc::core
+{
+
+struct limit_options final
+{
+    // The number of the calls executed at the same time. The others are rejected at once.
+    std::size_t limit = 64;
+    // The adaptive limit is changed between min_limit and max_limit by the latency of the calls.
+    bool adaptive = true;
+    std::size_t min_limit = 1;
+    std::size_t max_limit = 1024;
+};
+
+namespace detail
+{
+
+// The limit of the concurrent calls. The adaptive limit follows the gradient of the latency:
+// it goes down while the latency of the calls is above the long-term one (the calls are queued
+// somewhere) and goes up by the square root of the limit while it's not.
+class limiter final
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    explicit limiter(limit_options options)
+        : options_{std::move(options)}
+        , limit_{static_cast<double>(options_.limit)}
+    {
+        if (!options_.min_limit || options_.min_limit > options_.max_limit ||
+                options_.limit < options_.min_limit || options_.limit > options_.max_limit)
+        {
+            throw std::invalid_argument{"[nanorpc::core::server::limit] Bad limits."};
+        }
+    }
+
+    bool try_acquire() noexcept
+    {
+        std::lock_guard lock{lock_};
+        if (in_flight_ >= static_cast<std::size_t>(limit_))
+            return false;
+        ++in_flight_;
+        return true;
+    }
+
+    // Releases the call which was not executed.
+    void cancel() noexcept
+    {
+        std::lock_guard lock{lock_};
+        --in_flight_;
+    }
+
+    void release(clock_type::duration latency) noexcept
+    {
+        std::lock_guard lock{lock_};
+
+        auto const in_flight = in_flight_--;
+        if (!options_.adaptive)
+            return;
+
+        auto const rtt = std::max(std::chrono::duration<double>{latency}.count(), 1e-9);
+        long_rtt_ = long_rtt_ ? long_rtt_ * (1 - long_smoothing) + rtt * long_smoothing : rtt;
+
+        // The long-term latency drifts back faster after the load was decreased.
+        if (long_rtt_ > rtt * 2)
+            long_rtt_ *= 0.95;
+
+        // The limit is not increased by the calls which didn't use it.
+        if (in_flight < limit_ / 2)
+            return;
+
+        auto const gradient = std::clamp(tolerance * long_rtt_ / rtt, 0.5, 1.0);
+        auto const new_limit = limit_ * gradient + std::sqrt(limit_);
+        limit_ = std::clamp(limit_ * (1 - smoothing) + new_limit * smoothing,
+                static_cast<double>(options_.min_limit), static_cast<double>(options_.max_limit));
+    }
+
+    std::size_t get_limit() const noexcept
+    {
+        std::lock_guard lock{lock_};
+        return static_cast<std::size_t>(limit_);
+    }
+
+private:
+    static constexpr double tolerance = 1.5;
+    static constexpr double smoothing = 0.2;
+    static constexpr double long_smoothing = 0.01;
+
+    limit_options options_;
+
+    mutable std::mutex lock_;
+    double limit_;
+    std::size_t in_flight_ = 0;
+    double long_rtt_ = 0;
+};
+
+}   // namespace detail
+}   // namespace nanorpc::core
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_LIMITER_H__
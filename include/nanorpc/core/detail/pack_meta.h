@@ -19,12 +19,16 @@ enum class type : std::uint32_t
     unknown,
     request,
     response,
+    batch_request,
+    batch_response,
 };
 
 enum class status : std::uint32_t
 {
     fail,
-    good
+    good,
+    overload,
+    timeout
 };
 
 }   // namespace nanorpc::core::detail::pack::meta
@@ -0,0 +1,65 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_REQUEST_KEY_H__
+#define __NANO_RPC_CORE_DETAIL_REQUEST_KEY_H__
+
+// STD
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+// NANORPC
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core::detail
+{
+
+// Identifies the identical requests of a method by the packed arguments.
+// The hash is only for the lookup, the keys are equal if their arguments are equal.
+struct request_key final
+{
+    std::size_t hash = 0;
+    type::buffer arguments;
+
+    bool operator == (request_key const &other) const noexcept
+    {
+        return hash == other.hash && arguments == other.arguments;
+    }
+};
+
+struct request_key_hash final
+{
+    std::size_t operator () (request_key const &key) const noexcept
+    {
+        return key.hash;
+    }
+};
+
+inline std::optional<request_key> make_request_key(header const &request_header, type::buffer const &buffer)
+{
+    if (buffer.size() < header::size || request_header.payload_size > buffer.size() - header::size)
+        return std::nullopt;
+
+    auto const begin = std::next(std::begin(buffer), header::size);
+    auto const end = std::next(begin, request_header.payload_size);
+
+    request_key key;
+    key.arguments.assign(begin, end);
+    key.hash = std::hash<std::string_view>{}({key.arguments.data(), key.arguments.size()}) ^
+            std::hash<type::id>{}(request_header.id);
+
+    return key;
+}
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_REQUEST_KEY_H__
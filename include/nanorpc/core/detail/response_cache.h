@@ -0,0 +1,178 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_RESPONSE_CACHE_H__
+#define __NANO_RPC_CORE_DETAIL_RESPONSE_CACHE_H__
+
+// STD
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/detail/request_key.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct cache_options final
+{
+    // How long a response is valid.
+    std::chrono::milliseconds ttl{1000};
+    // The size of the cached arguments and responses. The least recently used ones are evicted.
+    std::size_t max_bytes = 16 * 1024 * 1024;
+    // The cache is split into independently locked shards by the hash of the request.
+    std::size_t shards = 16;
+};
+
+namespace detail
+{
+
+// The packed responses of a method by its packed arguments. Only the good responses are cached.
+class response_cache final
+{
+public:
+    explicit response_cache(cache_options options)
+        : ttl_{options.ttl}
+    {
+        if (!options.shards)
+            throw std::invalid_argument{"[nanorpc::core::server::cache] The shards count must be greater than 0."};
+
+        shards_ = std::vector<shard>(options.shards);
+        for (auto &i : shards_)
+            i.max_bytes = options.max_bytes / options.shards;
+    }
+
+    std::optional<type::buffer> get(request_key const &key)
+    {
+        auto &item = get_shard(key);
+        std::lock_guard lock{item.lock};
+
+        auto const iter = item.index.find(key);
+        if (iter == std::end(item.index))
+            return std::nullopt;
+
+        if (iter->second.expires <= clock_type::now())
+        {
+            item.erase(iter);
+            return std::nullopt;
+        }
+
+        item.lru.splice(std::begin(item.lru), item.lru, iter->second.position);
+        return iter->second.response;
+    }
+
+    // The count of the clears. A response got before a clear isn't put after it.
+    std::uint64_t generation() const noexcept
+    {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    void clear()
+    {
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+
+        for (auto &item : shards_)
+        {
+            std::lock_guard lock{item.lock};
+            item.index.clear();
+            item.lru.clear();
+            item.bytes = 0;
+        }
+    }
+
+    void put(request_key key, type::buffer const &response)
+    {
+        put(std::move(key), response, std::nullopt);
+    }
+
+    // The response isn't put if the cache has been cleared since the generation.
+    void put(request_key key, type::buffer const &response, std::optional<std::uint64_t> generation)
+    {
+        header response_header;
+        if (!response_header.read(response) || response_header.status != pack::meta::status::good)
+            return;
+
+        auto &item = get_shard(key);
+        auto const bytes = key.arguments.size() + response.size();
+        if (bytes > item.max_bytes)
+            return;
+
+        std::lock_guard lock{item.lock};
+
+        if (generation && *generation != generation_.load(std::memory_order_acquire))
+            return;
+
+        if (auto const iter = item.index.find(key) ; iter != std::end(item.index))
+            item.erase(iter);
+
+        while (item.bytes + bytes > item.max_bytes && !item.lru.empty())
+            item.erase(item.index.find(*item.lru.back()));
+
+        auto const iter = item.index.emplace(std::move(key), entry{response, clock_type::now() + ttl_, {}}).first;
+        item.lru.push_front(&iter->first);
+        iter->second.position = std::begin(item.lru);
+        item.bytes += bytes;
+    }
+
+private:
+    using clock_type = std::chrono::steady_clock;
+    // The keys are stored once in the index, the list refers to them in the order of usage.
+    using lru_type = std::list<request_key const *>;
+
+    struct entry
+    {
+        type::buffer response;
+        clock_type::time_point expires;
+        lru_type::iterator position;
+    };
+
+    using index_type = std::unordered_map<request_key, entry, request_key_hash>;
+
+    struct shard
+    {
+        std::mutex lock;
+        index_type index;
+        lru_type lru;
+        std::size_t bytes = 0;
+        std::size_t max_bytes = 0;
+
+        void erase(index_type::iterator iter)
+        {
+            bytes -= iter->first.arguments.size() + iter->second.response.size();
+            lru.erase(iter->second.position);
+            index.erase(iter);
+        }
+    };
+
+    clock_type::duration ttl_;
+    std::vector<shard> shards_;
+    std::atomic<std::uint64_t> generation_{0};
+
+    shard& get_shard(request_key const &key)
+    {
+        return shards_[key.hash % shards_.size()];
+    }
+};
+
+}   // namespace detail
+}   // namespace nanorpc::core
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_RESPONSE_CACHE_H__
@@ -0,0 +1,88 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_SINGLE_FLIGHT_H__
+#define __NANO_RPC_CORE_DETAIL_SINGLE_FLIGHT_H__
+
+// STD
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/request_key.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core::detail
+{
+
+// The identical requests which arrive while the first one is executed wait for its response.
+class single_flight final
+    : public std::enable_shared_from_this<single_flight>
+{
+public:
+    // Returns true if the request joined an identical one in flight and will be completed with its
+    // response. Otherwise the request leads the flight and its completion is replaced to complete the others.
+    bool join(request_key const &key, std::uint64_t request_id, type::completion &done)
+    {
+        std::lock_guard lock{lock_};
+
+        if (auto const iter = flights_.find(key) ; iter != std::end(flights_))
+        {
+            iter->second.emplace_back(request_id, std::move(done));
+            return true;
+        }
+
+        flights_.emplace(key, waiters_type{});
+
+        done = [self = shared_from_this(), key, func = std::move(done)]
+            (std::exception_ptr exception, type::buffer response)
+            {
+                auto waiters = self->land(key);
+
+                for (auto &i : waiters)
+                {
+                    auto copy = response;
+                    set_request_id(copy, i.first);
+                    i.second(exception, std::move(copy));
+                }
+
+                func(std::move(exception), std::move(response));
+            };
+
+        return false;
+    }
+
+private:
+    using waiters_type = std::vector<std::pair<std::uint64_t, type::completion>>;
+
+    std::mutex lock_;
+    std::unordered_map<request_key, waiters_type, request_key_hash> flights_;
+
+    waiters_type land(request_key const &key)
+    {
+        std::lock_guard lock{lock_};
+
+        auto const iter = flights_.find(key);
+        if (iter == std::end(flights_))
+            return {};
+
+        auto waiters = std::move(iter->second);
+        flights_.erase(iter);
+        return waiters;
+    }
+};
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_SINGLE_FLIGHT_H__
@@ -0,0 +1,338 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_SUBSCRIBER_H__
+#define __NANO_RPC_CORE_DETAIL_SUBSCRIBER_H__
+
+// STD
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/subscription.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/version/core.h"
+
+namespace nanorpc::core::detail
+{
+
+// The client side of the subscriptions. All topics of the client are polled by one request,
+// which the server holds until there are updates, so the subscriptions share one connection
+// and there is no traffic while nothing changes. The handlers are called on the thread of
+// the subscriber one by one.
+template <typename TPacker>
+class subscriber final
+{
+public:
+    // Takes the message of the update with its header.
+    using update_handler = std::function<void (type::buffer)>;
+
+    subscriber(type::async_executor executor, subscribe_options const &options)
+        : state_{std::make_shared<state>()}
+    {
+        state_->executor = std::move(executor);
+        state_->options = options;
+        state_->id = std::random_device{}();
+        state_->id = (state_->id << 32) | std::random_device{}();
+
+        thread_ = std::thread{[s = state_] { run(s); }};
+    }
+
+    ~subscriber() noexcept
+    {
+        {
+            std::lock_guard lock{state_->lock};
+            state_->stopped = true;
+        }
+
+        state_->changed.notify_all();
+
+        if (thread_.get_id() == std::this_thread::get_id())
+            thread_.detach();
+        else
+            thread_.join();
+    }
+
+    // Returns the function which cancels the subscription.
+    std::function<void ()> subscribe(type::id topic, update_handler handler)
+    {
+        std::optional<type::buffer> last;
+        std::uint64_t handle = 0;
+
+        {
+            std::lock_guard lock{state_->lock};
+            handle = ++state_->handles;
+
+            auto &item = state_->topics[topic];
+            if (item.handlers.empty())
+                state_->dirty = true;
+            item.handlers.emplace(handle, handler);
+            last = item.last;
+        }
+
+        state_->changed.notify_all();
+
+        if (last)
+            handler(std::move(*last));
+
+        return [weak = std::weak_ptr{state_}, topic, handle]
+            {
+                auto s = weak.lock();
+                if (!s)
+                    return;
+
+                {
+                    std::lock_guard lock{s->lock};
+                    auto const iter = s->topics.find(topic);
+                    if (iter == std::end(s->topics))
+                        return;
+
+                    iter->second.handlers.erase(handle);
+                    if (!iter->second.handlers.empty())
+                        return;
+
+                    s->topics.erase(iter);
+                    s->dirty = true;
+                }
+
+                s->changed.notify_all();
+            };
+    }
+
+private:
+    struct topic_type final
+    {
+        std::uint64_t cursor = 0;
+        std::optional<type::buffer> last;
+        std::map<std::uint64_t, update_handler> handlers;
+    };
+
+    struct response_type final
+    {
+        std::uint64_t generation;
+        std::exception_ptr exception;
+        type::buffer buffer;
+    };
+
+    struct state final
+    {
+        std::mutex lock;
+        std::condition_variable changed;
+
+        type::async_executor executor;
+        subscribe_options options;
+        std::uint64_t id = 0;
+
+        std::map<type::id, topic_type> topics;
+        std::uint64_t handles = 0;
+        std::deque<response_type> responses;
+        std::uint64_t generation = 0;
+        bool in_flight = false;
+        bool dirty = false;
+        bool stopped = false;
+    };
+
+    std::shared_ptr<state> state_;
+    std::thread thread_;
+
+    subscriber(subscriber const &) = delete;
+    subscriber& operator = (subscriber const &) = delete;
+
+    static void run(std::shared_ptr<state> s) noexcept
+    {
+        std::unique_lock lock{s->lock};
+
+        for (;;)
+        {
+            s->changed.wait(lock, [&s]
+                    {
+                        return s->stopped || !s->responses.empty() ||
+                                ((s->dirty || !s->in_flight) && !s->topics.empty());
+                    }
+                );
+
+            if (s->stopped)
+                return;
+
+            std::vector<std::pair<update_handler, type::buffer>> updates;
+            auto failed = false;
+
+            while (!s->responses.empty())
+            {
+                auto response = std::move(s->responses.front());
+                s->responses.pop_front();
+
+                auto const current = response.generation == s->generation;
+                if (current)
+                    s->in_flight = false;
+
+                if (!read_updates(*s, std::move(response), updates) && current)
+                    failed = true;
+            }
+
+            if (!updates.empty())
+            {
+                lock.unlock();
+
+                for (auto &[handler, message] : updates)
+                {
+                    try
+                    {
+                        handler(std::move(message));
+                    }
+                    catch (...)
+                    {
+                    }
+                }
+
+                lock.lock();
+            }
+
+            if (failed && s->changed.wait_for(lock, s->options.retry, [&s] { return s->stopped; }))
+                return;
+
+            if ((s->dirty || !s->in_flight) && !s->topics.empty())
+            {
+                auto request = make_poll(*s);
+
+                s->dirty = false;
+                s->in_flight = true;
+                auto const generation = ++s->generation;
+
+                auto executor = s->executor;
+
+                lock.unlock();
+
+                try
+                {
+                    executor(std::move(request), [weak = std::weak_ptr{s}, generation]
+                            (std::exception_ptr exception, type::buffer response)
+                            {
+                                auto s = weak.lock();
+                                if (!s)
+                                    return;
+
+                                {
+                                    std::lock_guard lock{s->lock};
+                                    s->responses.push_back({generation, std::move(exception), std::move(response)});
+                                }
+
+                                s->changed.notify_all();
+                            }
+                        );
+                }
+                catch (...)
+                {
+                    std::lock_guard guard{s->lock};
+                    s->responses.push_back({generation, std::current_exception(), {}});
+                }
+
+                lock.lock();
+            }
+        }
+    }
+
+    static type::buffer make_poll(state const &s)
+    {
+        std::vector<type::id> topics;
+        std::vector<std::uint64_t> cursors;
+        topics.reserve(s.topics.size());
+        cursors.reserve(s.topics.size());
+
+        for (auto const &[topic, item] : s.topics)
+        {
+            topics.push_back(topic);
+            cursors.push_back(item.cursor);
+        }
+
+        auto request = TPacker{}
+                .append_to(header::make_buffer())
+                .pack(std::make_tuple(std::move(topics), std::move(cursors)))
+                .to_buffer();
+
+        header request_header;
+        request_header.type = pack::meta::type::request;
+        request_header.id = subscribe_id;
+        request_header.request_id = s.id;
+        request_header.budget = static_cast<std::uint32_t>(s.options.hold.count());
+        request_header.write(request);
+
+        return request;
+    }
+
+    // Returns false if the poll has failed. The timeout of the poll is not an error, it's sent again.
+    static bool read_updates(state &s, response_type response,
+            std::vector<std::pair<update_handler, type::buffer>> &updates)
+    {
+        if (response.exception)
+        {
+            try
+            {
+                std::rethrow_exception(response.exception);
+            }
+            catch (exception::timeout const &)
+            {
+                return true;
+            }
+            catch (...)
+            {
+                return false;
+            }
+        }
+
+        header response_header;
+        if (!response_header.read(response.buffer) || response_header.version != version::core::protocol::value ||
+                response_header.type != pack::meta::type::batch_response ||
+                response_header.status != pack::meta::status::good)
+        {
+            return false;
+        }
+
+        std::vector<type::buffer> messages;
+        if (!split_messages(response.buffer, header::size, messages))
+            return false;
+
+        for (auto &message : messages)
+        {
+            header message_header;
+            message_header.read(message);
+
+            auto const iter = s.topics.find(message_header.id);
+            if (iter == std::end(s.topics) || message_header.request_id <= iter->second.cursor)
+                continue;
+
+            auto &item = iter->second;
+            item.cursor = message_header.request_id;
+            item.last = message;
+
+            for (auto const &handler : item.handlers)
+                updates.emplace_back(handler.second, message);
+        }
+
+        return true;
+    }
+};
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_SUBSCRIBER_H__
@@ -0,0 +1,339 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DETAIL_TOPIC_HUB_H__
+#define __NANO_RPC_CORE_DETAIL_TOPIC_HUB_H__
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/detail/execute.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/stop_token.h"
+#include "nanorpc/core/subscription.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core::detail
+{
+
+// The updates of the topics and the polls of the subscribers waiting for them.
+//
+// A subscriber sends one poll for all its topics with the sequence number of the last
+// update of every topic it has got, 0 - none. The poll is completed at once if there are
+// newer updates, otherwise it's held until an update of one of its topics is published.
+// The response is a batch of the updates; every update is a message with the id of its topic
+// and its sequence number as the request id. A new topic gets only its last update.
+// The new poll of a subscriber completes its previous one with no updates.
+// A held poll is completed with no updates when the budget of its request has passed
+// (at most max_hold), so the poll of a gone subscriber doesn't keep its connection.
+// The topics a poll waits for without updates are removed with it.
+template <typename TPacker>
+class topic_hub final
+{
+public:
+    static constexpr std::chrono::milliseconds max_hold{300000};
+    static constexpr std::size_t max_poll_topics = 1024;
+
+    ~topic_hub() noexcept
+    {
+        {
+            std::lock_guard lock{lock_};
+            stopped_ = true;
+        }
+        expired_.notify_all();
+
+        if (expirer_.joinable())
+            expirer_.join();
+
+        polls_type polls;
+
+        {
+            std::lock_guard lock{lock_};
+            polls = std::move(polls_);
+        }
+
+        for (auto &i : polls)
+            complete(std::move(i.second), {});
+    }
+
+    // The count of the invalidations of the data of the server, it's attached to the responses.
+    std::uint32_t epoch() const noexcept
+    {
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+    // Returns the new epoch.
+    std::uint32_t advance() noexcept
+    {
+        return epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+    void configure(type::id id, topic_options const &options)
+    {
+        std::lock_guard lock{lock_};
+        auto &topic = topics_[id];
+        topic.options = options;
+        topic.configured = true;
+    }
+
+    template <typename T>
+    void publish(type::id id, T const &value)
+    {
+        auto message = TPacker{}.append_to(header::make_buffer()).pack(value).to_buffer();
+
+        std::vector<std::pair<poll_type, updates_type>> ready;
+
+        {
+            std::lock_guard lock{lock_};
+
+            auto &topic = topics_[id];
+
+            header message_header;
+            message_header.type = pack::meta::type::response;
+            message_header.id = id;
+            message_header.request_id = ++topic.last;
+            message_header.write(message);
+
+            topic.history.push_back(std::make_shared<type::buffer const>(std::move(message)));
+            while (topic.history.size() > std::max<std::size_t>(1, topic.options.history))
+                topic.history.pop_front();
+
+            auto const waiters = std::move(topic.waiters);
+            topic.waiters.clear();
+
+            for (auto subscriber : waiters)
+            {
+                auto poll = take_poll(subscriber);
+                auto updates = get_updates(poll);
+                ready.emplace_back(std::move(poll), std::move(updates));
+            }
+        }
+
+        for (auto &[poll, updates] : ready)
+            complete(std::move(poll), updates);
+    }
+
+    // Takes the poll request; its request id is the id of the subscriber.
+    void poll(header const &request_header, type::buffer buffer, type::completion done)
+    {
+        header response_header;
+        response_header.type = pack::meta::type::batch_response;
+        response_header.id = request_header.id;
+        response_header.request_id = request_header.request_id;
+
+        auto const budget = std::min<std::chrono::milliseconds>(
+                request_header.budget ? std::chrono::milliseconds{request_header.budget} : max_hold, max_hold);
+        poll_type request{std::move(response_header), std::move(done), {}, {},
+                stop_token::clock_type::now() + budget};
+
+        try
+        {
+            std::tuple<std::vector<type::id>, std::vector<std::uint64_t>> data;
+            TPacker{}.from_buffer(std::move(buffer), header::size).unpack(data);
+            request.topics = std::move(std::get<0>(data));
+            request.cursors = std::move(std::get<1>(data));
+            if (request.topics.size() != request.cursors.size() || request.topics.size() > max_poll_topics)
+                throw exception::server{"[nanorpc::core::server::subscribe] Bad poll."};
+        }
+        catch (std::exception const &e)
+        {
+            reply<TPacker>{std::move(request.response_header), std::move(request.done)}.fail(e.what());
+            return;
+        }
+
+        std::optional<poll_type> previous;
+        std::optional<updates_type> updates;
+
+        {
+            std::lock_guard lock{lock_};
+
+            auto const subscriber = request_header.request_id;
+            if (polls_.find(subscriber) != std::end(polls_))
+                previous = take_poll(subscriber);
+
+            auto found = get_updates(request);
+            if (!found.empty() || request.topics.empty())
+            {
+                updates = std::move(found);
+            }
+            else
+            {
+                for (auto id : request.topics)
+                    topics_[id].waiters.insert(subscriber);
+                expiries_.emplace(request.deadline, subscriber);
+                polls_.emplace(subscriber, std::move(request));
+
+                if (!expirer_.joinable())
+                    expirer_ = std::thread{[this] { expire(); }};
+                expired_.notify_one();
+            }
+        }
+
+        if (previous)
+            complete(std::move(*previous), {});
+
+        if (updates)
+            complete(std::move(request), *updates);
+    }
+
+private:
+    using message_ptr = std::shared_ptr<type::buffer const>;
+    using updates_type = std::vector<message_ptr>;
+
+    struct topic_type final
+    {
+        topic_options options;
+        bool configured = false;
+        std::uint64_t last = 0;
+        std::deque<message_ptr> history;
+        std::set<std::uint64_t> waiters;
+    };
+
+    struct poll_type final
+    {
+        header response_header;
+        type::completion done;
+        std::vector<type::id> topics;
+        std::vector<std::uint64_t> cursors;
+        stop_token::clock_type::time_point deadline;
+    };
+
+    using topics_type = std::map<type::id, topic_type>;
+    using polls_type = std::map<std::uint64_t, poll_type>;
+    using expiries_type = std::set<std::pair<stop_token::clock_type::time_point, std::uint64_t>>;
+
+    std::atomic<std::uint32_t> epoch_{0};
+
+    std::mutex lock_;
+    topics_type topics_;
+    polls_type polls_;
+    expiries_type expiries_;
+
+    std::condition_variable expired_;
+    bool stopped_ = false;
+    std::thread expirer_;
+
+    poll_type take_poll(std::uint64_t subscriber)
+    {
+        auto const iter = polls_.find(subscriber);
+        auto poll = std::move(iter->second);
+        polls_.erase(iter);
+        expiries_.erase(std::make_pair(poll.deadline, subscriber));
+
+        for (auto id : poll.topics)
+        {
+            auto const topic = topics_.find(id);
+            if (topic == std::end(topics_))
+                continue;
+
+            topic->second.waiters.erase(subscriber);
+            if (topic->second.waiters.empty() && topic->second.history.empty() && !topic->second.configured)
+                topics_.erase(topic);
+        }
+
+        return poll;
+    }
+
+    void expire() noexcept
+    {
+        for (;;)
+        {
+            std::vector<poll_type> polls;
+
+            {
+                std::unique_lock lock{lock_};
+                expired_.wait(lock, [this] { return stopped_ || !expiries_.empty(); });
+                if (stopped_)
+                    return;
+
+                auto const deadline = std::begin(expiries_)->first;
+                expired_.wait_until(lock, deadline, [this, deadline]
+                        {
+                            return stopped_ || expiries_.empty() || std::begin(expiries_)->first != deadline ||
+                                    stop_token::clock_type::now() >= deadline;
+                        }
+                    );
+                if (stopped_)
+                    return;
+
+                auto const now = stop_token::clock_type::now();
+                while (!expiries_.empty() && std::begin(expiries_)->first <= now)
+                    polls.push_back(take_poll(std::begin(expiries_)->second));
+            }
+
+            for (auto &i : polls)
+                complete(std::move(i), {});
+        }
+    }
+
+    updates_type get_updates(poll_type const &poll) const
+    {
+        updates_type updates;
+
+        for (std::size_t i = 0 ; i < poll.topics.size() ; ++i)
+        {
+            auto const topic = topics_.find(poll.topics[i]);
+            if (topic == std::end(topics_) || topic->second.history.empty())
+                continue;
+
+            auto const &history = topic->second.history;
+            auto const cursor = poll.cursors[i];
+            if (cursor >= topic->second.last)
+                continue;
+
+            if (!cursor)
+            {
+                updates.push_back(history.back());
+                continue;
+            }
+
+            auto const first = topic->second.last - history.size() + 1;
+            auto const from = cursor + 1 > first ? cursor + 1 - first : 0;
+            updates.insert(std::end(updates), std::next(std::begin(history), from), std::end(history));
+        }
+
+        return updates;
+    }
+
+    static void complete(poll_type poll, updates_type const &updates) noexcept
+    {
+        try
+        {
+            auto response = header::make_buffer();
+            for (auto const &i : updates)
+                response.insert(std::end(response), std::begin(*i), std::end(*i));
+
+            reply<TPacker>{std::move(poll.response_header), std::move(poll.done)}.send_raw(std::move(response));
+        }
+        catch (...)
+        {
+        }
+    }
+};
+
+}   // namespace nanorpc::core::detail
+
+
+#endif  // !__NANO_RPC_CORE_DETAIL_TOPIC_HUB_H__
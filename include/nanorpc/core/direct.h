@@ -0,0 +1,51 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_DIRECT_H__
+#define __NANO_RPC_CORE_DIRECT_H__
+
+// STD
+#include <any>
+#include <memory>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/client.h"
+#include "nanorpc/core/server.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+// The client of a server in the same process. The arguments and the results are passed
+// by move without the packer. A result taken as another type than the handler's one
+// is converted by the packer.
+// The call which can't be passed so is packed and executed as usual, it's not an error:
+// no such a handler, an asynchronous one or the arguments of other types than the handler's
+// ones (e.g. int for long). Such a call costs the packing as a remote one does.
+// The direct call runs the handler at once on the calling thread. It bypasses the limits,
+// the response cache and the coalescing of the server, the cache of the client and the
+// deadline: call_for doesn't stop waiting for it. The packed calls have all of them.
+template <typename TPacker>
+client<TPacker> make_direct_client(std::shared_ptr<server<TPacker>> srv)
+{
+    auto direct_executor = [srv] (type::id id, std::any &arguments, std::any &result, type::result_packer &packer)
+            {
+                return srv->execute(id, arguments, result, packer);
+            };
+
+    auto executor = [srv] (type::buffer request)
+            {
+                return srv->execute(std::move(request));
+            };
+
+    return {std::move(direct_executor), std::move(executor)};
+}
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_DIRECT_H__
@@ -0,0 +1,315 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_ERROR_REPORTER_H__
+#define __NANO_RPC_CORE_ERROR_REPORTER_H__
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/detail/bounded_queue.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/expected.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct error_event final
+{
+    errc code = errc::transport;
+    // The function which has failed, e.g. nanorpc::http::detail::server::session::read.
+    std::string_view component;
+    // The remote peer, if it's known.
+    std::string endpoint;
+    // The error as the error handlers get it.
+    std::exception_ptr exception;
+    // Not 0 for the summary of the errors of the component dropped by the rate limit.
+    std::uint64_t suppressed = 0;
+};
+
+struct error_report_options final
+{
+    // The events waiting for the handler; the events above it are dropped and counted.
+    std::size_t queue_size = 4096;
+    // Every component reports at most burst events per interval, the rest of them
+    // are counted and reported as one summary at the end of the interval.
+    std::chrono::milliseconds interval{1000};
+    std::size_t burst = 10;
+};
+
+// Takes the errors off the threads which have them. The events are put into a lock-free queue
+// and the handler is called on the thread of the reporter, so a slow handler (e.g. writing
+// to std::cerr) doesn't hold the io threads. A burst of the same errors is summarized:
+// the rate limit is checked before the event is built, so the dropped errors cost a few
+// atomic operations.
+class error_reporter final
+{
+public:
+    using event_handler = std::function<void (error_event const &)>;
+
+    struct statistics final
+    {
+        std::uint64_t reported = 0;
+        std::uint64_t suppressed = 0;
+        std::uint64_t dropped = 0;
+    };
+
+    error_reporter(event_handler handler, error_report_options const &options = {})
+        : options_{options}
+        , queue_{std::max<std::size_t>(1, options.queue_size)}
+        , handler_{std::move(handler)}
+    {
+        options_.interval = std::max(options_.interval, std::chrono::milliseconds{1});
+        options_.burst = std::min<std::size_t>(options_.burst, count_mask);
+        if (handler_)
+            thread_ = std::thread{[this] { run(); }};
+    }
+
+    // The handler of the transports gets the exceptions of the events.
+    error_reporter(type::error_handler handler, error_report_options const &options = {})
+        : error_reporter{handler ? event_handler{[func = std::move(handler)] (error_event const &event)
+                    { func(event.exception); }} : event_handler{}, options}
+    {
+    }
+
+    // The events in the queue are passed to the handler before the destruction.
+    ~error_reporter() noexcept
+    {
+        if (!thread_.joinable())
+            return;
+
+        {
+            std::lock_guard lock{lock_};
+            stopped_ = true;
+        }
+
+        wakeup_.notify_one();
+        thread_.join();
+    }
+
+    // Returns false if the event of the component must not be reported now. The component
+    // is identified by the address of its name, so it must be a string literal.
+    bool admit(char const *component) noexcept
+    {
+        if (!handler_)
+            return false;
+
+        auto &item = find_slot(component);
+        auto const window = static_cast<std::uint64_t>(clock_type::now().time_since_epoch() / options_.interval) &
+                window_mask;
+
+        // The window and the count are changed at once, so a new window can't lose its first events.
+        auto state = item.state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto const count = (state >> count_bits) == window ? state & count_mask : 0;
+            if (count >= options_.burst)
+                break;
+
+            if (item.state.compare_exchange_weak(state, (window << count_bits) | (count + 1), std::memory_order_relaxed))
+                return true;
+        }
+
+        item.suppressed.fetch_add(1, std::memory_order_release);
+        return false;
+    }
+
+    void report(error_event event) noexcept
+    {
+        if (!queue_.try_push(event))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // The reporter takes the lock to sleep only when the queue is empty, so the producers
+        // take it only to wake it up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.exchange(false))
+        {
+            std::lock_guard lock{lock_};
+            wakeup_.notify_one();
+        }
+    }
+
+    // "[name] Message." -> "name"
+    static std::string_view component_name(char const *component) noexcept
+    {
+        std::string_view name{component ? component : ""};
+        if (name.empty() || name.front() != '[')
+            return name;
+
+        name.remove_prefix(1);
+        return name.substr(0, name.find(']'));
+    }
+
+    statistics get_statistics() const noexcept
+    {
+        return {reported_.load(std::memory_order_relaxed), suppressed_.load(std::memory_order_relaxed),
+                dropped_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    using clock_type = std::chrono::steady_clock;
+
+    // The components have the slots of their own; the ones which have found no free slot
+    // share the last one and are summarized together.
+    static constexpr std::size_t slots_count = 128;
+
+    // The state of a slot is the window of the rate limit and the count of the events in it.
+    static constexpr unsigned count_bits = 24;
+    static constexpr std::uint64_t count_mask = (std::uint64_t{1} << count_bits) - 1;
+    static constexpr std::uint64_t window_mask = (std::uint64_t{1} << (64 - count_bits)) - 1;
+
+    struct slot final
+    {
+        std::atomic<char const *> component{nullptr};
+        std::atomic<std::uint64_t> state{0};
+        std::atomic<std::uint64_t> suppressed{0};
+    };
+
+    error_report_options options_;
+    detail::bounded_queue<error_event> queue_;
+    slot slots_[slots_count];
+    slot others_;
+
+    std::atomic<std::uint64_t> reported_{0};
+    std::atomic<std::uint64_t> suppressed_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+
+    std::mutex lock_;
+    std::condition_variable wakeup_;
+    std::atomic<bool> sleeping_{false};
+    bool stopped_ = false;
+
+    event_handler handler_;
+    std::thread thread_;
+
+    error_reporter(error_reporter const &) = delete;
+    error_reporter& operator = (error_reporter const &) = delete;
+
+    // The slots are looked up by the open addressing; a slot is taken by a component for good.
+    slot& find_slot(char const *component) noexcept
+    {
+        auto const start = std::hash<void const *>{}(component);
+        for (std::size_t i = 0 ; i < slots_count ; ++i)
+        {
+            auto &item = slots_[(start + i) % slots_count];
+            auto owner = item.component.load(std::memory_order_acquire);
+            if (!owner && item.component.compare_exchange_strong(owner, component, std::memory_order_acq_rel))
+                return item;
+            if (owner == component)
+                return item;
+        }
+
+        return others_;
+    }
+
+    void run() noexcept
+    {
+        auto summary_time = clock_type::now() + options_.interval;
+
+        for (;;)
+        {
+            while (auto event = queue_.try_pop())
+                call(*event);
+
+            if (clock_type::now() >= summary_time)
+            {
+                summarize();
+                summary_time = clock_type::now() + options_.interval;
+            }
+
+            std::unique_lock lock{lock_};
+
+            if (stopped_)
+            {
+                lock.unlock();
+                while (auto event = queue_.try_pop())
+                    call(*event);
+                summarize();
+                return;
+            }
+
+            sleeping_.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (auto event = queue_.try_pop())
+            {
+                sleeping_.store(false);
+                lock.unlock();
+                call(*event);
+                continue;
+            }
+
+            wakeup_.wait_until(lock, summary_time, [this] { return stopped_ || !sleeping_.load(); });
+            sleeping_.store(false);
+        }
+    }
+
+    void summarize() noexcept
+    {
+        for (auto &item : slots_)
+            summarize(item, component_name(item.component.load(std::memory_order_acquire)), "similar errors");
+
+        summarize(others_, "nanorpc::core::error_reporter", "errors of other components");
+    }
+
+    void summarize(slot &item, std::string_view component, char const *what) noexcept
+    {
+        auto const count = item.suppressed.exchange(0, std::memory_order_acquire);
+        if (!count)
+            return;
+
+        suppressed_.fetch_add(count, std::memory_order_relaxed);
+
+        try
+        {
+            error_event event;
+            event.component = component;
+            event.suppressed = count;
+            event.exception = std::make_exception_ptr(exception::nanorpc{"[" + std::string{component} +
+                    "] " + std::to_string(count) + " " + what + " have been suppressed."});
+            call(event);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void call(error_event const &event) noexcept
+    {
+        if (!event.suppressed)
+            reported_.fetch_add(1, std::memory_order_relaxed);
+
+        try
+        {
+            handler_(event);
+        }
+        catch (...)
+        {
+        }
+    }
+
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_ERROR_REPORTER_H__
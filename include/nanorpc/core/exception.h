@@ -34,9 +34,11 @@ namespace nanorpc::core::exception
 NANORPC_EXCEPTION_DECL(nanorpc, std::runtime_error)
 NANORPC_EXCEPTION_DECL(packer, nanorpc)
 NANORPC_EXCEPTION_DECL(logic, nanorpc)
+NANORPC_EXCEPTION_DECL(overload, nanorpc)
 NANORPC_EXCEPTION_DECL(transport, nanorpc)
 NANORPC_EXCEPTION_DECL(client, transport)
 NANORPC_EXCEPTION_DECL(server, transport)
+NANORPC_EXCEPTION_DECL(timeout, transport)
 
 inline std::string to_string(std::exception const &e)
 {
@@ -67,7 +69,7 @@ inline void default_error_handler(std::exception_ptr e)
     }
     catch (std::exception const &ex)
     {
-        std::cerr << "NanoRPC exception message: " << to_string(ex) << std::endl;
+        std::cerr << "NanoRPC exception message: " << to_string(ex) << '\n';
     }
 }
 
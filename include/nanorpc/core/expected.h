@@ -0,0 +1,174 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_EXPECTED_H__
+#define __NANO_RPC_CORE_EXPECTED_H__
+
+// STD
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+
+namespace nanorpc::core
+{
+
+enum class errc : std::uint32_t
+{
+    logic = 1,      // the handler has failed or the function is not found
+    overload,       // the call is rejected by the limits of the server
+    timeout,        // the deadline of the call has passed
+    protocol,       // the response is malformed
+    transport       // the request has not been delivered or the response has not been received
+};
+
+struct error final
+{
+    errc code;
+    std::string message;
+
+    // The exception which the throwing API uses for this kind of errors.
+    std::exception_ptr to_exception() const
+    {
+        switch (code)
+        {
+        case errc::overload :
+            return std::make_exception_ptr(exception::overload{message});
+        case errc::timeout :
+            return std::make_exception_ptr(exception::timeout{message});
+        case errc::protocol :
+        case errc::transport :
+            return std::make_exception_ptr(exception::client{message});
+        default :
+            break;
+        }
+        return std::make_exception_ptr(exception::logic{message});
+    }
+
+    // The error of the exception thrown by the throwing API.
+    static error from_exception(std::exception_ptr exception)
+    {
+        try
+        {
+            std::rethrow_exception(std::move(exception));
+        }
+        catch (exception::logic const &e)
+        {
+            return {errc::logic, e.what()};
+        }
+        catch (exception::overload const &e)
+        {
+            return {errc::overload, e.what()};
+        }
+        catch (exception::timeout const &e)
+        {
+            return {errc::timeout, e.what()};
+        }
+        catch (std::exception const &e)
+        {
+            return {errc::transport, e.what()};
+        }
+        catch (...)
+        {
+            return {errc::transport, "Unknown error."};
+        }
+    }
+
+    [[noreturn]]
+    void raise() const
+    {
+        std::rethrow_exception(to_exception());
+    }
+};
+
+// The value or the error of a call. Nothing is thrown until value() is called on an error.
+template <typename T>
+class expected final
+{
+public:
+    using value_type = T;
+    using error_type = core::error;
+
+    expected(value_type value)
+        : data_{std::in_place_index<0>, std::move(value)}
+    {
+    }
+
+    expected(error_type err)
+        : data_{std::in_place_index<1>, std::move(err)}
+    {
+    }
+
+    bool has_value() const noexcept
+    {
+        return data_.index() == 0;
+    }
+
+    explicit operator bool () const noexcept
+    {
+        return has_value();
+    }
+
+    value_type& value() &
+    {
+        if (!has_value())
+            std::get<1>(data_).raise();
+        return std::get<0>(data_);
+    }
+
+    value_type const& value() const &
+    {
+        if (!has_value())
+            std::get<1>(data_).raise();
+        return std::get<0>(data_);
+    }
+
+    value_type&& value() &&
+    {
+        if (!has_value())
+            std::get<1>(data_).raise();
+        return std::move(std::get<0>(data_));
+    }
+
+    value_type& operator * () & noexcept
+    {
+        return *std::get_if<0>(&data_);
+    }
+
+    value_type const& operator * () const & noexcept
+    {
+        return *std::get_if<0>(&data_);
+    }
+
+    value_type* operator -> () noexcept
+    {
+        return std::get_if<0>(&data_);
+    }
+
+    value_type const* operator -> () const noexcept
+    {
+        return std::get_if<0>(&data_);
+    }
+
+    // Must be called only if there is no value.
+    error_type const& error() const noexcept
+    {
+        return *std::get_if<1>(&data_);
+    }
+
+private:
+    std::variant<value_type, error_type> data_;
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_EXPECTED_H__
@@ -0,0 +1,217 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_FAN_OUT_H__
+#define __NANO_RPC_CORE_FAN_OUT_H__
+
+// STD
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/client.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/expected.h"
+#include "nanorpc/core/method_id.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct fan_out_options final
+{
+    // The call is completed by this count of the successful responses and the later ones are
+    // dropped, 0 - the call waits for the responses of all servers.
+    std::size_t quorum = 0;
+};
+
+// Calls the same method on many servers. The request is packed once and sent to all servers
+// at once, so the call takes about the time of the slowest server instead of the sum of them.
+template <typename TPacker>
+class fan_out final
+{
+public:
+    using result_type = typename client<TPacker>::result_type;
+    // The index of the server and its result.
+    using result_handler = std::function<void (std::size_t, expected<result_type>)>;
+
+    explicit fan_out(std::vector<type::async_executor> executors)
+        : executors_{std::move(executors)}
+    {
+    }
+
+    std::size_t size() const noexcept
+    {
+        return executors_.size();
+    }
+
+    // The handler is called for every response as it arrives, one call at a time. The future holds
+    // the count of the successful responses. If the quorum can't be reached, the future holds
+    // exception::client; after the call is completed the rest responses are dropped. The error
+    // of the handler completes the call too.
+    template <typename ... TArgs>
+    std::future<std::size_t> call(fan_out_options const &options, result_handler handler,
+            std::string_view name, TArgs && ... args)
+    {
+        return call(options, std::move(handler), method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    std::future<std::size_t> call(fan_out_options const &options, result_handler handler,
+            type::id id, TArgs && ... args)
+    {
+        return execute(client<TPacker>::make_request(id, std::forward<TArgs>(args) ... ), options, std::move(handler));
+    }
+
+    // Waits for the responses of all servers. The results are in the order of the servers.
+    template <typename ... TArgs>
+    std::vector<expected<result_type>> gather(std::string_view name, TArgs && ... args)
+    {
+        return gather(method_id(name), std::forward<TArgs>(args) ... );
+    }
+
+    template <typename ... TArgs>
+    std::vector<expected<result_type>> gather(type::id id, TArgs && ... args)
+    {
+        auto results = std::make_shared<std::vector<std::optional<expected<result_type>>>>(size());
+
+        call({}, [results] (std::size_t index, expected<result_type> value)
+                {
+                    (*results)[index].emplace(std::move(value));
+                },
+                id, std::forward<TArgs>(args) ...
+            ).get();
+
+        std::vector<expected<result_type>> values;
+        values.reserve(results->size());
+        for (auto &i : *results)
+            values.emplace_back(std::move(*i));
+
+        return values;
+    }
+
+private:
+    std::vector<type::async_executor> executors_;
+
+    struct state final
+    {
+        std::mutex lock;
+        result_handler handler;
+        std::size_t quorum;
+        std::size_t pending;
+        std::size_t succeeded = 0;
+        bool completed = false;
+        std::vector<bool> answered;
+        std::promise<std::size_t> promise;
+
+        // A server is answered once, the executor which throws after its completion is not counted again.
+        void complete(std::size_t index, expected<result_type> value)
+        {
+            std::lock_guard lock_guard{lock};
+
+            if (completed || answered[index])
+                return;
+
+            answered[index] = true;
+
+            --pending;
+            if (value)
+                ++succeeded;
+
+            try
+            {
+                handler(index, std::move(value));
+            }
+            catch (...)
+            {
+                completed = true;
+                promise.set_exception(std::current_exception());
+                return;
+            }
+
+            if (quorum && succeeded == quorum)
+            {
+                completed = true;
+                promise.set_value(succeeded);
+            }
+            else if (quorum && succeeded + pending < quorum)
+            {
+                completed = true;
+                promise.set_exception(std::make_exception_ptr(exception::client{
+                        "[nanorpc::core::fan_out::call] The quorum can't be reached."}));
+            }
+            else if (!pending)
+            {
+                completed = true;
+                promise.set_value(succeeded);
+            }
+        }
+    };
+
+    std::future<std::size_t> execute(type::buffer request, fan_out_options const &options, result_handler handler)
+    {
+        auto call_state = std::make_shared<state>();
+        call_state->handler = std::move(handler);
+        call_state->quorum = options.quorum;
+        call_state->pending = executors_.size();
+        call_state->answered.resize(executors_.size());
+
+        auto future = call_state->promise.get_future();
+
+        if (options.quorum > executors_.size())
+        {
+            call_state->promise.set_exception(std::make_exception_ptr(exception::client{
+                    "[nanorpc::core::fan_out::call] The quorum is greater than the count of the servers."}));
+            return future;
+        }
+
+        if (executors_.empty())
+        {
+            call_state->promise.set_value(0);
+            return future;
+        }
+
+        for (std::size_t i = 0 ; i < executors_.size() ; ++i)
+        {
+            auto done = [call_state, i] (std::exception_ptr exception, type::buffer response)
+                {
+                    if (exception)
+                        call_state->complete(i, error::from_exception(std::move(exception)));
+                    else
+                        call_state->complete(i, client<TPacker>::try_make_result(std::move(response)));
+                };
+
+            // The last server takes the request, the others take its copies.
+            // The executor which throws fails its server only.
+            try
+            {
+                if (i + 1 == executors_.size())
+                    executors_[i](std::move(request), std::move(done));
+                else
+                    executors_[i](request, std::move(done));
+            }
+            catch (...)
+            {
+                call_state->complete(i, error::from_exception(std::current_exception()));
+            }
+        }
+
+        return future;
+    }
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_FAN_OUT_H__
@@ -0,0 +1,313 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_HANDLER_POOL_H__
+#define __NANO_RPC_CORE_HANDLER_POOL_H__
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct handler_options final
+{
+    // The workers of the shared pool of the handlers, 0 - the handlers are run on the I/O threads.
+    std::size_t workers = 0;
+    // The ids of the methods (nanorpc::method_id) run on the I/O threads. Their handlers must be
+    // quick and must not block, they save the passing of the call to another thread.
+    std::set<type::id> cheap;
+    // The methods with the pools of their own by the count of the workers, e.g. the slow ones,
+    // which would take the shared workers from the others.
+    std::map<type::id, std::size_t> dedicated;
+};
+
+// The options of the servers made without them: the handlers are run on a shared pool
+// of as many workers as the I/O has, so a slow handler doesn't hold the reads of the others.
+inline handler_options make_handler_options(std::size_t workers)
+{
+    handler_options options;
+    options.workers = std::max<std::size_t>(workers, 1);
+    return options;
+}
+
+// Every worker has its own queue. A worker takes the newest task of its own queue and the oldest
+// ones of the others when its queue is empty. The tasks posted by the workers go to their own
+// queues, the others are spread over the queues in turn. The posts and the workers take only
+// the lock of a queue; the lock of the pool is taken by the workers going to sleep and by
+// the posts waking them up. The tasks queued before the destruction are completed, the destructor
+// waits for them.
+class work_stealing_pool final
+{
+public:
+    explicit work_stealing_pool(std::size_t workers,
+            type::error_handler error_handler = exception::default_error_handler)
+        : state_{std::make_shared<state>()}
+    {
+        if (!workers)
+            throw std::invalid_argument{"[nanorpc::core::work_stealing_pool] The workers count must be greater than 0."};
+
+        state_->error_handler = std::move(error_handler);
+        state_->queues.reserve(workers);
+        for (std::size_t i = 0 ; i < workers ; ++i)
+            state_->queues.emplace_back(std::make_unique<queue>());
+
+        threads_.reserve(workers);
+        for (std::size_t i = 0 ; i < workers ; ++i)
+            threads_.emplace_back([self = state_, i] { work(*self, i); });
+    }
+
+    ~work_stealing_pool() noexcept
+    {
+        {
+            std::lock_guard lock{state_->lock};
+            state_->stopped.store(true);
+        }
+        state_->ready.notify_all();
+
+        // The pool can be destroyed by its own task. The thread of the task keeps
+        // the shared state and finishes the queues with the others.
+        auto detached = false;
+        for (auto &thread : threads_)
+        {
+            if (thread.get_id() == std::this_thread::get_id())
+            {
+                thread.detach();
+                detached = true;
+            }
+            else if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+        // The tasks posted while the workers were leaving are run here.
+        if (!detached)
+        {
+            type::task task;
+            while (take(*state_, 0, task))
+                run(*state_, task);
+        }
+    }
+
+    void post(type::task task)
+    {
+        auto &pool = *state_;
+
+        if (pool.stopped.load(std::memory_order_acquire))
+            throw exception::server{"[nanorpc::core::work_stealing_pool::post] The pool was stopped."};
+
+        auto const &current = get_current();
+        auto const index = current.owner == &pool ? current.index :
+                pool.next.fetch_add(1, std::memory_order_relaxed) % pool.queues.size();
+
+        {
+            auto &item = *pool.queues[index];
+            std::lock_guard lock{item.lock};
+            item.tasks.push_back(std::move(task));
+            pool.pending.fetch_add(1);
+        }
+
+        // The sleeping worker either has seen the task or is counted as the sleeper.
+        if (pool.sleepers.load())
+        {
+            std::lock_guard lock{pool.lock};
+            pool.ready.notify_one();
+        }
+    }
+
+private:
+    struct queue final
+    {
+        std::mutex lock;
+        std::deque<type::task> tasks;
+    };
+
+    struct state final
+    {
+        type::error_handler error_handler;
+        std::vector<std::unique_ptr<queue>> queues;
+        std::atomic<std::size_t> next{0};
+
+        // The count of the tasks in the queues, it's changed under the locks of the queues.
+        std::atomic<std::size_t> pending{0};
+        std::atomic<bool> stopped{false};
+
+        // The idle workers sleep till the tasks are posted.
+        std::mutex lock;
+        std::condition_variable ready;
+        std::atomic<std::size_t> sleepers{0};
+    };
+
+    // The pool and the queue of the worker running on the thread.
+    struct current_worker final
+    {
+        state const *owner = nullptr;
+        std::size_t index = 0;
+    };
+
+    std::shared_ptr<state> state_;
+    std::vector<std::thread> threads_;
+
+    work_stealing_pool(work_stealing_pool const &) = delete;
+    work_stealing_pool& operator = (work_stealing_pool const &) = delete;
+
+    static current_worker& get_current() noexcept
+    {
+        static thread_local current_worker current;
+        return current;
+    }
+
+    static bool take(state &pool, std::size_t index, type::task &task)
+    {
+        {
+            auto &own = *pool.queues[index];
+            std::lock_guard lock{own.lock};
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pool.pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1 ; i < pool.queues.size() ; ++i)
+        {
+            auto &other = *pool.queues[(index + i) % pool.queues.size()];
+            std::lock_guard lock{other.lock};
+            if (!other.tasks.empty())
+            {
+                task = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                pool.pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static void work(state &pool, std::size_t index) noexcept
+    {
+        get_current() = current_worker{&pool, index};
+
+        for (;;)
+        {
+            type::task task;
+            if (take(pool, index, task))
+            {
+                run(pool, task);
+                continue;
+            }
+
+            // The worker is counted as the sleeper before it looks at the count of the tasks,
+            // so a post either sees the sleeper or its task is seen here. A task passed over
+            // by the scan keeps the count, then the queues are scanned again.
+            std::unique_lock lock{pool.lock};
+            pool.sleepers.fetch_add(1);
+            pool.ready.wait(lock, [&pool] { return pool.stopped.load() || pool.pending.load(); });
+            pool.sleepers.fetch_sub(1);
+
+            if (pool.stopped.load() && !pool.pending.load())
+                return;
+        }
+    }
+
+    static void run(state &pool, type::task &task) noexcept
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            if (pool.error_handler)
+                pool.error_handler(std::current_exception());
+        }
+
+        task = nullptr;
+    }
+};
+
+// Runs the handlers of the methods by the options: on the calling thread, on the pool
+// of the method or on the shared pool. Without the shared pool the other methods are
+// passed to the scheduler of the transport, if it's given, or run on the calling thread.
+class handler_pool final
+{
+public:
+    explicit handler_pool(handler_options const &options,
+            type::error_handler error_handler = exception::default_error_handler,
+            type::scheduler scheduler = nullptr)
+        : cheap_{options.cheap}
+        , scheduler_{std::move(scheduler)}
+    {
+        if (options.workers)
+            shared_ = std::make_unique<work_stealing_pool>(options.workers, error_handler);
+
+        for (auto const &i : options.dedicated)
+        {
+            if (i.second)
+                dedicated_.emplace(i.first, std::make_unique<work_stealing_pool>(i.second, error_handler));
+        }
+    }
+
+    void execute(type::id method, type::task task)
+    {
+        if (cheap_.count(method))
+        {
+            task();
+            return;
+        }
+
+        if (auto const iter = dedicated_.find(method) ; iter != std::end(dedicated_))
+        {
+            iter->second->post(std::move(task));
+            return;
+        }
+
+        if (shared_)
+        {
+            shared_->post(std::move(task));
+            return;
+        }
+
+        if (scheduler_)
+        {
+            scheduler_(std::move(task));
+            return;
+        }
+
+        task();
+    }
+
+private:
+    std::set<type::id> cheap_;
+    type::scheduler scheduler_;
+    std::unique_ptr<work_stealing_pool> shared_;
+    std::map<type::id, std::unique_ptr<work_stealing_pool>> dedicated_;
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_HANDLER_POOL_H__
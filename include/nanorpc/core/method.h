@@ -0,0 +1,47 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_METHOD_H__
+#define __NANO_RPC_CORE_METHOD_H__
+
+// STD
+#include <tuple>
+#include <type_traits>
+
+// NANORPC
+#include "nanorpc/core/method_id.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+// The description of a remote method: its id and signature. The interface of a service is
+// described once by the constants of this type and shared by the client and the server:
+//
+//  namespace api
+//  {
+//  inline constexpr nanorpc::core::method<nanorpc::method_id("read"), data::employee (std::string)> read;
+//  }
+//
+//  data::employee employee = client.call(api::read, id);
+//
+// The calls by a method are checked by the compiler, the id is a constant and the result
+// is unpacked right into the declared type.
+template <type::id Id, typename TSignature>
+struct method;
+
+template <type::id Id, typename R, typename ... TArgs>
+struct method<Id, R (TArgs ... )> final
+{
+    using id = std::integral_constant<type::id, Id>;
+    using result_type = std::decay_t<R>;
+    using arguments_type = std::tuple<std::decay_t<TArgs> ... >;
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_METHOD_H__
@@ -0,0 +1,43 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_METHOD_ID_H__
+#define __NANO_RPC_CORE_METHOD_ID_H__
+
+// STD
+#include <cstdint>
+#include <string_view>
+
+// NANORPC
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+// FNV-1a 64. The result doesn't depend on the standard library, so clients and servers
+// built with different toolchains agree on the ids.
+constexpr type::id method_id(std::string_view name) noexcept
+{
+    type::id hash = 0xcbf29ce484222325ull;
+    for (auto c : name)
+    {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}   // namespace nanorpc::core
+
+namespace nanorpc
+{
+
+using core::method_id;
+
+}   // namespace nanorpc
+
+#endif  // !__NANO_RPC_CORE_METHOD_ID_H__
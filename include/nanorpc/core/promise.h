@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_PROMISE_H__
+#define __NANO_RPC_CORE_PROMISE_H__
+
+// STD
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/stop_token.h"
+
+namespace nanorpc::core
+{
+namespace detail
+{
+
+class promise_state_base
+{
+public:
+    virtual ~promise_state_base() noexcept = default;
+
+    // Only the first call of set_value or set_exception is taken into account.
+    bool acquire() noexcept
+    {
+        return !completed_.exchange(true);
+    }
+
+    bool completed() const noexcept
+    {
+        return completed_;
+    }
+
+    virtual void set_exception(std::exception_ptr exception) noexcept = 0;
+
+    virtual stop_token get_stop_token() const noexcept
+    {
+        return {};
+    }
+
+private:
+    std::atomic<bool> completed_{false};
+};
+
+template <typename T>
+class promise_state
+    : public promise_state_base
+{
+public:
+    virtual void set_value(T value) noexcept = 0;
+};
+
+template <>
+class promise_state<void>
+    : public promise_state_base
+{
+public:
+    virtual void set_value() noexcept = 0;
+};
+
+}   // namespace detail
+
+// The last parameter of an asynchronous handler. The handler can return before the result
+// is ready and complete the call later from any thread by set_value or set_exception.
+// If the promise is destroyed without a result the call is completed with an error.
+template <typename T>
+class promise final
+{
+public:
+    using value_type = T;
+    using state_ptr = std::shared_ptr<detail::promise_state<T>>;
+
+    explicit promise(state_ptr state)
+        : state_{std::move(state)}
+    {
+    }
+
+    template <typename U = T>
+    std::enable_if_t<!std::is_void_v<U>, void>
+    set_value(U value) const
+    {
+        if (state_->acquire())
+            state_->set_value(std::move(value));
+    }
+
+    template <typename U = T>
+    std::enable_if_t<std::is_void_v<U>, void>
+    set_value() const
+    {
+        if (state_->acquire())
+            state_->set_value();
+    }
+
+    void set_exception(std::exception_ptr exception) const
+    {
+        if (state_->acquire())
+            state_->set_exception(std::move(exception));
+    }
+
+    // The deadline of the call.
+    stop_token get_stop_token() const noexcept
+    {
+        return state_->get_stop_token();
+    }
+
+private:
+    state_ptr state_;
+};
+
+namespace detail
+{
+
+template <typename>
+struct is_promise
+    : std::false_type
+{
+};
+
+template <typename T>
+struct is_promise<promise<T>>
+    : std::true_type
+{
+};
+
+template <typename T>
+constexpr bool is_promise_v = is_promise<std::decay_t<T>>::value;
+
+}   // namespace detail
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_PROMISE_H__
@@ -9,19 +9,32 @@
 #define __NANO_RPC_CORE_SERVER_H__
 
 // STD
+#include <any>
 #include <functional>
 #include <map>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 // NANORPC
-#include "nanorpc/core/detail/function_meta.h"
+#include "nanorpc/core/detail/batcher.h"
+#include "nanorpc/core/detail/execute.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/detail/limiter.h"
 #include "nanorpc/core/detail/pack_meta.h"
+#include "nanorpc/core/detail/request_key.h"
+#include "nanorpc/core/detail/response_cache.h"
+#include "nanorpc/core/detail/single_flight.h"
+#include "nanorpc/core/detail/topic_hub.h"
 #include "nanorpc/core/exception.h"
+#include "nanorpc/core/method.h"
+#include "nanorpc/core/method_id.h"
+#include "nanorpc/core/subscription.h"
 #include "nanorpc/core/type.h"
-#include "nanorpc/version/core.h"
 
 namespace nanorpc::core
 {
@@ -30,121 +43,412 @@ template <typename TPacker>
 class server final
 {
 public:
+    server() = default;
+
+    // The scheduler runs the calls of a batch request concurrently and the micro-batches
+    // (handle_batch), e.g. by a core::thread_pool. Without it they are run one by one.
+    explicit server(type::scheduler scheduler)
+        : scheduler_{std::move(scheduler)}
+    {
+    }
+
     template <typename TFunc>
     void handle(std::string_view name, TFunc func)
     {
-        handle(std::hash<std::string_view>{}(name), std::move(func));
+        handle(method_id(name), std::move(func));
     }
 
     template <typename TFunc>
     void handle(type::id id, TFunc func)
     {
-        if (handlers_.find(id) != end(handlers_))
+        auto f = std::make_shared<TFunc>(std::move(func));
+
+        auto wrapper = [f] (deserializer_type &request, reply_type &response)
+            {
+                detail::invoke(*f, request, response);
+            };
+
+        direct_handler_type direct_wrapper;
+        if constexpr (!detail::is_async_handler<TFunc>())
         {
-            throw std::invalid_argument{"[" + std::string{__func__ } + "] Failed to add handler. "
-                    "The id \"" + std::to_string(id) + "\" already exists."};
+            direct_wrapper = [f] (std::any &arguments, std::any &result, type::result_packer &packer)
+                {
+                    return detail::invoke_direct<packer_type>(*f, arguments, result, packer);
+                };
         }
 
-        auto wrapper = [f = std::move(func)] (deserializer_type &request, serializer_type &response)
+        add_handler(id, std::move(wrapper), std::move(direct_wrapper));
+    }
+
+    // The handler of a described method. Its parameters must be of the declared types.
+    template <type::id Id, typename TSignature, typename TFunc>
+    void handle(method<Id, TSignature>, TFunc func)
+    {
+        static_assert(std::is_same_v<detail::request_arguments_t<TFunc>,
+                        typename method<Id, TSignature>::arguments_type>,
+                "[nanorpc::core::server::handle] The parameters of the handler differ from the method's ones."
+            );
+
+        handle(Id, std::move(func));
+    }
+
+    // The concurrent calls of the method are collected for the time of the window or until
+    // there are max_size of them and then executed by one call of the handler. The handler
+    // takes std::vector of the arguments and returns std::vector of the results in the same order.
+    // If the method has many parameters, the items of the vector are std::tuple of them.
+    // The batches are executed by the scheduler, if the server has it.
+    template <typename TFunc>
+    void handle_batch(std::string_view name, TFunc func, batch_options options = {})
+    {
+        handle_batch(method_id(name), std::move(func), std::move(options));
+    }
+
+    template <typename TFunc>
+    void handle_batch(type::id id, TFunc func, batch_options options = {})
+    {
+        using batcher_type = detail::batcher<packer_type, std::decay_t<TFunc>>;
+        auto wrapper = [batcher = std::make_shared<batcher_type>(std::move(func), std::move(options), scheduler_)]
+            (deserializer_type &request, reply_type &response)
             {
-                std::function func{std::move(f)};
-                using function_meta = detail::function_meta<decltype(func)>;
-                using arguments_tuple_type = typename function_meta::arguments_tuple_type;
-                arguments_tuple_type data;
-                request.unpack(data);
-                apply(std::move(func), std::move(data), response);
+                (*batcher)(request, response);
             };
 
-        handlers_.emplace(std::move(id), std::move(wrapper));
+        add_handler(id, std::move(wrapper), {});
     }
 
     type::buffer execute(type::buffer buffer)
-    try
     {
-        if (handlers_.empty())
-            throw exception::server{"[nanorpc::core::server::execute] No handlers."};
+        return detail::execute(std::move(buffer), [this] (type::buffer request, type::completion done)
+                { execute(std::move(request), std::move(done)); }
+            );
+    }
+
+    // The completion can be called on another thread if the handler is asynchronous.
+    void execute(type::buffer buffer, type::completion done)
+    {
+        // The response carries the epoch at the arrival of the request, so the clients can tell
+        // the responses built before an invalidation from the ones built after it.
+        if (auto const epoch = topics_->epoch())
+        {
+            done = [epoch, func = std::move(done)] (std::exception_ptr exception, type::buffer response)
+                {
+                    if (!exception)
+                        detail::set_epoch(response, epoch);
+                    func(std::move(exception), std::move(response));
+                };
+        }
+
+        if (intercept(buffer, done))
+            return;
+
+        detail::async_execute<packer_type>(std::move(buffer), std::move(done),
+                [this] (type::id id, deserializer_type &request, reply_type &response)
+                {
+                    return dispatch(id, request, response);
+                },
+                scheduler_
+            );
+    }
+
+    // The good responses of the method are kept for the time to live and returned for the
+    // requests with the same packed arguments without the execution of the handler.
+    // It's only for the handlers which results depend only on their arguments.
+    // The calls inside of batch requests and one-way calls are not cached.
+    void cache(std::string_view name, cache_options options)
+    {
+        cache(method_id(name), std::move(options));
+    }
+
+    void cache(type::id id, cache_options options)
+    {
+        get_handler(id).cache = std::make_shared<detail::response_cache>(std::move(options));
+    }
+
+    // The requests with the same packed arguments which arrive while the first of them is
+    // executed don't call the handler, they are completed with the response of the first one.
+    // It's only for the handlers without side effects. The calls inside of batch requests
+    // and one-way calls are not coalesced.
+    void coalesce(std::string_view name)
+    {
+        coalesce(method_id(name));
+    }
+
+    void coalesce(type::id id)
+    {
+        get_handler(id).flights = std::make_shared<detail::single_flight>();
+    }
+
+    // The limit of the calls of the method executed at the same time. The calls above the limit
+    // are rejected at once and the client gets exception::overload. The limit doesn't count
+    // the calls completed by the cache or by an identical call in flight. The one-way calls
+    // are counted till their handlers end, the ones above the limit are dropped silently.
+    void limit(std::string_view name, limit_options options)
+    {
+        limit(method_id(name), std::move(options));
+    }
+
+    void limit(type::id id, limit_options options)
+    {
+        get_handler(id).limiter = std::make_shared<detail::limiter>(std::move(options));
+    }
+
+    // The limit of all calls of the server, a batch request is counted as one call.
+    void limit(limit_options options)
+    {
+        limiter_ = std::make_shared<detail::limiter>(std::move(options));
+    }
+
+    // Sends the value to the subscribers of the topic. The value is packed once for all of them.
+    // The subscribers which are waiting get it at once, the others get it by their next poll.
+    template <typename T>
+    void publish(std::string_view topic, T const &value)
+    {
+        publish(method_id(topic), value);
+    }
+
+    template <typename T>
+    void publish(type::id topic, T const &value)
+    {
+        topics_->publish(topic, value);
+    }
+
+    // The data of the method has been changed. The cached responses of the method are dropped
+    // on the server and on the clients: the clients which track the invalidations get the id
+    // of the method and the new epoch at once, the others see the new epoch in their next
+    // response and drop all their cached responses.
+    void invalidate(std::string_view name)
+    {
+        invalidate(method_id(name));
+    }
+
+    void invalidate(type::id id)
+    {
+        // The epoch is advanced first, so the calls in flight don't fill the cleared cache.
+        auto const epoch = topics_->advance();
+
+        if (auto const iter = handlers_.find(id) ; iter != end(handlers_) && iter->second.cache)
+            iter->second.cache->clear();
+
+        topics_->publish(detail::invalidate_topic, std::make_tuple(id, epoch));
+    }
+
+    void topic(std::string_view name, topic_options options)
+    {
+        topic(method_id(name), std::move(options));
+    }
 
-        packer_type packer;
+    void topic(type::id id, topic_options options)
+    {
+        topics_->configure(id, options);
+    }
+
+    // Executes the call in the same process without the packer. The arguments are std::tuple of
+    // the handler's argument types. Returns false if there is no such a handler, the types differ
+    // or the handler is asynchronous; then the call should be executed by the packed execute.
+    // The packer of the result is set, if the handler returns a value.
+    bool execute(type::id id, std::any &arguments, std::any &result, type::result_packer &packer)
+    {
+        auto const iter = handlers_.find(id);
+        if (iter == end(handlers_) || !iter->second.direct)
+            return false;
+        return iter->second.direct(arguments, result, packer);
+    }
+
+private:
+    using packer_type = TPacker;
+    using deserializer_type = typename packer_type::deserializer_type;
+    using reply_type = detail::reply<packer_type>;
+    using handler_type = std::function<void (deserializer_type &, reply_type &)>;
+    using direct_handler_type = std::function<bool (std::any &, std::any &, type::result_packer &)>;
 
-        auto request = packer.from_buffer(std::move(buffer));
+    struct handler_entry
+    {
+        handler_type packed;
+        direct_handler_type direct;
+        std::shared_ptr<detail::response_cache> cache;
+        std::shared_ptr<detail::single_flight> flights;
+        std::shared_ptr<detail::limiter> limiter;
+    };
+
+    using handlers_type = std::map<type::id, handler_entry>;
 
+    type::scheduler scheduler_;
+    handlers_type handlers_;
+    std::shared_ptr<detail::limiter> limiter_;
+    std::shared_ptr<detail::topic_hub<packer_type>> topics_ = std::make_shared<detail::topic_hub<packer_type>>();
+
+    void add_handler(type::id id, handler_type handler, direct_handler_type direct_handler)
+    {
+        if (handlers_.find(id) != end(handlers_))
         {
-            version::core::protocol::value_type protocol{};
-            request = request.unpack(protocol);
-            if (protocol != version::core::protocol::value)
-            {
-                throw exception::server{"[nanorpc::core::server::execute] Unsupported protocol version \"" +
-                        std::to_string(protocol) + "\"."};
-            }
+            throw std::invalid_argument{"[nanorpc::core::server::handle] Failed to add handler. "
+                    "The id \"" + std::to_string(id) + "\" already exists."};
         }
 
+        handlers_.emplace(id, handler_entry{std::move(handler), std::move(direct_handler), {}, {}, {}});
+    }
+
+    handler_entry& get_handler(type::id id)
+    {
+        auto const iter = handlers_.find(id);
+        if (iter == end(handlers_))
         {
-            detail::pack::meta::type type{};
-            request = request.unpack(type);
-            if (type != detail::pack::meta::type::request)
-                throw exception::server{"[nanorpc::core::server::execute] Bad response type."};
+            throw std::invalid_argument{"[nanorpc::core::server] The handler with the id \"" +
+                    std::to_string(id) + "\" was not found."};
         }
 
-        type::id function_id{};
-        request = request.unpack(function_id);
+        return iter->second;
+    }
 
-        auto response = packer
-                .pack(version::core::protocol::value)
-                .pack(detail::pack::meta::type::response);
+    // Returns true if the request was a poll of the subscriptions, was completed by a cached
+    // response, joined an identical request in flight or was rejected by a limit. Otherwise
+    // the completion is replaced to release the limits, to fill the cache and to complete
+    // the joined requests.
+    bool intercept(type::buffer const &buffer, type::completion &done)
+    {
+        detail::header request_header;
+        if (!request_header.read(buffer))
+            return false;
 
-        auto const iter = handlers_.find(function_id);
-        if (iter == end(handlers_))
-            throw exception::server{"[nanorpc::core::server::execute] Function not found."};
+        handler_entry const *handler = nullptr;
+        if (request_header.type == detail::pack::meta::type::request)
+        {
+            auto const iter = handlers_.find(request_header.id);
+            if (iter != end(handlers_))
+                handler = &iter->second;
+        }
+
+        // The one-way calls are neither cached nor coalesced, only limited.
+        if (request_header.flags & detail::header::flag_one_way)
+            return !acquire(handler ? handler->limiter : nullptr, request_header, done);
+
+        if (request_header.type == detail::pack::meta::type::request && request_header.id == detail::subscribe_id)
+        {
+            topics_->poll(request_header, buffer, std::move(done));
+            return true;
+        }
+
+        std::shared_ptr<detail::response_cache> cache;
+        std::optional<detail::request_key> key;
+
+        if (handler && (handler->cache || handler->flights))
+        {
+            key = detail::make_request_key(request_header, buffer);
+            if (key)
+                cache = handler->cache;
+        }
 
-        try
+        if (cache)
         {
-            iter->second(request, response);
+            if (auto response = cache->get(*key))
+            {
+                detail::set_request_id(*response, request_header.request_id);
+                done(nullptr, std::move(*response));
+                return true;
+            }
         }
-        catch (std::exception const &e)
+
+        if (key && handler->flights && handler->flights->join(*key, request_header.request_id, done))
+            return true;
+
+        if (!acquire(handler ? handler->limiter : nullptr, request_header, done))
+            return true;
+
+        if (cache)
         {
-            response = response
-                    .pack(detail::pack::meta::status::fail)
-                    .pack(e.what());
+            done = [cache, key = std::move(*key), topics = topics_, epoch = topics_->epoch(), func = std::move(done)]
+                (std::exception_ptr exception, type::buffer response) mutable
+                {
+                    if (!exception && topics->epoch() == epoch)
+                        cache->put(std::move(key), response);
+                    func(std::move(exception), std::move(response));
+                };
         }
 
-        return response.to_buffer();
+        return false;
     }
-    catch (std::exception const &e)
+
+    // The method and the server limits are taken in turn. If one of them is exhausted,
+    // the request is rejected with the overload status at once. The one-way call is released
+    // when its completion, held till the end of the call, is destroyed.
+    bool acquire(std::shared_ptr<detail::limiter> const &method_limiter,
+            detail::header const &request_header, type::completion &done)
     {
-        return packer_type{}
-                .pack(version::core::protocol::value)
-                .pack(detail::pack::meta::type::response)
-                .pack(detail::pack::meta::status::fail)
-                .pack(e.what())
-                .to_buffer();
-    }
+        if (!method_limiter && !limiter_)
+            return true;
 
-private:
-    using packer_type = TPacker;
-    using serializer_type = typename packer_type::serializer_type;
-    using deserializer_type = typename packer_type::deserializer_type;
-    using handler_type = std::function<void (deserializer_type &, serializer_type &)>;
-    using handlers_type = std::map<type::id, handler_type>;
+        if (method_limiter && !method_limiter->try_acquire())
+        {
+            reject(request_header, std::move(done));
+            return false;
+        }
 
-    handlers_type handlers_;
+        if (limiter_ && !limiter_->try_acquire())
+        {
+            if (method_limiter)
+                method_limiter->cancel();
+            reject(request_header, std::move(done));
+            return false;
+        }
+
+        auto release = [method_limiter, server_limiter = limiter_, start = detail::limiter::clock_type::now()]
+            {
+                auto const latency = detail::limiter::clock_type::now() - start;
+                if (method_limiter)
+                    method_limiter->release(latency);
+                if (server_limiter)
+                    server_limiter->release(latency);
+            };
 
-    template <typename TFunc, typename TArgs>
-    static
-    std::enable_if_t<!std::is_same_v<std::decay_t<decltype(std::apply(std::declval<TFunc>(), std::declval<TArgs>()))>, void>, void>
-    apply(TFunc func, TArgs args, serializer_type &serializer)
+        if (request_header.flags & detail::header::flag_one_way)
+        {
+            std::shared_ptr<void> const guard{nullptr, [release] (void *) { release(); }};
+            done = [guard, func = std::move(done)] (std::exception_ptr exception, type::buffer response)
+                {
+                    func(std::move(exception), std::move(response));
+                };
+
+            return true;
+        }
+
+        done = [release, func = std::move(done)] (std::exception_ptr exception, type::buffer response)
+            {
+                release();
+                func(std::move(exception), std::move(response));
+            };
+
+        return true;
+    }
+
+    static void reject(detail::header const &request_header, type::completion done)
     {
-        auto data = std::apply(std::move(func), std::move(args));
-        serializer = serializer.pack(detail::pack::meta::status::good);
-        serializer = serializer.pack(data);
+        // The one-way call is dropped, the caller doesn't wait for its result.
+        if (request_header.flags & detail::header::flag_one_way)
+        {
+            done(nullptr, {});
+            return;
+        }
+
+        detail::header response_header;
+        response_header.type = request_header.type == detail::pack::meta::type::batch_request ?
+                detail::pack::meta::type::batch_response : detail::pack::meta::type::response;
+        response_header.id = request_header.id;
+        response_header.request_id = request_header.request_id;
+
+        reply_type{std::move(response_header), std::move(done)}
+                .reject("[nanorpc::core::server::execute] The server is overloaded.");
     }
 
-    template <typename TFunc, typename TArgs>
-    static
-    std::enable_if_t<std::is_same_v<std::decay_t<decltype(std::apply(std::declval<TFunc>(), std::declval<TArgs>()))>, void>, void>
-    apply(TFunc func, TArgs args, serializer_type &serializer)
+    bool dispatch(type::id id, deserializer_type &request, reply_type &response)
     {
-        std::apply(std::move(func), std::move(args));
-        serializer = serializer.pack(detail::pack::meta::status::good);
+        if (handlers_.empty())
+            throw exception::server{"[nanorpc::core::server::execute] No handlers."};
+
+        auto const iter = handlers_.find(id);
+        if (iter == end(handlers_))
+            return false;
+        iter->second.packed(request, response);
+        return true;
     }
 };
 
@@ -0,0 +1,139 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_SERVICE_H__
+#define __NANO_RPC_CORE_SERVICE_H__
+
+// STD
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/detail/execute.h"
+#include "nanorpc/core/method.h"
+#include "nanorpc/core/method_id.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+template <type::id Id, typename TFunc>
+class handler final
+{
+public:
+    using id = std::integral_constant<type::id, Id>;
+    using function_type = TFunc;
+
+    explicit handler(function_type func)
+        : func_{std::move(func)}
+    {
+    }
+
+    template <typename TDeserializer, typename TReply>
+    void operator () (TDeserializer &request, TReply &response)
+    {
+        detail::invoke(func_, request, response);
+    }
+
+private:
+    function_type func_;
+};
+
+template <type::id Id, typename TFunc>
+handler<Id, std::decay_t<TFunc>> handle(TFunc &&func)
+{
+    return handler<Id, std::decay_t<TFunc>>{std::forward<TFunc>(func)};
+}
+
+template <typename TMethod, typename TFunc>
+handler<TMethod::id::value, std::decay_t<TFunc>> handle(TFunc &&func)
+{
+    static_assert(std::is_same_v<detail::request_arguments_t<std::decay_t<TFunc>>, typename TMethod::arguments_type>,
+            "[nanorpc::core::handle] The parameters of the handler differ from the method's ones.");
+
+    return handler<TMethod::id::value, std::decay_t<TFunc>>{std::forward<TFunc>(func)};
+}
+
+// The compile-time counterpart of core::server. The set of handlers is fixed in the type, so
+// execute calls them directly without std::function and without a lookup in a map.
+template <typename TPacker, typename ... THandlers>
+class service final
+{
+public:
+    static_assert(sizeof ... (THandlers) != 0, "[nanorpc::core::service] No handlers.");
+
+    explicit service(THandlers ... handlers)
+        : handlers_{std::move(handlers) ... }
+    {
+        static_assert(has_unique_ids(), "[nanorpc::core::service] Handler ids must be unique.");
+    }
+
+    type::buffer execute(type::buffer buffer)
+    {
+        return detail::execute(std::move(buffer), [this] (type::buffer request, type::completion done)
+                { execute(std::move(request), std::move(done)); }
+            );
+    }
+
+    // The completion can be called on another thread if the handler is asynchronous.
+    // The calls of a batch are executed one by one.
+    void execute(type::buffer buffer, type::completion done)
+    {
+        detail::async_execute<packer_type>(std::move(buffer), std::move(done),
+                [this] (type::id id, deserializer_type &request, reply_type &response)
+                {
+                    return dispatch(id, request, response, std::index_sequence_for<THandlers ... >{});
+                },
+                type::scheduler{}
+            );
+    }
+
+private:
+    using packer_type = TPacker;
+    using deserializer_type = typename packer_type::deserializer_type;
+    using reply_type = detail::reply<packer_type>;
+    using handlers_type = std::tuple<THandlers ... >;
+
+    handlers_type handlers_;
+
+    static constexpr bool has_unique_ids() noexcept
+    {
+        constexpr type::id ids[] = {THandlers::id::value ... };
+        for (std::size_t i = 0 ; i < std::size(ids) ; ++i)
+        {
+            for (auto j = i + 1 ; j < std::size(ids) ; ++j)
+            {
+                if (ids[i] == ids[j])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Unrolled into a chain of comparisons with constant ids, which the compiler is free
+    // to turn into a switch with inlined calls of the handlers.
+    template <std::size_t ... I>
+    bool dispatch(type::id id, deserializer_type &request, reply_type &response,
+            std::index_sequence<I ... >)
+    {
+        return ((id == std::tuple_element_t<I, handlers_type>::id::value &&
+                (std::get<I>(handlers_)(request, response), true)) || ... );
+    }
+};
+
+template <typename TPacker, typename ... THandlers>
+service<TPacker, THandlers ... > make_service(THandlers ... handlers)
+{
+    return service<TPacker, THandlers ... >{std::move(handlers) ... };
+}
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_SERVICE_H__
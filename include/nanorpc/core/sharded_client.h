@@ -0,0 +1,181 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_SHARDED_CLIENT_H__
+#define __NANO_RPC_CORE_SHARDED_CLIENT_H__
+
+// STD
+#include <any>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/client.h"
+#include "nanorpc/core/detail/hash_ring.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/method.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct shard_options final
+{
+    // The count of the points of every server on the ring.
+    std::size_t virtual_nodes = 160;
+    // The bound of the calls in flight of a server relative to the average, 0 - no bound.
+    // It must be greater than 1.
+    double load_factor = 1.25;
+    // The calls in flight every server takes before the bound applies, so a few calls
+    // don't spill over to the other servers.
+    std::size_t min_load = 8;
+};
+
+// Routes the calls to the servers by a key with a consistent hash ring. The same key goes
+// to the same server while it isn't overloaded, so the servers can keep the state of their keys.
+template <typename TPacker>
+class sharded_client final
+{
+public:
+    using client_type = client<TPacker>;
+    using result_type = typename client_type::result_type;
+    // The name of the server (e.g. host:port) places it on the ring, the executor sends the calls to it.
+    using shard_type = std::pair<std::string, type::async_executor>;
+
+    explicit sharded_client(std::vector<shard_type> shards, shard_options const &options = {})
+    {
+        if (shards.empty())
+            throw std::invalid_argument{"[nanorpc::core::sharded_client] No servers."};
+
+        std::vector<std::string> names;
+        names.reserve(shards.size());
+        for (auto const &i : shards)
+            names.emplace_back(i.first);
+
+        ring_ = std::make_shared<detail::hash_ring>(names, options.virtual_nodes, options.load_factor,
+                options.min_load);
+
+        clients_.reserve(shards.size());
+        for (std::size_t i = 0 ; i < shards.size() ; ++i)
+        {
+            auto executor = [ring = ring_, i, executor = std::move(shards[i].second)]
+                    (type::buffer request, type::completion done)
+                    {
+                        // The call which the executor has failed to send is not in flight.
+                        ring->acquire(i);
+                        try
+                        {
+                            executor(std::move(request), [ring, i, done = std::move(done)]
+                                    (std::exception_ptr exception, type::buffer response)
+                                    {
+                                        ring->release(i);
+                                        done(std::move(exception), std::move(response));
+                                    }
+                                );
+                        }
+                        catch (...)
+                        {
+                            ring->release(i);
+                            throw;
+                        }
+                    };
+
+            clients_.emplace_back(type::async_executor{std::move(executor)});
+        }
+    }
+
+    std::size_t size() const noexcept
+    {
+        return clients_.size();
+    }
+
+    // The client of the server for the key. The key is an integer or a string.
+    template <typename TKey>
+    client_type& shard(TKey const &key)
+    {
+        return clients_[ring_->find(detail::key_hash(key))];
+    }
+
+    // The key of the calls of the method is taken from their arguments by the function,
+    // which has the parameters of the method and returns an integer or a string.
+    template <type::id Id, typename TSignature, typename TFunc>
+    void route(method<Id, TSignature>, TFunc func)
+    {
+        using arguments_type = typename method<Id, TSignature>::arguments_type;
+
+        key_function<arguments_type> key = [f = std::move(func)] (arguments_type const &arguments)
+            {
+                return detail::key_hash(std::apply(f, arguments));
+            };
+
+        routes_[Id] = std::move(key);
+    }
+
+    template <type::id Id, typename TSignature, typename ... TArgs>
+    typename method<Id, TSignature>::result_type call(method<Id, TSignature> m, TArgs && ... args)
+    {
+        typename method<Id, TSignature>::arguments_type arguments{std::forward<TArgs>(args) ... };
+        auto &owner = clients_[ring_->find(get_key(m, arguments))];
+        return std::apply([&] (auto && ... values)
+                {
+                    return owner.call(m, std::move(values) ... );
+                },
+                std::move(arguments)
+            );
+    }
+
+    template <type::id Id, typename TSignature, typename ... TArgs>
+    std::future<typename method<Id, TSignature>::result_type> async_call(method<Id, TSignature> m, TArgs && ... args)
+    {
+        typename method<Id, TSignature>::arguments_type arguments{std::forward<TArgs>(args) ... };
+        auto &owner = clients_[ring_->find(get_key(m, arguments))];
+        return std::apply([&] (auto && ... values)
+                {
+                    return owner.async_call(m, std::move(values) ... );
+                },
+                std::move(arguments)
+            );
+    }
+
+private:
+    template <typename TArguments>
+    using key_function = std::function<std::uint64_t (TArguments const &)>;
+
+    std::shared_ptr<detail::hash_ring> ring_;
+    std::vector<client_type> clients_;
+    std::map<type::id, std::any> routes_;
+
+    template <type::id Id, typename TSignature>
+    std::uint64_t get_key(method<Id, TSignature>, typename method<Id, TSignature>::arguments_type const &arguments) const
+    {
+        using arguments_type = typename method<Id, TSignature>::arguments_type;
+
+        auto const iter = routes_.find(Id);
+        if (iter == std::end(routes_))
+            throw exception::client{"[nanorpc::core::sharded_client::call] No route for the method."};
+
+        auto const *key = std::any_cast<key_function<arguments_type>>(&iter->second);
+        if (!key)
+            throw exception::client{"[nanorpc::core::sharded_client::call] The route differs from the method."};
+
+        return (*key)(arguments);
+    }
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_SHARDED_CLIENT_H__
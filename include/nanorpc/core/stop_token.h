@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_STOP_TOKEN_H__
+#define __NANO_RPC_CORE_STOP_TOKEN_H__
+
+// STD
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+namespace nanorpc::core
+{
+
+// The deadline of a call. A handler gets it by the last parameter (or by the promise of an
+// asynchronous handler) and can give up the work which result won't be waited for anymore.
+class stop_token final
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    stop_token() = default;
+
+    explicit stop_token(clock_type::time_point deadline)
+        : deadline_{deadline}
+    {
+    }
+
+    // The token of a request with the budget in milliseconds since now, 0 - no deadline.
+    static stop_token from_budget(std::uint32_t budget)
+    {
+        if (!budget)
+            return {};
+        return stop_token{clock_type::now() + std::chrono::milliseconds{budget}};
+    }
+
+    bool stop_possible() const noexcept
+    {
+        return !!deadline_;
+    }
+
+    bool stop_requested() const noexcept
+    {
+        return deadline_ && clock_type::now() >= *deadline_;
+    }
+
+    std::optional<clock_type::time_point> deadline() const noexcept
+    {
+        return deadline_;
+    }
+
+    // The budget left in milliseconds, 0 - no deadline. The expired token has at least 1.
+    std::uint32_t budget() const noexcept
+    {
+        if (!deadline_)
+            return 0;
+
+        auto const left = std::chrono::ceil<std::chrono::milliseconds>(*deadline_ - clock_type::now()).count();
+        if (left <= 0)
+            return 1;
+        constexpr auto max_budget = std::numeric_limits<std::uint32_t>::max();
+        return left > max_budget ? max_budget : static_cast<std::uint32_t>(left);
+    }
+
+private:
+    std::optional<clock_type::time_point> deadline_;
+};
+
+namespace detail
+{
+
+template <typename T>
+constexpr bool is_stop_token_v = std::is_same_v<std::decay_t<T>, stop_token>;
+
+}   // namespace detail
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_STOP_TOKEN_H__
@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_SUBSCRIPTION_H__
+#define __NANO_RPC_CORE_SUBSCRIPTION_H__
+
+// STD
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/method_id.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+struct topic_options final
+{
+    // The count of the last updates of the topic kept for the subscribers which are behind.
+    std::size_t history = 64;
+};
+
+struct subscribe_options final
+{
+    // How long a poll waits for the updates on the server before it's sent again.
+    std::chrono::milliseconds hold{30000};
+    // The pause before the poll is sent again after an error of the transport.
+    std::chrono::milliseconds retry{1000};
+};
+
+namespace detail
+{
+
+// The reserved method of the polls of the subscriptions.
+inline constexpr type::id subscribe_id = method_id("nanorpc::subscribe");
+
+// The reserved topic of the ids of the methods which data has been changed.
+inline constexpr type::id invalidate_topic = method_id("nanorpc::invalidate");
+
+}   // namespace detail
+
+// The subscription to the updates of a topic. The updates stop when it's destroyed or cancelled.
+class subscription final
+{
+public:
+    subscription() = default;
+
+    explicit subscription(std::function<void ()> cancel)
+        : cancel_{std::move(cancel)}
+    {
+    }
+
+    subscription(subscription &&other) noexcept
+        : cancel_{std::exchange(other.cancel_, nullptr)}
+    {
+    }
+
+    subscription& operator = (subscription &&other) noexcept
+    {
+        if (this != &other)
+        {
+            cancel();
+            cancel_ = std::exchange(other.cancel_, nullptr);
+        }
+        return *this;
+    }
+
+    ~subscription() noexcept
+    {
+        cancel();
+    }
+
+    void cancel() noexcept
+    {
+        if (auto cancel = std::exchange(cancel_, nullptr))
+            cancel();
+    }
+
+private:
+    std::function<void ()> cancel_;
+
+    subscription(subscription const &) = delete;
+    subscription& operator = (subscription const &) = delete;
+};
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_SUBSCRIPTION_H__
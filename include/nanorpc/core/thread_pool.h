@@ -0,0 +1,150 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_CORE_THREAD_POOL_H__
+#define __NANO_RPC_CORE_THREAD_POOL_H__
+
+// STD
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::core
+{
+
+// A fixed set of threads for the tasks of the server. The tasks queued before
+// the destruction are completed, the destructor waits for them.
+class thread_pool final
+{
+public:
+    explicit thread_pool(std::size_t workers,
+            type::error_handler error_handler = exception::default_error_handler)
+        : state_{std::make_shared<state>()}
+    {
+        if (!workers)
+            throw std::invalid_argument{"[nanorpc::core::thread_pool] The workers count must be greater than 0."};
+
+        state_->error_handler = std::move(error_handler);
+
+        threads_.reserve(workers);
+        for (std::size_t i = 0 ; i < workers ; ++i)
+            threads_.emplace_back([self = state_] { work(*self); });
+    }
+
+    ~thread_pool() noexcept
+    {
+        {
+            std::lock_guard lock{state_->lock};
+            state_->stopped = true;
+        }
+
+        state_->ready.notify_all();
+
+        // The pool can be destroyed by its own task. The thread of the task keeps
+        // the shared state and finishes the queue on its own.
+        for (auto &thread : threads_)
+        {
+            if (thread.get_id() == std::this_thread::get_id())
+                thread.detach();
+            else if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    void post(type::task task)
+    {
+        {
+            std::lock_guard lock{state_->lock};
+            if (state_->stopped)
+                throw exception::server{"[nanorpc::core::thread_pool::post] The pool was stopped."};
+            state_->tasks.push_back(std::move(task));
+        }
+
+        state_->ready.notify_one();
+    }
+
+private:
+    struct state
+    {
+        type::error_handler error_handler;
+
+        std::mutex lock;
+        std::condition_variable ready;
+        std::deque<type::task> tasks;
+        bool stopped = false;
+    };
+
+    std::shared_ptr<state> state_;
+    std::vector<std::thread> threads_;
+
+    thread_pool(thread_pool const &) = delete;
+    thread_pool& operator = (thread_pool const &) = delete;
+
+    static void work(state &pool) noexcept
+    {
+        for (;;)
+        {
+            type::task task;
+
+            {
+                std::unique_lock lock{pool.lock};
+                pool.ready.wait(lock, [&pool] { return pool.stopped || !pool.tasks.empty(); });
+                if (pool.tasks.empty())
+                    return;
+                task = std::move(pool.tasks.front());
+                pool.tasks.pop_front();
+            }
+
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                if (pool.error_handler)
+                    pool.error_handler(std::current_exception());
+            }
+        }
+    }
+};
+
+// The pool of the scheduler is created by its first task, so the servers which never
+// get batch requests don't keep its threads.
+inline type::scheduler make_scheduler(std::size_t workers,
+        type::error_handler error_handler = exception::default_error_handler)
+{
+    if (!workers)
+        throw std::invalid_argument{"[nanorpc::core::make_scheduler] The workers count must be greater than 0."};
+
+    struct lazy_pool final
+    {
+        std::once_flag created;
+        std::unique_ptr<thread_pool> pool;
+    };
+
+    return [state = std::make_shared<lazy_pool>(), workers, error_handler = std::move(error_handler)]
+        (type::task task)
+        {
+            std::call_once(state->created, [&] { state->pool = std::make_unique<thread_pool>(workers, error_handler); });
+            state->pool->post(std::move(task));
+        };
+}
+
+}   // namespace nanorpc::core
+
+#endif  // !__NANO_RPC_CORE_THREAD_POOL_H__
@@ -9,9 +9,12 @@
 #define __NANO_RPC_CORE_TYPE_H__
 
 // STD
+#include <any>
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <map>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -19,11 +22,35 @@
 namespace nanorpc::core::type
 {
 
-using id = std::size_t;
+using id = std::uint64_t;
 using buffer = std::vector<char>;
 using executor = std::function<buffer (buffer)>;
 using executor_map = std::map<std::string, executor>;
+using completion = std::function<void (std::exception_ptr, buffer)>;
+using async_executor = std::function<void (buffer, completion)>;
+using async_executor_map = std::map<std::string, async_executor>;
 using error_handler = std::function<void (std::exception_ptr)>;
+using task = std::function<void ()>;
+using scheduler = std::function<void (task)>;
+// Packs the result of a direct call, so it can be unpacked into another type as a packed result.
+using result_packer = buffer (*)(std::any const &);
+using direct_executor = std::function<bool (id, std::any &, std::any &, result_packer &)>;
+
+// A stream is a sequence of chunks. The reader returns an empty optional at the end of the stream.
+using chunk_reader = std::function<std::optional<buffer> ()>;
+using chunk_writer = std::function<void (buffer)>;
+using stream_executor = std::function<void (chunk_reader, chunk_writer)>;
+using stream_executor_map = std::map<std::string, stream_executor>;
+
+// The asynchronous stream reads and writes the chunks by the handlers called on their completion,
+// one read may be pending at a time. The stream is ended by the completion, the error breaks it.
+using chunk_read_handler = std::function<void (std::exception_ptr, std::optional<buffer>)>;
+using async_chunk_reader = std::function<void (chunk_read_handler)>;
+using chunk_write_handler = std::function<void (std::exception_ptr)>;
+using async_chunk_writer = std::function<void (buffer, chunk_write_handler)>;
+using stream_completion = std::function<void (std::exception_ptr)>;
+using async_stream_executor = std::function<void (async_chunk_reader, async_chunk_writer, stream_completion)>;
+using async_stream_executor_map = std::map<std::string, async_stream_executor>;
 
 }   // namespace nanorpc::core::type
 
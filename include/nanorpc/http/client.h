@@ -20,24 +20,41 @@
 // NANORPC
 #include "nanorpc/core/exception.h"
 #include "nanorpc/core/type.h"
+#include "nanorpc/http/endpoint.h"
 
 namespace nanorpc::http
 {
 
 NANORPC_EXCEPTION_DECL_WITH_NAMESPACE(exception, client, core::exception::client)
 
+// The host "unix:/path/to/socket" connects the client to a unix domain socket, the port isn't used with it.
 class client final
 {
 public:
     client(std::string_view host, std::string_view port, std::size_t workers, std::string_view location,
             core::type::error_handler error_handler = core::exception::default_error_handler);
 
+    // One client for many servers. The servers share the workers, every server has its own
+    // pool of connections and its own executors, which are taken by the index of the server.
+    client(endpoints const &servers, std::size_t workers, std::string_view location,
+            core::type::error_handler error_handler = core::exception::default_error_handler);
+
     ~client() noexcept;
     void run();
     void stop();
     bool stopped() const noexcept;
 
-    core::type::executor const& get_executor() const;
+    // The count of the servers.
+    std::size_t size() const noexcept;
+
+    core::type::executor const& get_executor(std::size_t index = 0) const;
+    core::type::async_executor const& get_async_executor(std::size_t index = 0) const;
+
+    // The executor of the stream handled by the location on the server. The chunks of the request
+    // are taken from the reader while the chunks of the response are passed to the writer as they
+    // come, both on the calling thread. The call returns when the response has ended, it's made on
+    // a connection of its own and must not be made on the workers of the client.
+    core::type::stream_executor make_stream_executor(std::string_view location, std::size_t index = 0);
 
 private:
     class impl;
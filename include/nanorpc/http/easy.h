@@ -17,12 +17,18 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 // NANORPC
 #include "nanorpc/core/client.h"
+#include "nanorpc/core/fan_out.h"
 #include "nanorpc/core/server.h"
+#include "nanorpc/core/service.h"
+#include "nanorpc/core/sharded_client.h"
+#include "nanorpc/core/thread_pool.h"
 #include "nanorpc/core/type.h"
 #include "nanorpc/http/client.h"
+#include "nanorpc/http/endpoint.h"
 #include "nanorpc/http/server.h"
 #include "nanorpc/packer/plain_text.h"
 
@@ -39,23 +45,95 @@ make_client(std::string_view host, std::string_view port, std::size_t workers, s
             {
                 return executor(std::move(request));
             };
-    return {std::move(executor_proxy)};
+    auto async_executor_proxy = [executor = http_client->get_async_executor(), http_client]
+            (core::type::buffer request, core::type::completion done)
+            {
+                executor(std::move(request), std::move(done));
+            };
+    return {std::move(executor_proxy), std::move(async_executor_proxy)};
+}
+
+// The servers share the workers of one client, every server has its own pool of connections.
+inline core::fan_out<packer::plain_text>
+make_fan_out(endpoints const &servers, std::size_t workers, std::string_view location)
+{
+    auto http_client = std::make_shared<client>(servers, workers, std::move(location));
+    http_client->run();
+
+    std::vector<core::type::async_executor> executors;
+    executors.reserve(http_client->size());
+    for (std::size_t i = 0 ; i < http_client->size() ; ++i)
+    {
+        executors.emplace_back([executor = http_client->get_async_executor(i), http_client]
+                (core::type::buffer request, core::type::completion done)
+                {
+                    executor(std::move(request), std::move(done));
+                }
+            );
+    }
+
+    return core::fan_out<packer::plain_text>{std::move(executors)};
+}
+
+// The servers share the workers of one client, every server has its own pool of connections.
+// The servers are placed on the ring by their host:port.
+inline core::sharded_client<packer::plain_text>
+make_sharded_client(endpoints const &servers, std::size_t workers, std::string_view location,
+        core::shard_options const &options = {})
+{
+    auto http_client = std::make_shared<client>(servers, workers, std::move(location));
+    http_client->run();
+
+    std::vector<core::sharded_client<packer::plain_text>::shard_type> shards;
+    shards.reserve(http_client->size());
+    for (std::size_t i = 0 ; i < http_client->size() ; ++i)
+    {
+        auto executor = [executor = http_client->get_async_executor(i), http_client]
+                (core::type::buffer request, core::type::completion done)
+                {
+                    executor(std::move(request), std::move(done));
+                };
+
+        shards.emplace_back(servers[i].host + ":" + servers[i].port, std::move(executor));
+    }
+
+    return core::sharded_client<packer::plain_text>{std::move(shards), options};
 }
 
 template <typename ... T>
 inline server make_server(std::string_view address, std::string_view port, std::size_t workers,
                           std::string_view location, std::pair<char const *, T> const & ... handlers)
 {
-    auto core_server = std::make_shared<core::server<packer::plain_text>>();
+    // The calls of batch requests are run concurrently on their own threads.
+    auto core_server = std::make_shared<core::server<packer::plain_text>>(core::make_scheduler(workers));
     (core_server->handle(handlers.first, handlers.second), ... );
 
     auto executor = [srv = std::move(core_server)]
-            (core::type::buffer request)
+            (core::type::buffer request, core::type::completion done)
+            {
+                srv->execute(std::move(request), std::move(done));
+            };
+
+    core::type::async_executor_map executors;
+    executors.emplace(std::move(location), std::move(executor));
+
+    server http_server(std::move(address), std::move(port), workers, std::move(executors));
+    http_server.run();
+
+    return http_server;
+}
+
+template <typename ... T>
+inline server make_server(std::string_view address, std::string_view port, std::size_t workers,
+                          std::string_view location, core::service<packer::plain_text, T ... > service)
+{
+    auto executor = [srv = std::make_shared<core::service<packer::plain_text, T ... >>(std::move(service))]
+            (core::type::buffer request, core::type::completion done)
             {
-                return srv->execute(std::move(request));
+                srv->execute(std::move(request), std::move(done));
             };
 
-    core::type::executor_map executors;
+    core::type::async_executor_map executors;
     executors.emplace(std::move(location), std::move(executor));
 
     server http_server(std::move(address), std::move(port), workers, std::move(executors));
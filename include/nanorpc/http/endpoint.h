@@ -0,0 +1,29 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_HTTP_ENDPOINT_H__
+#define __NANO_RPC_HTTP_ENDPOINT_H__
+
+// STD
+#include <string>
+#include <vector>
+
+namespace nanorpc::http
+{
+
+// The host "unix:/path/to/socket" is a unix domain socket on the same machine, the port isn't used with it.
+struct endpoint final
+{
+    std::string host;
+    std::string port;
+};
+
+using endpoints = std::vector<endpoint>;
+
+}   // namespace nanorpc::http
+
+#endif  // !__NANO_RPC_HTTP_ENDPOINT_H__
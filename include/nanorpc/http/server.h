@@ -19,6 +19,7 @@
 
 // NANORPC
 #include "nanorpc/core/exception.h"
+#include "nanorpc/core/handler_pool.h"
 #include <nanorpc/core/type.h>
 
 namespace nanorpc::http
@@ -26,13 +27,44 @@ namespace nanorpc::http
 
 NANORPC_EXCEPTION_DECL_WITH_NAMESPACE(exception, server, core::exception::server)
 
+// The address "unix:/path/to/socket" listens a unix domain socket, the port isn't used with it.
+// A socket file left by the previous run is replaced, the file is removed by the stop.
 class server final
 {
 public:
+    // The executors are run by a handler pool of the workers size (core::make_handler_options).
     server(std::string_view address, std::string_view port, std::size_t workers,
            core::type::executor_map executors,
            core::type::error_handler error_handler = core::exception::default_error_handler);
 
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::async_executor_map executors,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    // The executors are run by the handler pool apart from the workers doing the I/O, the responses
+    // are written by the workers. The cheap methods are run on the workers.
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::async_executor_map executors, core::handler_options const &handler_options,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    // The streams are handled by their locations apart from the executors. A stream handler reads
+    // the request by chunks and writes the response by chunks, both go with the chunked transfer
+    // encoding and neither is kept in memory. The streams are not methods of the executors: they have
+    // no method id, packer, deadline, limits or handler pool of them.
+    // The chunks are read and written by the workers. A synchronous handler waits for them, so it takes
+    // a thread of a pool of the workers size for the whole stream, the streams over it wait in the queue.
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::async_executor_map executors, core::type::stream_executor_map streams,
+           core::handler_options const &handler_options = {},
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    // The asynchronous handlers take no thread of their own. They and their completion handlers
+    // are called on the workers and must not block.
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::async_executor_map executors, core::type::async_stream_executor_map streams,
+           core::handler_options const &handler_options = {},
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
     ~server() noexcept;
     void run();
     void stop();
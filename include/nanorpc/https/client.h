@@ -23,6 +23,7 @@
 // NANORPC
 #include "nanorpc/core/exception.h"
 #include "nanorpc/core/type.h"
+#include "nanorpc/http/endpoint.h"
 
 namespace nanorpc::https
 {
@@ -36,12 +37,23 @@ public:
             std::size_t workers, std::string_view location,
             core::type::error_handler error_handler = core::exception::default_error_handler);
 
+    client(boost::asio::ssl::context context, http::endpoints const &servers,
+            std::size_t workers, std::string_view location,
+            core::type::error_handler error_handler = core::exception::default_error_handler);
+
     ~client() noexcept;
     void run();
     void stop();
     bool stopped() const noexcept;
 
-    core::type::executor const& get_executor() const;
+    // The count of the servers.
+    std::size_t size() const noexcept;
+
+    core::type::executor const& get_executor(std::size_t index = 0) const;
+    core::type::async_executor const& get_async_executor(std::size_t index = 0) const;
+
+    // The executor of the stream as of http::client.
+    core::type::stream_executor make_stream_executor(std::string_view location, std::size_t index = 0);
 
 private:
     class impl;
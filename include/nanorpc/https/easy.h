@@ -17,14 +17,20 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 // BOOST
 #include <boost/asio/ssl/context.hpp>
 
 // NANORPC
 #include "nanorpc/core/client.h"
+#include "nanorpc/core/fan_out.h"
 #include "nanorpc/core/server.h"
+#include "nanorpc/core/service.h"
+#include "nanorpc/core/sharded_client.h"
+#include "nanorpc/core/thread_pool.h"
 #include "nanorpc/core/type.h"
+#include "nanorpc/http/endpoint.h"
 #include "nanorpc/https/client.h"
 #include "nanorpc/https/server.h"
 #include "nanorpc/packer/plain_text.h"
@@ -44,23 +50,96 @@ make_client(boost::asio::ssl::context context, std::string_view host, std::strin
             {
                 return executor(std::move(request));
             };
-    return {std::move(executor_proxy)};
+    auto async_executor_proxy = [executor = https_client->get_async_executor(), https_client]
+            (core::type::buffer request, core::type::completion done)
+            {
+                executor(std::move(request), std::move(done));
+            };
+    return {std::move(executor_proxy), std::move(async_executor_proxy)};
+}
+
+// The servers share the workers of one client, every server has its own pool of connections.
+inline core::fan_out<packer::plain_text>
+make_fan_out(boost::asio::ssl::context context, http::endpoints const &servers, std::size_t workers,
+        std::string_view location)
+{
+    auto https_client = std::make_shared<client>(std::move(context), servers, workers, std::move(location));
+    https_client->run();
+
+    std::vector<core::type::async_executor> executors;
+    executors.reserve(https_client->size());
+    for (std::size_t i = 0 ; i < https_client->size() ; ++i)
+    {
+        executors.emplace_back([executor = https_client->get_async_executor(i), https_client]
+                (core::type::buffer request, core::type::completion done)
+                {
+                    executor(std::move(request), std::move(done));
+                }
+            );
+    }
+
+    return core::fan_out<packer::plain_text>{std::move(executors)};
+}
+
+// The servers share the workers of one client, every server has its own pool of connections.
+// The servers are placed on the ring by their host:port.
+inline core::sharded_client<packer::plain_text>
+make_sharded_client(boost::asio::ssl::context context, http::endpoints const &servers, std::size_t workers,
+        std::string_view location, core::shard_options const &options = {})
+{
+    auto https_client = std::make_shared<client>(std::move(context), servers, workers, std::move(location));
+    https_client->run();
+
+    std::vector<core::sharded_client<packer::plain_text>::shard_type> shards;
+    shards.reserve(https_client->size());
+    for (std::size_t i = 0 ; i < https_client->size() ; ++i)
+    {
+        auto executor = [executor = https_client->get_async_executor(i), https_client]
+                (core::type::buffer request, core::type::completion done)
+                {
+                    executor(std::move(request), std::move(done));
+                };
+
+        shards.emplace_back(servers[i].host + ":" + servers[i].port, std::move(executor));
+    }
+
+    return core::sharded_client<packer::plain_text>{std::move(shards), options};
 }
 
 template <typename ... T>
 inline server make_server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
         std::size_t workers, std::string_view location, std::pair<char const *, T> const & ... handlers)
 {
-    auto core_server = std::make_shared<core::server<packer::plain_text>>();
+    // The calls of batch requests are run concurrently on their own threads.
+    auto core_server = std::make_shared<core::server<packer::plain_text>>(core::make_scheduler(workers));
     (core_server->handle(handlers.first, handlers.second), ... );
 
     auto executor = [srv = std::move(core_server)]
-            (core::type::buffer request)
+            (core::type::buffer request, core::type::completion done)
+            {
+                srv->execute(std::move(request), std::move(done));
+            };
+
+    core::type::async_executor_map executors;
+    executors.emplace(std::move(location), std::move(executor));
+
+    server https_server(std::move(context), std::move(address), std::move(port), workers, std::move(executors));
+    https_server.run();
+
+    return https_server;
+}
+
+template <typename ... T>
+inline server make_server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+        std::size_t workers, std::string_view location, core::service<packer::plain_text, T ... > service)
+{
+    auto executor = [srv = std::make_shared<core::service<packer::plain_text, T ... >>(std::move(service))]
+            (core::type::buffer request, core::type::completion done)
             {
-                return srv->execute(std::move(request));
+                srv->execute(std::move(request), std::move(done));
             };
 
-    core::type::executor_map executors;
+    core::type::async_executor_map executors;
     executors.emplace(std::move(location), std::move(executor));
 
     server https_server(std::move(context), std::move(address), std::move(port), workers, std::move(executors));
@@ -22,6 +22,7 @@
 
 // NANORPC
 #include "nanorpc/core/exception.h"
+#include "nanorpc/core/handler_pool.h"
 #include <nanorpc/core/type.h>
 
 namespace nanorpc::https
@@ -36,6 +37,25 @@ public:
            std::size_t workers, core::type::executor_map executors,
            core::type::error_handler error_handler = core::exception::default_error_handler);
 
+    server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+           std::size_t workers, core::type::async_executor_map executors,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    // The handler pool and the streams are as of http::server.
+    server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+           std::size_t workers, core::type::async_executor_map executors, core::handler_options const &handler_options,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+           std::size_t workers, core::type::async_executor_map executors, core::type::stream_executor_map streams,
+           core::handler_options const &handler_options = {},
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+           std::size_t workers, core::type::async_executor_map executors, core::type::async_stream_executor_map streams,
+           core::handler_options const &handler_options = {},
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
     ~server() noexcept;
     void run();
     void stop();
@@ -9,6 +9,7 @@
 #define __NANO_RPC_PACKER_PLAIN_TEXT_H__
 
 // STD
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iomanip>
@@ -64,9 +65,16 @@ public:
         return serializer{}.pack(value);
     }
 
-    deserializer from_buffer(core::type::buffer buffer)
+    // The packed data is appended to the given buffer.
+    serializer append_to(core::type::buffer buffer)
     {
-        return deserializer{std::move(buffer)};
+        return serializer{std::move(buffer)};
+    }
+
+    // The data is unpacked starting with the offset.
+    deserializer from_buffer(core::type::buffer buffer, std::size_t offset = 0)
+    {
+        return deserializer{std::move(buffer), offset};
     }
 
 private:
@@ -101,7 +109,9 @@ private:
             return tmp;
 #else
             auto str = std::move(stream_->str());
-            return {begin(str), end(str)};
+            auto tmp = std::move(buffer_);
+            tmp.insert(end(tmp), begin(str), end(str));
+            return tmp;
 #endif  // !NANORPC_PURE_CORE
         }
 
@@ -118,12 +128,25 @@ private:
         buffer_ptr buffer_{std::make_unique<core::type::buffer>()};
         stream_type_ptr stream_{std::make_unique<stream_type>(boost::iostreams::back_inserter(*buffer_))};
 #else
+        core::type::buffer buffer_;
         stream_type_ptr stream_{std::make_unique<std::stringstream>()};
 #endif  // !NANORPC_PURE_CORE
 
         friend class plain_text;
         serializer() = default;
 
+#ifndef NANORPC_PURE_CORE
+        serializer(core::type::buffer buffer)
+            : buffer_{std::make_unique<core::type::buffer>(std::move(buffer))}
+        {
+        }
+#else
+        serializer(core::type::buffer buffer)
+            : buffer_{std::move(buffer)}
+        {
+        }
+#endif  // !NANORPC_PURE_CORE
+
         serializer(serializer const &) = delete;
         serializer& operator = (serializer const &) = delete;
 
@@ -253,7 +276,9 @@ private:
 
 #ifndef NANORPC_PURE_CORE
         buffer_ptr buffer_;
-        source_type_ptr source_{std::make_unique<source_type>(!buffer_->empty() ? buffer_->data() : nullptr, buffer_->size())};
+        std::size_t offset_;
+        source_type_ptr source_{std::make_unique<source_type>(buffer_->size() > offset_ ? buffer_->data() + offset_ : nullptr,
+                buffer_->size() - offset_)};
         stream_type_ptr stream_{std::make_unique<stream_type>(*source_)};
 #else
         stream_type_ptr stream_{std::make_unique<stream_type>()};
@@ -265,13 +290,14 @@ private:
         deserializer& operator = (deserializer const &) = delete;
 
 #ifndef NANORPC_PURE_CORE
-        deserializer(core::type::buffer buffer)
+        deserializer(core::type::buffer buffer, std::size_t offset)
             : buffer_{std::make_unique<core::type::buffer>(std::move(buffer))}
+            , offset_{std::min(offset, buffer_->size())}
         {
         }
 #else
-        deserializer(core::type::buffer buffer)
-            : stream_{std::make_unique<stream_type>(std::string{begin(buffer), end(buffer)})}
+        deserializer(core::type::buffer buffer, std::size_t offset)
+            : stream_{std::make_unique<stream_type>(std::string{begin(buffer) + std::min(offset, buffer.size()), end(buffer)})}
         {
         }
 #endif  // !NANORPC_PURE_CORE
@@ -0,0 +1,58 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_SHM_CLIENT_H__
+#define __NANO_RPC_SHM_CLIENT_H__
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#ifndef NANORPC_PURE_CORE
+
+// STD
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/shm/options.h"
+
+namespace nanorpc::shm
+{
+
+NANORPC_EXCEPTION_DECL_WITH_NAMESPACE(exception, client, core::exception::client)
+
+// The client of the shared memory server of the name. The segment is attached by the first call
+// and again after the server has been restarted; a segment has only one client at a time,
+// the segment of a client which has died is taken by the next one. The calls are written by
+// the calling threads and the responses are read by one thread of the client. A synchronous
+// call waits for its response on its own thread, the completions of the asynchronous calls
+// are called by another thread of the client. The capacity of the options is taken from the server.
+class client final
+{
+public:
+    client(std::string_view name, options const &opts = {},
+            core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    ~client() noexcept;
+    void run();
+    void stop();
+    bool stopped() const noexcept;
+
+    core::type::executor const& get_executor() const;
+    core::type::async_executor const& get_async_executor() const;
+
+private:
+    class impl;
+    std::shared_ptr<impl> impl_;
+};
+
+}   // namespace nanorpc::shm
+
+#endif  // !NANORPC_PURE_CORE
+#endif  // !__NANO_RPC_SHM_CLIENT_H__
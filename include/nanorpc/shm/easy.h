@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_SHM_EASY_H__
+#define __NANO_RPC_SHM_EASY_H__
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#ifndef NANORPC_PURE_CORE
+
+// STD
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/client.h"
+#include "nanorpc/core/server.h"
+#include "nanorpc/core/service.h"
+#include "nanorpc/core/thread_pool.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/packer/plain_text.h"
+#include "nanorpc/shm/client.h"
+#include "nanorpc/shm/options.h"
+#include "nanorpc/shm/server.h"
+
+namespace nanorpc::shm::easy
+{
+
+inline core::client<packer::plain_text>
+make_client(std::string_view name, options const &opts = {})
+{
+    auto shm_client = std::make_shared<client>(std::move(name), opts);
+    shm_client->run();
+    auto executor_proxy = [executor = shm_client->get_executor(), shm_client]
+            (core::type::buffer request)
+            {
+                return executor(std::move(request));
+            };
+    auto async_executor_proxy = [executor = shm_client->get_async_executor(), shm_client]
+            (core::type::buffer request, core::type::completion done)
+            {
+                executor(std::move(request), std::move(done));
+            };
+    return {std::move(executor_proxy), std::move(async_executor_proxy)};
+}
+
+// With no workers the calls are executed on the thread reading the requests.
+template <typename ... T>
+inline server make_server(std::string_view name, std::size_t workers, options const &opts,
+                          std::pair<char const *, T> const & ... handlers)
+{
+    // The calls of batch requests are run concurrently on their own threads.
+    auto core_server = std::make_shared<core::server<packer::plain_text>>(
+            core::make_scheduler(std::max<std::size_t>(workers, 1)));
+    (core_server->handle(handlers.first, handlers.second), ... );
+
+    auto executor = [srv = std::move(core_server)]
+            (core::type::buffer request, core::type::completion done)
+            {
+                srv->execute(std::move(request), std::move(done));
+            };
+
+    server shm_server(std::move(name), workers, core::type::async_executor{std::move(executor)}, opts);
+    shm_server.run();
+
+    return shm_server;
+}
+
+template <typename ... T>
+inline server make_server(std::string_view name, std::size_t workers, options const &opts,
+                          core::service<packer::plain_text, T ... > service)
+{
+    auto executor = [srv = std::make_shared<core::service<packer::plain_text, T ... >>(std::move(service))]
+            (core::type::buffer request, core::type::completion done)
+            {
+                srv->execute(std::move(request), std::move(done));
+            };
+
+    server shm_server(std::move(name), workers, core::type::async_executor{std::move(executor)}, opts);
+    shm_server.run();
+
+    return shm_server;
+}
+
+}   // namespace nanorpc::shm::easy
+
+#endif  // !NANORPC_PURE_CORE
+#endif  // !__NANO_RPC_SHM_EASY_H__
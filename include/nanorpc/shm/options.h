@@ -0,0 +1,31 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_SHM_OPTIONS_H__
+#define __NANO_RPC_SHM_OPTIONS_H__
+
+// STD
+#include <chrono>
+#include <cstddef>
+
+namespace nanorpc::shm
+{
+
+struct options final
+{
+    // The size of every ring of the segment, it's rounded up to a power of two.
+    // The messages bigger than the ring are passed in parts. It's set by the server.
+    std::size_t capacity = 1024 * 1024;
+    // How long the reading and the writing threads poll the ring before they sleep.
+    std::chrono::microseconds spin{50};
+    // The threads never sleep and every of them keeps a core busy all the time.
+    bool busy_poll = false;
+};
+
+}   // namespace nanorpc::shm
+
+#endif  // !__NANO_RPC_SHM_OPTIONS_H__
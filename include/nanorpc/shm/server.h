@@ -0,0 +1,59 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_SHM_SERVER_H__
+#define __NANO_RPC_SHM_SERVER_H__
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#ifndef NANORPC_PURE_CORE
+
+// STD
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/shm/options.h"
+
+namespace nanorpc::shm
+{
+
+NANORPC_EXCEPTION_DECL_WITH_NAMESPACE(exception, server, core::exception::server)
+
+// The server of the processes on the same machine. It creates the POSIX shared memory segment
+// of the name with two rings, for the requests and for the responses, and serves one client
+// at a time. The frames are the same as the ones of the tcp transport.
+// The requests are read by one thread; with no workers the calls are executed on it,
+// otherwise they are executed by the workers. The segment is removed by the stop.
+class server final
+{
+public:
+    server(std::string_view name, std::size_t workers,
+           core::type::executor executor, options const &opts = {},
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    server(std::string_view name, std::size_t workers,
+           core::type::async_executor executor, options const &opts = {},
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    ~server() noexcept;
+    void run();
+    void stop();
+    bool stopped() const noexcept;
+
+private:
+    class impl;
+    std::shared_ptr<impl> impl_;
+};
+
+}   // namespace nanorpc::shm
+
+#endif  // !NANORPC_PURE_CORE
+#endif  // !__NANO_RPC_SHM_SERVER_H__
@@ -0,0 +1,67 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_TCP_CLIENT_H__
+#define __NANO_RPC_TCP_CLIENT_H__
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#ifndef NANORPC_PURE_CORE
+
+// STD
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/http/endpoint.h"
+
+namespace nanorpc::tcp
+{
+
+NANORPC_EXCEPTION_DECL_WITH_NAMESPACE(exception, client, core::exception::client)
+
+using http::endpoint;
+using http::endpoints;
+
+// The client of the binary protocol. Every server has one connection for all calls,
+// it's opened by the first call and again after it's lost. The calls in flight on a lost
+// connection fail, a call with a budget fails by its deadline without closing the connection.
+// The host "unix:/path/to/socket" connects to a unix domain socket, as the http client does.
+class client final
+{
+public:
+    client(std::string_view host, std::string_view port, std::size_t workers,
+            core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    // One client for many servers. The servers share the workers, every server has its own
+    // connection and its own executors, which are taken by the index of the server.
+    client(endpoints const &servers, std::size_t workers,
+            core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    ~client() noexcept;
+    void run();
+    void stop();
+    bool stopped() const noexcept;
+
+    // The count of the servers.
+    std::size_t size() const noexcept;
+
+    core::type::executor const& get_executor(std::size_t index = 0) const;
+    core::type::async_executor const& get_async_executor(std::size_t index = 0) const;
+
+private:
+    class impl;
+    std::shared_ptr<impl> impl_;
+};
+
+}   // namespace nanorpc::tcp
+
+#endif  // !NANORPC_PURE_CORE
+#endif  // !__NANO_RPC_TCP_CLIENT_H__
@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_TCP_EASY_H__
+#define __NANO_RPC_TCP_EASY_H__
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#ifndef NANORPC_PURE_CORE
+
+// STD
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// NANORPC
+#include "nanorpc/core/client.h"
+#include "nanorpc/core/fan_out.h"
+#include "nanorpc/core/server.h"
+#include "nanorpc/core/service.h"
+#include "nanorpc/core/sharded_client.h"
+#include "nanorpc/core/thread_pool.h"
+#include "nanorpc/core/type.h"
+#include "nanorpc/packer/plain_text.h"
+#include "nanorpc/tcp/client.h"
+#include "nanorpc/tcp/server.h"
+
+namespace nanorpc::tcp::easy
+{
+
+inline core::client<packer::plain_text>
+make_client(std::string_view host, std::string_view port, std::size_t workers)
+{
+    auto tcp_client = std::make_shared<client>(std::move(host), std::move(port), workers);
+    tcp_client->run();
+    auto executor_proxy = [executor = tcp_client->get_executor(), tcp_client]
+            (core::type::buffer request)
+            {
+                return executor(std::move(request));
+            };
+    auto async_executor_proxy = [executor = tcp_client->get_async_executor(), tcp_client]
+            (core::type::buffer request, core::type::completion done)
+            {
+                executor(std::move(request), std::move(done));
+            };
+    return {std::move(executor_proxy), std::move(async_executor_proxy)};
+}
+
+// The servers share the workers of one client, every server has its own connection.
+inline core::fan_out<packer::plain_text>
+make_fan_out(endpoints const &servers, std::size_t workers)
+{
+    auto tcp_client = std::make_shared<client>(servers, workers);
+    tcp_client->run();
+
+    std::vector<core::type::async_executor> executors;
+    executors.reserve(tcp_client->size());
+    for (std::size_t i = 0 ; i < tcp_client->size() ; ++i)
+    {
+        executors.emplace_back([executor = tcp_client->get_async_executor(i), tcp_client]
+                (core::type::buffer request, core::type::completion done)
+                {
+                    executor(std::move(request), std::move(done));
+                }
+            );
+    }
+
+    return core::fan_out<packer::plain_text>{std::move(executors)};
+}
+
+// The servers share the workers of one client, every server has its own connection.
+// The servers are placed on the ring by their host:port.
+inline core::sharded_client<packer::plain_text>
+make_sharded_client(endpoints const &servers, std::size_t workers, core::shard_options const &options = {})
+{
+    auto tcp_client = std::make_shared<client>(servers, workers);
+    tcp_client->run();
+
+    std::vector<core::sharded_client<packer::plain_text>::shard_type> shards;
+    shards.reserve(tcp_client->size());
+    for (std::size_t i = 0 ; i < tcp_client->size() ; ++i)
+    {
+        auto executor = [executor = tcp_client->get_async_executor(i), tcp_client]
+                (core::type::buffer request, core::type::completion done)
+                {
+                    executor(std::move(request), std::move(done));
+                };
+
+        shards.emplace_back(servers[i].host + ":" + servers[i].port, std::move(executor));
+    }
+
+    return core::sharded_client<packer::plain_text>{std::move(shards), options};
+}
+
+template <typename ... T>
+inline server make_server(std::string_view address, std::string_view port, std::size_t workers,
+                          std::pair<char const *, T> const & ... handlers)
+{
+    // The calls of batch requests are run concurrently on their own threads.
+    auto core_server = std::make_shared<core::server<packer::plain_text>>(core::make_scheduler(workers));
+    (core_server->handle(handlers.first, handlers.second), ... );
+
+    auto executor = [srv = std::move(core_server)]
+            (core::type::buffer request, core::type::completion done)
+            {
+                srv->execute(std::move(request), std::move(done));
+            };
+
+    server tcp_server(std::move(address), std::move(port), workers, core::type::async_executor{std::move(executor)});
+    tcp_server.run();
+
+    return tcp_server;
+}
+
+template <typename ... T>
+inline server make_server(std::string_view address, std::string_view port, std::size_t workers,
+                          core::service<packer::plain_text, T ... > service)
+{
+    auto executor = [srv = std::make_shared<core::service<packer::plain_text, T ... >>(std::move(service))]
+            (core::type::buffer request, core::type::completion done)
+            {
+                srv->execute(std::move(request), std::move(done));
+            };
+
+    server tcp_server(std::move(address), std::move(port), workers, core::type::async_executor{std::move(executor)});
+    tcp_server.run();
+
+    return tcp_server;
+}
+
+}   // namespace nanorpc::tcp::easy
+
+#endif  // !NANORPC_PURE_CORE
+#endif  // !__NANO_RPC_TCP_EASY_H__
@@ -0,0 +1,64 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_TCP_SERVER_H__
+#define __NANO_RPC_TCP_SERVER_H__
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#ifndef NANORPC_PURE_CORE
+
+// STD
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// NANORPC
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/handler_pool.h"
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::tcp
+{
+
+NANORPC_EXCEPTION_DECL_WITH_NAMESPACE(exception, server, core::exception::server)
+
+// The server of the binary protocol: the messages of the core are sent in frames with
+// the ids of the calls, so a connection carries many calls at once. The next request
+// of a connection is read while the previous ones are executed. The executors are run by
+// the handler pool apart from the workers doing the I/O, the pool is of the workers size
+// without the options (core::make_handler_options).
+// The address "unix:/path/to/socket" listens a unix domain socket, as the http server does.
+class server final
+{
+public:
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::executor executor,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::async_executor executor,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    server(std::string_view address, std::string_view port, std::size_t workers,
+           core::type::async_executor executor, core::handler_options const &handler_options,
+           core::type::error_handler error_handler = core::exception::default_error_handler);
+
+    ~server() noexcept;
+    void run();
+    void stop();
+    bool stopped() const noexcept;
+
+private:
+    class impl;
+    std::shared_ptr<impl> impl_;
+};
+
+}   // namespace nanorpc::tcp
+
+#endif  // !NANORPC_PURE_CORE
+#endif  // !__NANO_RPC_TCP_SERVER_H__
@@ -15,7 +15,7 @@
 namespace nanorpc::version::core
 {
 
-using protocol = std::integral_constant<std::uint32_t, 1>;
+using protocol = std::integral_constant<std::uint32_t, 4>;
 
 }   // namespace nanorpc::version::core
 
@@ -6,12 +6,20 @@
 //-------------------------------------------------------------------
 
 // STD
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <utility>
@@ -23,6 +31,9 @@
 
 // NANORPC
 #include "nanorpc/core/detail/config.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/stop_token.h"
 #include "nanorpc/http/client.h"
 
 #ifdef NANORPC_WITH_SSL
@@ -36,7 +47,9 @@
 #endif  // !NANORPC_WITH_SSL
 
 // THIS
+#include "detail/chunk.h"
 #include "detail/constants.h"
+#include "detail/socket.h"
 #include "detail/utility.h"
 
 namespace nanorpc::http
@@ -50,36 +63,35 @@ class session
     : public std::enable_shared_from_this<session>
 {
 public:
-    session(boost::asio::io_context &context, core::type::error_handler const &error_handler)
+    session(boost::asio::io_context &context, core::error_reporter &error_reporter)
         : context_{context}
-        , error_handler_{error_handler}
+        , error_reporter_{error_reporter}
+        , strand_{context_.get_executor()}
     {
     }
 
     virtual ~session() noexcept = default;
 
-    void connect(boost::asio::ip::tcp::resolver::results_type const &endpoints)
+    void async_connect(net::endpoints_type const &endpoints,
+            std::function<void (std::exception_ptr)> on_connect)
     {
-        std::promise<bool> promise;
-
-        auto on_connect = [&promise]
+        auto on_connected = [func = std::move(on_connect)]
             (boost::system::error_code const &ec)
             {
                 if (!ec)
                 {
-                    promise.set_value(true);
+                    func(nullptr);
                 }
                 else
                 {
                     auto exception = exception::client{"Failed to connect to remote host. " + ec.message()};
-                    promise.set_exception(std::make_exception_ptr(std::move(exception)));
+                    func(std::make_exception_ptr(std::move(exception)));
                 }
             };
 
         utility::post(context_,
-                [&] { connect(endpoints, std::move(on_connect)); } );
-
-        promise.get_future().get();;
+                [self = shared_from_this(), endpoints, func = std::move(on_connected)]
+                { self->connect(endpoints, func); } );
     }
 
     void close() noexcept
@@ -90,7 +102,7 @@ public:
                 self->close(ec);
                 if (!ec)
                     return;
-                utility::handle_error<exception::client>(self->error_handler_,
+                utility::handle_error<exception::client>(self->error_reporter_,
                         std::make_exception_ptr(exception::client{ec.message()}),
                         "[nanorpc::http::detail::client::session::close] ",
                         "Failed to close session.");
@@ -99,7 +111,9 @@ public:
         utility::post(context_, std::move(close_connection));
     }
 
-    core::type::buffer send(core::type::buffer const &buffer, std::string const &location, std::string const &host)
+    // The completion is called on a thread of the client. All errors are passed to it as well.
+    void async_send(core::type::buffer const &buffer, std::string const &location, std::string const &host,
+            core::type::completion done)
     {
         auto request = std::make_shared<request_type>();
 
@@ -118,40 +132,33 @@ public:
 
         auto self = shared_from_this();
 
-        auto promise = std::make_shared<std::promise<core::type::buffer>>();
-
-        auto receive_response = [self, promise]
+        auto receive_response = [self, done]
             {
                 auto buffer = std::make_shared<buffer_type>();
                 auto response = std::make_shared<response_type>();
 
-                self->read(buffer, response, [self, promise, response]
+                self->read(buffer, response, [self, done, response]
                         (boost::system::error_code const &ec)
                         {
-                            if (ec == boost::asio::error::operation_aborted)
-                                return;
-
                             if (ec)
                             {
                                 auto exception = exception::client{"Failed to receive response. " + ec.message()};
-                                promise->set_exception(std::make_exception_ptr(std::move(exception)));
-                                self->close();
+                                done(std::make_exception_ptr(std::move(exception)), {});
+                                if (ec != boost::asio::error::operation_aborted)
+                                    self->close();
                                 return;
                             }
 
                             auto const &content = response->body();
-                            promise->set_value({begin(content), end(content)});
+                            done(nullptr, {begin(content), end(content)});
                         }
                     );
             };
 
 
-        self->write(request, [self, promise, receive = std::move(receive_response)]
+        self->write(request, [self, done, receive = std::move(receive_response)]
                 (boost::system::error_code const &ec)
                 {
-                    if (ec == boost::asio::error::operation_aborted)
-                        return;
-
                     if (!ec)
                     {
                         utility::post(self->context_, std::move(receive));
@@ -159,13 +166,98 @@ public:
                     else
                     {
                         auto exception = exception::client{"Failed to post request. " + ec.message()};
-                        promise->set_exception(std::make_exception_ptr(std::move(exception)));
-                        self->close();
+                        done(std::make_exception_ptr(std::move(exception)), {});
+                        if (ec != boost::asio::error::operation_aborted)
+                            self->close();
                     }
                 }
             );
+    }
+
+    // The request is written while the response is read, so the handler can answer a chunk
+    // before it takes the next one. The reader and the writer are called on the calling thread,
+    // the socket is used on the strand. Returns true when the session can take the next request.
+    bool stream(std::string const &location, std::string const &host,
+            core::type::chunk_reader const &reader, core::type::chunk_writer const &writer)
+    {
+        boost::beast::http::request<boost::beast::http::empty_body> request{
+                boost::beast::http::verb::post, location, constants::http_version};
+        request.set(boost::beast::http::field::host, host);
+        request.set(boost::beast::http::field::user_agent, constants::user_agent_name);
+        request.set(boost::beast::http::field::content_type, constants::content_type);
+        request.keep_alive(true);
+        request.chunked(true);
+
+        std::ostringstream header;
+        header << request.base();
+
+        auto state = std::make_shared<stream_state>();
+        state->outgoing.push_back({header.str(), {}});
+
+        boost::asio::post(strand_, [self = shared_from_this(), state]
+                {
+                    self->send_chunks(state);
+                    self->receive_header(state);
+                }
+            );
+
+        auto request_done = false;
+
+        std::unique_lock lock{state->lock};
+        for (;;)
+        {
+            state->changed.wait(lock, [&state, request_done]
+                    {
+                        return !state->incoming.empty() || (state->response_done && !state->writing) ||
+                                state->error || (!request_done && state->outgoing.size() < constants::stream_queue_size);
+                    }
+                );
+
+            if (!state->incoming.empty())
+            {
+                auto chunks = std::move(state->incoming);
+                state->incoming.clear();
+                auto const paused = std::exchange(state->paused, false);
+                lock.unlock();
+
+                if (paused)
+                    boost::asio::post(strand_, [self = shared_from_this(), state] { self->receive_chunks(state); });
+
+                for (auto &chunk : chunks)
+                    writer(std::move(chunk));
+
+                lock.lock();
+                continue;
+            }
+
+            // The server can answer without the rest of the request, then the connection is not reused.
+            if (state->response_done && !state->writing)
+                return request_done && state->outgoing.empty() && !state->error && state->keep_alive;
+
+            if (state->error)
+                std::rethrow_exception(state->error);
 
-        return promise->get_future().get();
+            lock.unlock();
+            auto chunk = reader();
+            lock.lock();
+
+            if (!chunk)
+            {
+                request_done = true;
+                state->outgoing.push_back({std::string{chunk::last, sizeof(chunk::last) - 1}, {}});
+            }
+            else if (!chunk->empty())
+            {
+                auto prefix = chunk::make_prefix(chunk->size());
+                state->outgoing.push_back({std::move(prefix), std::move(*chunk)});
+            }
+            else
+            {
+                continue;
+            }
+
+            boost::asio::post(strand_, [self = shared_from_this(), state] { self->send_chunks(state); });
+        }
     }
 
 protected:
@@ -178,16 +270,203 @@ protected:
     using response_type = boost::beast::http::response<boost::beast::http::string_body>;
     using response_ptr = std::shared_ptr<response_type>;
 
+    // The header of the streamed response is read first, its body is read by the chunks
+    // or by the parser of the string when the server has failed.
+    using header_parser_type = boost::beast::http::response_parser<boost::beast::http::empty_body>;
+    using header_parser_ptr = std::shared_ptr<header_parser_type>;
+    using response_parser_type = boost::beast::http::response_parser<boost::beast::http::string_body>;
+    using response_parser_ptr = std::shared_ptr<response_parser_type>;
+    using stream_parser_type = boost::beast::http::response_parser<boost::beast::http::buffer_body>;
+    using stream_parser_ptr = std::shared_ptr<stream_parser_type>;
+
+    using strand_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    strand_type& get_strand()
+    {
+        return strand_;
+    }
+
 private:
+    // The data of a chunk follow its prefix, the header and the last chunk have no data.
+    struct outgoing_chunk final
+    {
+        std::string prefix;
+        core::type::buffer data;
+    };
+
+    // The state of the stream shared by the calling thread and the strand. The chunk being
+    // written stays at the front of the queue till it has been written.
+    struct stream_state final
+    {
+        std::mutex lock;
+        std::condition_variable changed;
+
+        std::deque<outgoing_chunk> outgoing;
+        bool writing = false;
+
+        buffer_type buffer;
+        stream_parser_ptr parser;
+        std::deque<core::type::buffer> incoming;
+        bool paused = false;
+        bool response_done = false;
+        bool keep_alive = false;
+
+        std::exception_ptr error;
+    };
+
+    using stream_state_ptr = std::shared_ptr<stream_state>;
+
     boost::asio::io_context &context_;
-    core::type::error_handler const &error_handler_;
+    core::error_reporter &error_reporter_;
+    strand_type strand_;
 
-    virtual void connect(boost::asio::ip::tcp::resolver::results_type const &endpoints,
+    virtual void connect(net::endpoints_type const &endpoints,
             std::function<void (boost::system::error_code const &)> on_connect) = 0;
     virtual void close(boost::system::error_code &ec) = 0;
     virtual void write(request_ptr request, std::function<void (boost::system::error_code const &)> on_write) = 0;
     virtual void read(buffer_ptr buffer, response_ptr response,
             std::function<void (boost::system::error_code const &)> on_read) = 0;
+
+    // The operations of the streams, their completions are run on the strand.
+    virtual void write(std::vector<boost::asio::const_buffer> buffers,
+            std::function<void (boost::system::error_code const &)> on_write) = 0;
+    virtual void read_header(buffer_type &buffer, header_parser_type &parser,
+            std::function<void (boost::system::error_code const &)> on_read) = 0;
+    virtual void read(buffer_type &buffer, response_parser_type &parser,
+            std::function<void (boost::system::error_code const &)> on_read) = 0;
+    virtual void read(buffer_type &buffer, stream_parser_type &parser,
+            std::function<void (boost::system::error_code const &)> on_read) = 0;
+
+    static void fail_stream(stream_state &state, std::string const &message)
+    {
+        std::lock_guard lock{state.lock};
+        if (!state.error)
+            state.error = std::make_exception_ptr(exception::client{"[nanorpc::http::client::stream] " + message});
+        state.changed.notify_all();
+    }
+
+    void send_chunks(stream_state_ptr state)
+    {
+        std::unique_lock lock{state->lock};
+        if (state->writing || state->outgoing.empty() || state->error)
+            return;
+
+        state->writing = true;
+
+        // The elements of the deque stay in place when the calling thread adds the next ones.
+        auto const &chunk = state->outgoing.front();
+        std::vector<boost::asio::const_buffer> buffers{boost::asio::buffer(chunk.prefix)};
+        if (!chunk.data.empty())
+        {
+            buffers.push_back(boost::asio::buffer(chunk.data));
+            buffers.push_back(boost::asio::buffer(chunk::line_end, sizeof(chunk::line_end) - 1));
+        }
+
+        lock.unlock();
+
+        write(std::move(buffers), [self = shared_from_this(), state] (boost::system::error_code const &ec)
+                {
+                    {
+                        std::lock_guard lock{state->lock};
+                        state->writing = false;
+                        if (!ec)
+                            state->outgoing.pop_front();
+                        state->changed.notify_all();
+                    }
+
+                    if (ec)
+                    {
+                        fail_stream(*state, "Failed to send the stream. " + ec.message());
+                        return;
+                    }
+
+                    self->send_chunks(std::move(state));
+                }
+            );
+    }
+
+    void receive_header(stream_state_ptr state)
+    {
+        auto parser = std::make_shared<header_parser_type>();
+
+        read_header(state->buffer, *parser, [self = shared_from_this(), state, parser]
+                (boost::system::error_code const &ec)
+                {
+                    if (ec)
+                    {
+                        fail_stream(*state, "Failed to receive response. " + ec.message());
+                        return;
+                    }
+
+                    if (parser->get().result() != boost::beast::http::status::ok)
+                    {
+                        auto response = std::make_shared<response_parser_type>(std::move(*parser));
+                        self->read(state->buffer, *response, [state, response] (boost::system::error_code const &)
+                                {
+                                    auto const &message = response->get();
+                                    fail_stream(*state, "The server has failed. " + std::to_string(message.result_int()) +
+                                            " " + message.body());
+                                }
+                            );
+                        return;
+                    }
+
+                    // The size of a stream is not limited, it's never kept in memory.
+                    state->parser = std::make_shared<stream_parser_type>(std::move(*parser));
+                    state->parser->body_limit(std::numeric_limits<std::uint64_t>::max());
+
+                    self->receive_chunks(std::move(state));
+                }
+            );
+    }
+
+    // The reading waits while the calling thread has not taken the chunks read before.
+    void receive_chunks(stream_state_ptr state)
+    {
+        {
+            std::lock_guard lock{state->lock};
+            if (state->incoming.size() >= constants::stream_queue_size)
+            {
+                state->paused = true;
+                return;
+            }
+        }
+
+        auto chunk = std::make_shared<core::type::buffer>(constants::stream_chunk_size);
+        auto &body = state->parser->get().body();
+        body.data = chunk->data();
+        body.size = chunk->size();
+
+        read(state->buffer, *state->parser, [self = shared_from_this(), state, chunk]
+                (boost::system::error_code const &ec)
+                {
+                    if (ec && ec != boost::beast::http::error::need_buffer)
+                    {
+                        fail_stream(*state, "Failed to receive the stream. " + ec.message());
+                        return;
+                    }
+
+                    auto const &parser = *state->parser;
+                    chunk->resize(chunk->size() - parser.get().body().size);
+                    auto const done = parser.is_done();
+
+                    {
+                        std::lock_guard lock{state->lock};
+                        if (!chunk->empty())
+                            state->incoming.push_back(std::move(*chunk));
+                        if (done)
+                        {
+                            state->response_done = true;
+                            state->keep_alive = parser.get().keep_alive();
+                        }
+                        state->changed.notify_all();
+                    }
+
+                    if (!done)
+                        self->receive_chunks(std::move(state));
+                }
+            );
+    }
 };
 
 template <typename TBase, typename TSocket>
@@ -196,9 +475,9 @@ class session_base
 {
 public:
     template <typename ... TArgs>
-    session_base(core::type::error_handler const &error_handler,
+    session_base(core::error_reporter &error_reporter,
             boost::asio::io_context &io_context, TArgs && ... args)
-        : session{io_context, error_handler}
+        : session{io_context, error_reporter}
         , socket_{io_context, std::forward<TArgs>(args) ... }
     {
     }
@@ -240,23 +519,79 @@ private:
                 }
             );
     }
+
+    virtual void write(std::vector<boost::asio::const_buffer> buffers,
+            std::function<void (boost::system::error_code const &)> on_write) override final
+    {
+        boost::asio::async_write(socket_, std::move(buffers), boost::asio::bind_executor(this->get_strand(),
+                [func = std::move(on_write)] (boost::system::error_code const &ec, std::size_t bytes)
+                {
+                    boost::ignore_unused(bytes);
+                    func(ec);
+                }
+            ));
+    }
+
+    virtual void read_header(typename base_type::buffer_type &buffer, typename base_type::header_parser_type &parser,
+            std::function<void (boost::system::error_code const &)> on_read) override final
+    {
+        boost::beast::http::async_read_header(socket_, buffer, parser, boost::asio::bind_executor(this->get_strand(),
+                [func = std::move(on_read)] (boost::system::error_code const &ec, std::size_t bytes)
+                {
+                    boost::ignore_unused(bytes);
+                    func(ec);
+                }
+            ));
+    }
+
+    virtual void read(typename base_type::buffer_type &buffer, typename base_type::response_parser_type &parser,
+            std::function<void (boost::system::error_code const &)> on_read) override final
+    {
+        boost::beast::http::async_read(socket_, buffer, parser, boost::asio::bind_executor(this->get_strand(),
+                [func = std::move(on_read)] (boost::system::error_code const &ec, std::size_t bytes)
+                {
+                    boost::ignore_unused(bytes);
+                    func(ec);
+                }
+            ));
+    }
+
+    virtual void read(typename base_type::buffer_type &buffer, typename base_type::stream_parser_type &parser,
+            std::function<void (boost::system::error_code const &)> on_read) override final
+    {
+        boost::beast::http::async_read(socket_, buffer, parser, boost::asio::bind_executor(this->get_strand(),
+                [func = std::move(on_read)] (boost::system::error_code const &ec, std::size_t bytes)
+                {
+                    boost::ignore_unused(bytes);
+                    func(ec);
+                }
+            ));
+    }
 };
 
 class client
     : public std::enable_shared_from_this<client>
 {
 public:
-    client(std::string_view host, std::string_view port, std::size_t workers, core::type::error_handler error_handler)
-        : error_handler_{std::move(error_handler)}
+    // All servers share the workers, every server has its own pool of sessions.
+    client(http::endpoints const &endpoints, std::size_t workers, core::type::error_handler error_handler)
+        : error_reporter_{std::move(error_handler)}
         , workers_count_{std::max<int>(1, workers)}
         , context_{workers_count_}
         , work_guard_{boost::asio::make_work_guard(context_)}
+        , targets_(endpoints.size())
     {
-        boost::system::error_code ec;
-        boost::asio::ip::tcp::resolver resolver{context_};
-        endpoints_ = resolver.resolve(host, port, ec);
-        if (ec)
-            throw exception::client{"Failed to resolve endpoint \"" + std::string{host} + ":" + std::string{port} + "\""};
+        if (endpoints.empty())
+            throw exception::client{"No endpoints."};
+
+        for (std::size_t i = 0 ; i < endpoints.size() ; ++i)
+        {
+            targets_[i].name = net::get_name(endpoints[i].host, endpoints[i].port);
+            boost::system::error_code ec;
+            targets_[i].endpoints = net::resolve(context_, endpoints[i].host, endpoints[i].port, ec);
+            if (ec)
+                throw exception::client{"Failed to resolve endpoint \"" + targets_[i].name + "\""};
+        }
     }
 
     virtual ~client() noexcept
@@ -270,51 +605,58 @@ public:
         }
         catch (std::exception const &e)
         {
-            utility::handle_error<exception::client>(error_handler_, e,
+            utility::handle_error<exception::client>(error_reporter_, e,
                     "[nanorpc::http::detail::client::~client] Failed to done.");
         }
     }
 
     void init_executor(std::string_view location)
     {
-        auto executor = [this_ = std::weak_ptr{shared_from_this()}, dest_location = std::string{location}, host = boost::asio::ip::host_name()]
-            (core::type::buffer request)
+        location_ = location;
+        host_ = boost::asio::ip::host_name();
+
+        for (std::size_t i = 0 ; i < targets_.size() ; ++i)
+            init_executor(i);
+    }
+
+    void init_executor(std::size_t index)
+    {
+        auto async_executor = [this_ = std::weak_ptr{shared_from_this()}, index]
+            (core::type::buffer request, core::type::completion done)
             {
                 auto self = this_.lock();
                 if (!self)
-                    throw exception::client{"No owner object."};
-
-                session_ptr session;
-                core::type::buffer response;
-                try
                 {
-                    session = self->get_session();
-                    try
-                    {
-                        response = session->send(request, dest_location, host);
-                    }
-                    catch (exception::client const &e)
-                    {
-                        utility::handle_error<exception::client>(self->error_handler_, std::exception{e},
-                                "[nanorpc::client::executor] Failed to execute request. Try again ...");
-
-                        session = self->get_session();
-                        response = session->send(std::move(request), dest_location, host);
-                    }
-                    self->put_session(std::move(session));
+                    done(std::make_exception_ptr(exception::client{"No owner object."}), {});
+                    return;
                 }
-                catch (...)
-                {
-                    if (session)
-                        session->close();
 
-                    auto exception = exception::client{"[nanorpc::client::executor] Failed to send data."};
-                    std::throw_with_nested(std::move(exception));
-                }
-                return response;
+                core::detail::header request_header;
+                auto const token = request_header.read(request) ?
+                        core::stop_token::from_budget(request_header.budget) : core::stop_token{};
+
+                self->execute(index, std::make_shared<core::type::buffer>(std::move(request)), std::move(done), true, token);
+            };
+
+        auto executor = [async_executor] (core::type::buffer request)
+            {
+                auto promise = std::make_shared<std::promise<core::type::buffer>>();
+                auto future = promise->get_future();
+
+                async_executor(std::move(request), [promise] (std::exception_ptr exception, core::type::buffer response)
+                        {
+                            if (exception)
+                                promise->set_exception(std::move(exception));
+                            else
+                                promise->set_value(std::move(response));
+                        }
+                    );
+
+                return future.get();
             };
 
-        executor_ = std::move(executor);
+        targets_[index].executor = std::move(executor);
+        targets_[index].async_executor = std::move(async_executor);
     }
 
     void run()
@@ -336,7 +678,7 @@ public:
                         }
                         catch (std::exception const &e)
                         {
-                            utility::handle_error<exception::client>(self->error_handler_, e,
+                            utility::handle_error<exception::client>(self->error_reporter_, e,
                                     "[nanorpc::client::run] Failed to run.");
                             std::exit(EXIT_FAILURE);
                         }
@@ -354,7 +696,8 @@ public:
 
         work_guard_.reset();
         context_.stop();
-        std::exchange(session_queue_, session_queue_type{});
+        for (auto &i : targets_)
+            std::exchange(i.sessions, session_queue_type{});
         for_each(begin(workers_), end(workers_), [&] (std::thread &t)
                 {
                     try
@@ -363,7 +706,7 @@ public:
                     }
                     catch (std::exception const &e)
                     {
-                        utility::handle_error<exception::client>(error_handler_, e,
+                        utility::handle_error<exception::client>(error_reporter_, e,
                                 "[nanorpc::client::stop] Failed to stop.");
                         std::exit(EXIT_FAILURE);
                     }
@@ -378,9 +721,34 @@ public:
         return workers_.empty();
     }
 
-    core::type::executor const& get_executor() const
+    std::size_t size() const noexcept
+    {
+        return targets_.size();
+    }
+
+    core::type::executor const& get_executor(std::size_t index) const
+    {
+        return get_target(index).executor;
+    }
+
+    core::type::async_executor const& get_async_executor(std::size_t index) const
+    {
+        return get_target(index).async_executor;
+    }
+
+    core::type::stream_executor make_stream_executor(std::string_view location, std::size_t index)
     {
-        return executor_;
+        get_target(index);
+
+        return [this_ = std::weak_ptr{shared_from_this()}, location = std::string{location}, index]
+            (core::type::chunk_reader reader, core::type::chunk_writer writer)
+            {
+                auto self = this_.lock();
+                if (!self)
+                    throw exception::client{"[nanorpc::http::client::stream] No owner object."};
+
+                self->stream(index, location, reader, writer);
+            };
     }
 
 protected:
@@ -388,53 +756,243 @@ protected:
 
 private:
     using session_queue_type = std::queue<session_ptr>;
+    using request_ptr = std::shared_ptr<core::type::buffer const>;
+    using on_session_func = std::function<void (std::exception_ptr, session_ptr)>;
 
     using threads_type = std::vector<std::thread>;
 
-    core::type::executor executor_;
+    struct target final
+    {
+        // host:port or unix:<path>
+        std::string name;
+        net::endpoints_type endpoints;
+        session_queue_type sessions;
+        core::type::executor executor;
+        core::type::async_executor async_executor;
+    };
+
+    using targets_type = std::vector<target>;
+
+    std::string location_;
+    std::string host_;
 
-    core::type::error_handler error_handler_;
+    // The workers report the errors till they are joined.
+    core::error_reporter error_reporter_;
     int workers_count_;
     boost::asio::io_context context_;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
-    boost::asio::ip::tcp::resolver::results_type endpoints_;
 
     std::mutex lock_;
-    session_queue_type session_queue_;
+    targets_type targets_;
 
     threads_type workers_;
 
     virtual session_ptr make_session(boost::asio::io_context &io_context,
-            core::type::error_handler const &error_handler) = 0;
+            core::error_reporter &error_reporter) = 0;
+
+    // A pooled session can be closed by the server while it was idle, so the first failure
+    // of the request is retried once on another session.
+    // The handlers don't own the client. They are run only by the workers, which are joined
+    // before the client is destroyed, and the last owner must not be released on a worker.
+    // The deadline is taken from the budget of the request. When it has passed, the session is
+    // closed to cancel its operations and the request is completed with exception::timeout.
+    void execute(std::size_t index, request_ptr request, core::type::completion done, bool retry,
+            core::stop_token token)
+    {
+        auto on_session = [self = this, index, request, done, retry, token]
+            (std::exception_ptr exception, session_ptr session)
+            {
+                if (exception)
+                {
+                    done(make_error(std::move(exception)), {});
+                    return;
+                }
+
+                if (token.stop_requested())
+                {
+                    self->put_session(index, std::move(session));
+                    done(make_timeout(), {});
+                    return;
+                }
+
+                auto completed = std::make_shared<std::atomic<bool>>(false);
+                std::shared_ptr<boost::asio::steady_timer> timer;
+
+                if (token.stop_possible())
+                {
+                    timer = std::make_shared<boost::asio::steady_timer>(self->context_, *token.deadline());
+                    timer->async_wait([session, completed] (boost::system::error_code const &ec)
+                            {
+                                if (!ec && !completed->exchange(true))
+                                    session->close();
+                            }
+                        );
+                }
+
+                session->async_send(*request, self->location_, self->host_,
+                        [self, index, request, done, retry, token, session, timer, completed]
+                        (std::exception_ptr exception, core::type::buffer response)
+                        {
+                            auto const timed_out = completed->exchange(true);
+                            if (timer)
+                                timer->cancel();
+
+                            if (!exception)
+                            {
+                                if (!timed_out)
+                                    self->put_session(index, std::move(session));
+                                done(nullptr, std::move(response));
+                                return;
+                            }
+
+                            session->close();
+
+                            if (timed_out)
+                            {
+                                done(make_timeout(), {});
+                                return;
+                            }
+
+                            if (!retry)
+                            {
+                                done(make_error(std::move(exception)), {});
+                                return;
+                            }
+
+                            utility::handle_error<exception::client>({self->error_reporter_, self->targets_[index].name}, exception,
+                                    "[nanorpc::client::executor] Failed to execute request. Try again ...");
+
+                            self->execute(index, std::move(request), std::move(done), false, std::move(token));
+                        }
+                    );
+            };
+
+        get_session(index, std::move(on_session));
+    }
+
+    static std::exception_ptr make_timeout()
+    {
+        return std::make_exception_ptr(core::exception::timeout{"[nanorpc::client::executor] Timeout."});
+    }
 
-    session_ptr get_session()
+    static std::exception_ptr make_error(std::exception_ptr nested)
+    {
+        try
+        {
+            try
+            {
+                std::rethrow_exception(nested);
+            }
+            catch (...)
+            {
+                std::throw_with_nested(exception::client{"[nanorpc::client::executor] Failed to send data."});
+            }
+        }
+        catch (...)
+        {
+            return std::current_exception();
+        }
+    }
+
+    target const& get_target(std::size_t index) const
+    {
+        if (index >= targets_.size())
+            throw exception::client{"[nanorpc::http::client] Bad index of the server."};
+        return targets_[index];
+    }
+
+    // The stream takes a new connection, a pooled one could have been closed by the server
+    // and the stream can't be sent again. The connection is pooled after the stream.
+    void stream(std::size_t index, std::string const &location, core::type::chunk_reader const &reader,
+            core::type::chunk_writer const &writer)
+    {
+        auto promise = std::make_shared<std::promise<session_ptr>>();
+        auto future = promise->get_future();
+
+        connect_session(index, [promise] (std::exception_ptr exception, session_ptr session)
+                {
+                    if (exception)
+                        promise->set_exception(std::move(exception));
+                    else
+                        promise->set_value(std::move(session));
+                }
+            );
+
+        session_ptr session;
+        try
+        {
+            session = future.get();
+        }
+        catch (...)
+        {
+            std::rethrow_exception(make_error(std::current_exception()));
+        }
+
+        auto reusable = false;
+        try
+        {
+            reusable = session->stream(location, host_, reader, writer);
+        }
+        catch (...)
+        {
+            session->close();
+            throw;
+        }
+
+        if (reusable)
+            put_session(index, std::move(session));
+        else
+            session->close();
+    }
+
+    void get_session(std::size_t index, on_session_func on_session)
     {
         session_ptr session_item;
 
         {
             std::lock_guard lock{lock_};
-            if (!session_queue_.empty())
+            auto &sessions = targets_[index].sessions;
+            if (!sessions.empty())
             {
-                session_item = session_queue_.front();
-                session_queue_.pop();
+                session_item = sessions.front();
+                sessions.pop();
             }
         }
 
-        if (!session_item)
+        if (session_item)
         {
-            if (stopped())
-                throw exception::client{"Failed to get session. The client was not started."};
-            session_item = make_session(context_, error_handler_);
-            session_item->connect(endpoints_);
+            on_session(nullptr, std::move(session_item));
+            return;
         }
 
-        return session_item;
+        connect_session(index, std::move(on_session));
     }
 
-    void put_session(session_ptr session)
+    void connect_session(std::size_t index, on_session_func on_session)
+    {
+        if (stopped())
+        {
+            auto exception = exception::client{"Failed to get session. The client was not started."};
+            on_session(std::make_exception_ptr(std::move(exception)), {});
+            return;
+        }
+
+        auto session_item = make_session(context_, error_reporter_);
+        session_item->async_connect(targets_[index].endpoints,
+                [session_item, func = std::move(on_session)] (std::exception_ptr exception)
+                {
+                    if (exception)
+                        func(std::move(exception), {});
+                    else
+                        func(nullptr, session_item);
+                }
+            );
+    }
+
+    void put_session(std::size_t index, session_ptr session)
     {
         std::lock_guard lock{lock_};
-        session_queue_.emplace(std::move(session));
+        targets_[index].sessions.emplace(std::move(session));
     }
 };
 
@@ -449,22 +1007,22 @@ public:
 
 private:
     virtual session_ptr make_session(boost::asio::io_context &io_context,
-            core::type::error_handler const &error_handler) override final
+            core::error_reporter &error_reporter) override final
     {
-        return std::make_shared<session>(io_context, error_handler);
+        return std::make_shared<session>(io_context, error_reporter);
     }
 
     class session
-        : public detail::session_base<detail::session, boost::asio::ip::tcp::socket>
+        : public detail::session_base<detail::session, detail::net::socket_type>
     {
     public:
-        session(boost::asio::io_context &io_context, core::type::error_handler const &error_handler)
-            : session_base{error_handler, io_context}
+        session(boost::asio::io_context &io_context, core::error_reporter &error_reporter)
+            : session_base{error_reporter, io_context}
         {
         }
 
     private:
-        virtual void connect(boost::asio::ip::tcp::resolver::results_type const &endpoints,
+        virtual void connect(detail::net::endpoints_type const &endpoints,
                 std::function<void (boost::system::error_code const &)> on_connect) override final
         {
             boost::asio::async_connect(get_socket(), std::begin(endpoints), std::end(endpoints),
@@ -479,7 +1037,7 @@ private:
         {
             if (!get_socket().is_open())
                 return;
-            get_socket().shutdown(boost::asio::ip::tcp::socket::shutdown_send, ec);
+            get_socket().shutdown(detail::net::socket_type::shutdown_send, ec);
             if (ec)
                 return;
             get_socket().close(ec);
@@ -489,7 +1047,13 @@ private:
 
 client::client(std::string_view host, std::string_view port, std::size_t workers, std::string_view location,
         core::type::error_handler error_handler)
-    : impl_{std::make_shared<impl>(std::move(host), std::move(port), workers, std::move(error_handler))}
+    : client{endpoints{{std::string{host}, std::string{port}}}, workers, std::move(location), std::move(error_handler)}
+{
+}
+
+client::client(endpoints const &servers, std::size_t workers, std::string_view location,
+        core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(servers, workers, std::move(error_handler))}
 {
     impl_->init_executor(std::move(location));
 }
@@ -514,9 +1078,24 @@ bool client::stopped() const noexcept
     return impl_->stopped();
 }
 
-core::type::executor const& client::get_executor() const
+std::size_t client::size() const noexcept
+{
+    return impl_->size();
+}
+
+core::type::executor const& client::get_executor(std::size_t index) const
 {
-    return impl_->get_executor();
+    return impl_->get_executor(index);
+}
+
+core::type::async_executor const& client::get_async_executor(std::size_t index) const
+{
+    return impl_->get_async_executor(index);
+}
+
+core::type::stream_executor client::make_stream_executor(std::string_view location, std::size_t index)
+{
+    return impl_->make_stream_executor(std::move(location), index);
 }
 
 }   // namespace nanorpc::http
@@ -530,9 +1109,9 @@ class client::impl
     : public http::detail::client
 {
 public:
-    impl(boost::asio::ssl::context ssl_context, std::string_view host, std::string_view port,
+    impl(boost::asio::ssl::context ssl_context, http::endpoints const &servers,
             std::size_t workers, core::type::error_handler error_handler)
-        : http::detail::client{std::move(host), std::move(port), workers, std::move(error_handler)}
+        : http::detail::client{servers, workers, std::move(error_handler)}
         , ssl_context_{std::move(ssl_context)}
     {
     }
@@ -541,45 +1120,40 @@ private:
     boost::asio::ssl::context ssl_context_;
 
     virtual session_ptr make_session(boost::asio::io_context &io_context,
-            core::type::error_handler const &error_handler) override final
+            core::error_reporter &error_reporter) override final
     {
-        return std::make_shared<session>(io_context, ssl_context_, error_handler);
+        return std::make_shared<session>(io_context, ssl_context_, error_reporter);
     }
 
     class session
-        : public http::detail::session_base<http::detail::session, boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>
+        : public http::detail::session_base<http::detail::session, boost::asio::ssl::stream<http::detail::net::socket_type>>
     {
     public:
         session(boost::asio::io_context &io_context, boost::asio::ssl::context &ssl_context,
-                core::type::error_handler const &error_handler)
-            : session_base{error_handler, io_context, static_cast<boost::asio::ssl::context &>(ssl_context)}
+                core::error_reporter &error_reporter)
+            : session_base{error_reporter, io_context, static_cast<boost::asio::ssl::context &>(ssl_context)}
         {
         }
 
     private:
-        virtual void connect(boost::asio::ip::tcp::resolver::results_type const &endpoints,
+        virtual void connect(http::detail::net::endpoints_type const &endpoints,
                 std::function<void (boost::system::error_code const &)> on_connect) override final
         {
             boost::asio::async_connect(get_socket().next_layer(), std::begin(endpoints), std::end(endpoints),
                     [this, func = std::move(on_connect)] (boost::system::error_code const &ec, auto)
                     {
-                        std::promise<bool> promise;
+                        if (ec)
+                        {
+                            func(ec);
+                            return;
+                        }
 
                         get_socket().async_handshake(boost::asio::ssl::stream_base::client,
-                                [&promise] (boost::system::error_code const &ec)
+                                [func = std::move(func)] (boost::system::error_code const &ec)
                                 {
-                                    if (ec)
-                                    {
-                                        auto exception = exception::client{"Failed to do handshake. " + ec.message()};
-                                        promise.set_exception(std::make_exception_ptr(std::move(exception)));
-                                        return;
-                                    }
-
-                                    promise.set_value(true);
-                                });
-
-                        promise.get_future().get();
-                        func(ec);
+                                    func(ec);
+                                }
+                            );
                     }
                 );
         }
@@ -589,7 +1163,7 @@ private:
             boost::ignore_unused(ec);
             if (!get_socket().next_layer().is_open())
                 return;
-            get_socket().async_shutdown([] (boost::system::error_code const &ec)
+            get_socket().async_shutdown([self = shared_from_this()] (boost::system::error_code const &ec)
                     { boost::ignore_unused(ec); } );
         }
     };
@@ -597,7 +1171,14 @@ private:
 
 client::client(boost::asio::ssl::context context, std::string_view host, std::string_view port, std::size_t workers,
             std::string_view location, core::type::error_handler error_handler)
-    : impl_{std::make_shared<impl>(std::move(context), std::move(host), std::move(port), workers, std::move(error_handler))}
+    : client{std::move(context), http::endpoints{{std::string{host}, std::string{port}}}, workers,
+            std::move(location), std::move(error_handler)}
+{
+}
+
+client::client(boost::asio::ssl::context context, http::endpoints const &servers, std::size_t workers,
+            std::string_view location, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(context), servers, workers, std::move(error_handler))}
 {
     impl_->init_executor(std::move(location));
 }
@@ -622,9 +1203,24 @@ bool client::stopped() const noexcept
     return impl_->stopped();
 }
 
-core::type::executor const& client::get_executor() const
+std::size_t client::size() const noexcept
+{
+    return impl_->size();
+}
+
+core::type::executor const& client::get_executor(std::size_t index) const
+{
+    return impl_->get_executor(index);
+}
+
+core::type::async_executor const& client::get_async_executor(std::size_t index) const
+{
+    return impl_->get_async_executor(index);
+}
+
+core::type::stream_executor client::make_stream_executor(std::string_view location, std::size_t index)
 {
-    return impl_->get_executor();
+    return impl_->make_stream_executor(std::move(location), index);
 }
 
 }   // namespace nanorpc::https
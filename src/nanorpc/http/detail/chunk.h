@@ -0,0 +1,33 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_HTTP_DETAIL_CHUNK_H__
+#define __NANO_RPC_HTTP_DETAIL_CHUNK_H__
+
+// STD
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace nanorpc::http::detail::chunk
+{
+
+// A chunk of the chunked transfer encoding is its size in hex, the data and the line end.
+// The chunk of zero size ends the body, so the empty chunks are never written.
+inline constexpr char const line_end[] = "\r\n";
+inline constexpr char const last[] = "0\r\n\r\n";
+
+inline std::string make_prefix(std::size_t size)
+{
+    char prefix[2 * sizeof(std::size_t) + sizeof(line_end)];
+    auto const length = std::snprintf(prefix, sizeof(prefix), "%zx\r\n", size);
+    return {prefix, static_cast<std::size_t>(length)};
+}
+
+}   // namespace nanorpc::http::detail::chunk
+
+#endif  // !__NANO_RPC_HTTP_DETAIL_CHUNK_H__
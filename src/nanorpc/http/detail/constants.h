@@ -8,6 +8,9 @@
 #ifndef __NANO_RPC_HTTP_DETAIL_CONSTANTS_H__
 #define __NANO_RPC_HTTP_DETAIL_CONSTANTS_H__
 
+// STD
+#include <cstddef>
+
 namespace nanorpc::http::detail::constants
 {
 
@@ -17,6 +20,11 @@ inline constexpr auto content_type = "text/html";
 
 inline constexpr auto http_version = 11;
 
+// The streams are read by the pieces of this size at most, the chunks of the sender are not kept.
+inline constexpr std::size_t stream_chunk_size = 64 * 1024;
+// The count of the chunks queued by a stream before its reading or writing waits.
+inline constexpr std::size_t stream_queue_size = 4;
+
 }   // namespace nanorpc::http::detail::constants
 
 #endif  // !__NANO_RPC_HTTP_DETAIL_CONSTANTS_H__
@@ -0,0 +1,208 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_HTTP_DETAIL_SOCKET_H__
+#define __NANO_RPC_HTTP_DETAIL_SOCKET_H__
+
+// STD
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// BOOST
+#include <boost/asio.hpp>
+#include <boost/core/ignore_unused.hpp>
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+// POSIX
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif  // !BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+namespace nanorpc::http::detail::net
+{
+
+// The sessions work with both tcp and unix domain sockets through the generic protocol.
+using protocol_type = boost::asio::generic::stream_protocol;
+using socket_type = protocol_type::socket;
+using acceptor_type = boost::asio::basic_socket_acceptor<protocol_type>;
+using endpoint_type = protocol_type::endpoint;
+using endpoints_type = std::vector<endpoint_type>;
+
+// The host "unix:/path/to/socket" is a unix domain socket, the port isn't used with it.
+inline constexpr std::string_view unix_prefix = "unix:";
+
+inline std::optional<std::string_view> get_unix_path(std::string_view host) noexcept
+{
+    if (host.substr(0, unix_prefix.size()) != unix_prefix)
+        return {};
+    return host.substr(unix_prefix.size());
+}
+
+inline bool is_unix(endpoint_type const &endpoint) noexcept
+{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    return endpoint.protocol().family() == AF_UNIX;
+#else
+    boost::ignore_unused(endpoint);
+    return false;
+#endif  // !BOOST_ASIO_HAS_LOCAL_SOCKETS
+}
+
+inline endpoint_type make_unix_endpoint(std::string_view path)
+{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    if (path.empty())
+        throw std::invalid_argument{"Empty path of unix domain socket."};
+    return boost::asio::local::stream_protocol::endpoint{std::string{path}};
+#else
+    boost::ignore_unused(path);
+    throw std::invalid_argument{"Unix domain sockets are not supported on this platform."};
+#endif  // !BOOST_ASIO_HAS_LOCAL_SOCKETS
+}
+
+// The endpoint of a server. The address is an ip address or "unix:<path>".
+inline endpoint_type make_endpoint(std::string_view address, std::string_view port)
+{
+    if (auto const path = get_unix_path(address))
+        return make_unix_endpoint(*path);
+
+    return boost::asio::ip::tcp::endpoint{boost::asio::ip::make_address(address),
+            static_cast<unsigned short>(std::stol(std::string{port}))};
+}
+
+// The endpoints of a client. The host is a name, an ip address or "unix:<path>".
+inline endpoints_type resolve(boost::asio::io_context &context, std::string_view host,
+        std::string_view port, boost::system::error_code &ec)
+{
+    if (auto const path = get_unix_path(host))
+    {
+        try
+        {
+            return {make_unix_endpoint(*path)};
+        }
+        catch (std::exception const &)
+        {
+            ec = boost::asio::error::invalid_argument;
+            return {};
+        }
+    }
+
+    boost::asio::ip::tcp::resolver resolver{context};
+    auto const results = resolver.resolve(host, port, ec);
+    if (ec)
+        return {};
+
+    endpoints_type endpoints;
+    for (auto const &i : results)
+        endpoints.emplace_back(i.endpoint());
+    return endpoints;
+}
+
+// The name of an endpoint for the messages: "host:port" or "unix:<path>".
+inline std::string get_name(std::string_view host, std::string_view port)
+{
+    if (get_unix_path(host))
+        return std::string{host};
+    return std::string{host} + ":" + std::string{port};
+}
+
+inline std::string to_string(endpoint_type const &endpoint)
+{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    if (is_unix(endpoint))
+    {
+        boost::asio::local::stream_protocol::endpoint local;
+        if (endpoint.size() > local.capacity())
+            return std::string{unix_prefix};
+        std::memcpy(local.data(), endpoint.data(), endpoint.size());
+        local.resize(endpoint.size());
+        return std::string{unix_prefix} + local.path();
+    }
+#endif  // !BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+    boost::asio::ip::tcp::endpoint ip;
+    if (endpoint.size() > ip.capacity())
+        return {};
+    std::memcpy(ip.data(), endpoint.data(), endpoint.size());
+    ip.resize(endpoint.size());
+    return ip.address().to_string() + ":" + std::to_string(ip.port());
+}
+
+// The peers of the unix domain sockets are mostly unnamed, they are named by the path of the server.
+inline std::string get_peer_name(socket_type const &socket)
+{
+    boost::system::error_code ec;
+    auto endpoint = socket.remote_endpoint(ec);
+    if (!ec && is_unix(endpoint))
+        endpoint = socket.local_endpoint(ec);
+    return ec ? std::string{} : to_string(endpoint);
+}
+
+// Turns off Nagle's algorithm of the tcp sockets, the unix domain sockets don't have it.
+inline void set_no_delay(socket_type &socket, boost::system::error_code &ec)
+{
+    boost::system::error_code endpoint_ec;
+    if (is_unix(socket.local_endpoint(endpoint_ec)) || endpoint_ec)
+        return;
+    socket.set_option(boost::asio::ip::tcp::no_delay{true}, ec);
+}
+
+// The file of a unix domain socket is left after its server, it's removed before the bind
+// and after the stop. Only the sockets are removed, never the regular files.
+inline void remove_unix_file(endpoint_type const &endpoint) noexcept
+{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    if (!is_unix(endpoint))
+        return;
+
+    auto const path = to_string(endpoint).substr(unix_prefix.size());
+    struct stat info{};
+    if (!path.empty() && !::lstat(path.c_str(), &info) && S_ISSOCK(info.st_mode))
+        ::unlink(path.c_str());
+#else
+    boost::ignore_unused(endpoint);
+#endif  // !BOOST_ASIO_HAS_LOCAL_SOCKETS
+}
+
+// Opens, binds and listens the acceptor. The address is reused by the tcp acceptors only.
+inline void listen(acceptor_type &acceptor, endpoint_type const &endpoint)
+{
+    boost::system::error_code ec;
+
+    acceptor.open(endpoint.protocol(), ec);
+    if (ec)
+        throw std::runtime_error{"Failed to open acceptor. Message: " + ec.message()};
+
+    if (is_unix(endpoint))
+    {
+        remove_unix_file(endpoint);
+    }
+    else
+    {
+        acceptor.set_option(boost::asio::socket_base::reuse_address{true}, ec);
+        if (ec)
+            throw std::runtime_error{"Failed to set option \"reuse_address\". Message: " + ec.message()};
+    }
+
+    acceptor.bind(endpoint, ec);
+    if (ec)
+        throw std::runtime_error{"Failed to bind acceptor. Message: " + ec.message()};
+
+    acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+    if (ec)
+        throw std::runtime_error{"Failed to start listen. Message: " + ec.message()};
+}
+
+}   // namespace nanorpc::http::detail::net
+
+#endif  // !__NANO_RPC_HTTP_DETAIL_SOCKET_H__
@@ -9,8 +9,10 @@
 #define __NANO_RPC_HTTP_DETAIL_UTILITY_H__
 
 // STD
+#include <exception>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
@@ -19,101 +21,134 @@
 #include <boost/core/ignore_unused.hpp>
 
 // NANORPC
+#include "nanorpc/core/error_reporter.h"
 #include "nanorpc/core/exception.h"
+#include "nanorpc/core/expected.h"
 #include "nanorpc/core/type.h"
 
 namespace nanorpc::http::detail::utility
 {
 
-template <typename T>
-inline std::enable_if_t<std::is_invocable_v<T>, void>
-post(boost::asio::io_context &context, T func, core::type::error_handler error_handler = {}) noexcept
+// Where an error has happened: the reporter of the owner and the remote peer, if it's known.
+struct error_source final
 {
-    try
-    {
-        boost::asio::post(context,
-                [callable = std::move(func), error_handler]
-                {
-                    try
-                    {
-                        callable();
-                    }
-                    catch (std::exception const &e)
-                    {
-                        try
-                        {
-                            if (error_handler)
-                                error_handler(std::make_exception_ptr(e));
-                        }
-                        catch (...)
-                        {
-                        }
-                    }
-                }
-            );
-    }
-    catch (std::exception const &e)
+    error_source(core::error_reporter &reporter, std::string_view endpoint = {}) noexcept
+        : reporter{reporter}
+        , endpoint{endpoint}
     {
-        try
-        {
-            if (error_handler)
-                error_handler(std::make_exception_ptr(e));
-        }
-        catch (...)
-        {
-        }
     }
+
+    core::error_reporter &reporter;
+    std::string_view endpoint;
+};
+
+template <typename TEx>
+constexpr core::errc error_code() noexcept
+{
+    if constexpr (std::is_base_of_v<core::exception::timeout, TEx>)
+        return core::errc::timeout;
+    else if constexpr (std::is_base_of_v<core::exception::transport, TEx>)
+        return core::errc::transport;
+    else if constexpr (std::is_base_of_v<core::exception::packer, TEx>)
+        return core::errc::protocol;
+    else
+        return core::errc::logic;
 }
 
+// The message is built only if the rate limit of the site lets the error through.
+// The site is the first part of the message, e.g. "[nanorpc::http::...::read] ".
 template <typename TEx, typename ... TMsg>
-inline void handle_error(core::type::error_handler const &error_handler, TMsg const & ... message_items) noexcept
+inline void handle_error(error_source const &source, std::exception_ptr nested,
+        char const *site, TMsg const & ... message_items) noexcept
 {
     try
     {
-        if (!error_handler)
+        if (!source.reporter.admit(site))
             return;
 
-        std::string message;
+        std::string message{site};
         boost::ignore_unused((message += ... += std::string{message_items}));
-        auto exception = std::make_exception_ptr(TEx{std::move(message)});
-        error_handler(std::move(exception));
-    }
-    catch (...)
-    {
-    }
-}
-
-template <typename TEx, typename ... TMsg>
-inline void handle_error(core::type::error_handler const &error_handler, std::exception_ptr nested, TMsg const & ... message_items) noexcept
-{
-    handle_error<TEx>(error_handler, message_items ... );
 
-    if (!nested)
-        return;
+        core::error_event event;
+        event.code = error_code<TEx>();
+        event.component = core::error_reporter::component_name(site);
+        event.endpoint = source.endpoint;
 
-    try
-    {
-        try
+        if (!nested)
         {
-            std::rethrow_exception(nested);
+            event.exception = std::make_exception_ptr(TEx{std::move(message)});
         }
-        catch (std::exception const &e)
+        else
         {
-            handle_error<TEx>(error_handler, e.what());
+            try
+            {
+                try
+                {
+                    std::rethrow_exception(nested);
+                }
+                catch (...)
+                {
+                    std::throw_with_nested(TEx{std::move(message)});
+                }
+            }
+            catch (...)
+            {
+                event.exception = std::current_exception();
+            }
         }
 
-        std::rethrow_if_nested(nested);
+        source.reporter.report(std::move(event));
     }
     catch (...)
     {
-        handle_error<core::exception::nanorpc>(error_handler, std::current_exception());
     }
 }
 
 template <typename TEx, typename ... TMsg>
-inline void handle_error(core::type::error_handler const &error_handler, std::exception const &e, TMsg const & ... message_items) noexcept
+inline void handle_error(error_source const &source, char const *site, TMsg const & ... message_items) noexcept
+{
+    handle_error<TEx>(source, std::exception_ptr{}, site, message_items ... );
+}
+
+template <typename TEx, typename ... TMsg>
+inline void handle_error(error_source const &source, std::exception const &e,
+        char const *site, TMsg const & ... message_items) noexcept
 {
-    handle_error<TEx>(error_handler, std::make_exception_ptr(e), message_items ... );
+    handle_error<TEx>(source, std::make_exception_ptr(std::runtime_error{e.what()}), site, message_items ... );
+}
+
+template <typename T>
+inline std::enable_if_t<std::is_invocable_v<T>, void>
+post(boost::asio::io_context &context, T func, core::error_reporter *reporter = nullptr) noexcept
+{
+    try
+    {
+        boost::asio::post(context,
+                [callable = std::move(func), reporter]
+                {
+                    try
+                    {
+                        callable();
+                    }
+                    catch (std::exception const &e)
+                    {
+                        if (reporter)
+                        {
+                            handle_error<core::exception::nanorpc>(*reporter, e,
+                                    "[nanorpc::http::detail::utility::post] ", "Failed to call the task.");
+                        }
+                    }
+                }
+            );
+    }
+    catch (std::exception const &e)
+    {
+        if (reporter)
+        {
+            handle_error<core::exception::nanorpc>(*reporter, e,
+                    "[nanorpc::http::detail::utility::post] ", "Failed to post the task.");
+        }
+    }
 }
 
 }   // namespace nanorpc::http::detail::utility
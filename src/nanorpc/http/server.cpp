@@ -8,12 +8,23 @@
 // NANORPC
 
 // STD
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
+#include <exception>
+#include <future>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
 #include <vector>
 
 // BOOST
@@ -22,6 +33,9 @@
 
 // NANORPC
 #include "nanorpc/core/detail/config.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/handler_pool.h"
+#include "nanorpc/core/thread_pool.h"
 #include "nanorpc/http/server.h"
 
 #ifdef NANORPC_WITH_SSL
@@ -35,7 +49,9 @@
 #endif  // !NANORPC_WITH_SSL
 
 // THIS
+#include "detail/chunk.h"
 #include "detail/constants.h"
+#include "detail/socket.h"
 #include "detail/utility.h"
 
 namespace nanorpc::http
@@ -45,20 +61,152 @@ namespace detail
 namespace
 {
 
+core::type::async_executor_map to_async(core::type::executor_map executors)
+{
+    core::type::async_executor_map async_executors;
+    for (auto &i : executors)
+    {
+        auto executor = [func = std::move(i.second)] (core::type::buffer request, core::type::completion done)
+            {
+                done(nullptr, func(std::move(request)));
+            };
+        async_executors.emplace(i.first, std::move(executor));
+    }
+    return async_executors;
+}
+
+class session;
+
+// The handlers are shared by the sessions of the server. The executors are run by the handler pool
+// apart from the I/O threads. A synchronous stream handler waits for the I/O of its stream, so these
+// are run on a pool of their own. The streams in progress are broken by the stop.
+struct handlers final
+{
+    handlers(core::type::async_executor_map executors_map, core::type::stream_executor_map streams_map,
+            core::type::async_stream_executor_map async_streams_map, core::handler_options const &pool_options)
+        : executors{std::move(executors_map)}
+        , streams{std::move(streams_map)}
+        , async_streams{std::move(async_streams_map)}
+        , options{pool_options}
+    {
+    }
+
+    core::type::async_executor_map const executors;
+    core::type::stream_executor_map const streams;
+    core::type::async_stream_executor_map const async_streams;
+    core::handler_options const options;
+
+    std::unique_ptr<core::handler_pool> handler_pool;
+
+    std::unique_ptr<core::thread_pool> stream_pool;
+    std::mutex streams_lock;
+    std::set<session *> active_streams;
+    bool streams_stopped = false;
+};
+
+// Makes the I/O of a stream blocking for its synchronous handler. The stream broken by the stop
+// or by the error wakes up the waiting handler, the I/O of the stop is never completed.
+class stream_waiter final
+{
+public:
+    std::optional<core::type::buffer> read(core::type::async_chunk_reader const &reader)
+    {
+        auto call = start();
+        reader([call] (std::exception_ptr error, std::optional<core::type::buffer> chunk)
+                { call->complete(std::move(error), std::move(chunk)); }
+            );
+        return wait(*call);
+    }
+
+    void write(core::type::async_chunk_writer const &writer, core::type::buffer chunk)
+    {
+        auto call = start();
+        writer(std::move(chunk), [call] (std::exception_ptr error)
+                { call->complete(std::move(error), std::nullopt); }
+            );
+        wait(*call);
+    }
+
+    void abort(std::exception_ptr error) noexcept
+    {
+        std::lock_guard lock{lock_};
+        if (error_)
+            return;
+        error_ = std::move(error);
+        if (call_)
+            call_->complete(error_, std::nullopt);
+    }
+
+private:
+    struct call_type final
+    {
+        std::mutex lock;
+        std::condition_variable ready;
+        bool completed = false;
+        std::exception_ptr error;
+        std::optional<core::type::buffer> chunk;
+
+        void complete(std::exception_ptr call_error, std::optional<core::type::buffer> call_chunk) noexcept
+        {
+            {
+                std::lock_guard guard{lock};
+                if (completed)
+                    return;
+                completed = true;
+                error = std::move(call_error);
+                chunk = std::move(call_chunk);
+            }
+
+            ready.notify_one();
+        }
+    };
+
+    using call_ptr = std::shared_ptr<call_type>;
+
+    std::mutex lock_;
+    std::exception_ptr error_;
+    call_ptr call_;
+
+    call_ptr start()
+    {
+        std::lock_guard lock{lock_};
+        if (error_)
+            std::rethrow_exception(error_);
+        call_ = std::make_shared<call_type>();
+        return call_;
+    }
+
+    static std::optional<core::type::buffer> wait(call_type &call)
+    {
+        std::unique_lock lock{call.lock};
+        call.ready.wait(lock, [&call] { return call.completed; });
+        if (call.error)
+            std::rethrow_exception(call.error);
+        return std::move(call.chunk);
+    }
+};
+
 class session
     : public std::enable_shared_from_this<session>
 {
 public:
-    session(boost::asio::ip::tcp::socket socket, core::type::executor_map const &executors,
-                core::type::error_handler const &error_handler)
-        : executors_{executors}
-        , error_handler_{error_handler}
+    session(net::socket_type socket, detail::handlers &handlers, core::error_reporter &error_reporter)
+        : handlers_{handlers}
+        , error_reporter_{error_reporter}
         , socket_{std::move(socket)}
         , strand_{socket_.get_executor()}
+        , peer_{net::get_peer_name(socket_)}
     {
     }
 
-    virtual ~session() noexcept = default;
+    virtual ~session() noexcept
+    {
+        if (!stream_entered_)
+            return;
+
+        std::lock_guard lock{handlers_.streams_lock};
+        handlers_.active_streams.erase(this);
+    }
 
     void run() noexcept
     {
@@ -68,11 +216,11 @@ public:
             {
                 if (!ec)
                 {
-                    utility::post(self->socket_.get_io_context(), [self] { self->read(); }, self->error_handler_ );
+                    utility::post(self->socket_.get_io_context(), [self] { self->read(); }, &self->error_reporter_ );
                 }
                 else
                 {
-                    utility::handle_error<exception::server>(self->error_handler_,
+                    utility::handle_error<exception::server>(self->get_error_source(),
                     std::make_exception_ptr(std::runtime_error{ec.message()}),
                     "[nanorpc::http::detail::server::session::run] ",
                     "Failed to do handshake.");
@@ -82,12 +230,22 @@ public:
             };
 
         utility::post(socket_.get_io_context(), [self, func = std::move(on_handshake)]
-                { self->handshake(std::move(func)); }, error_handler_ );
+                { self->handshake(std::move(func)); }, &error_reporter_ );
 
     }
 
+    // Breaks the stream by the stop, the handler waiting for it is woken up by the error.
+    // It's called under the lock of the streams.
+    void abort(std::exception_ptr error) noexcept
+    {
+        boost::system::error_code ec;
+        socket_.shutdown(socket_type::shutdown_both, ec);
+        if (waiter_)
+            waiter_->abort(std::move(error));
+    }
+
 protected:
-    using socket_type = boost::asio::ip::tcp::socket;
+    using socket_type = net::socket_type;
     using strand_type = boost::asio::strand<boost::asio::io_context::executor_type>;
 
     using buffer_type = boost::beast::flat_buffer;
@@ -96,6 +254,14 @@ protected:
     using request_type = boost::beast::http::request<boost::beast::http::string_body>;
     using request_ptr = std::shared_ptr<request_type>;
 
+    // The header is read first, the body is read by the parser of the string or by the chunks of the stream.
+    using header_parser_type = boost::beast::http::request_parser<boost::beast::http::empty_body>;
+    using header_parser_ptr = std::shared_ptr<header_parser_type>;
+    using request_parser_type = boost::beast::http::request_parser<boost::beast::http::string_body>;
+    using request_parser_ptr = std::shared_ptr<request_parser_type>;
+    using stream_parser_type = boost::beast::http::request_parser<boost::beast::http::buffer_body>;
+    using stream_parser_ptr = std::shared_ptr<stream_parser_type>;
+
     using response_type = boost::beast::http::response<boost::beast::http::string_body>;
     using response_ptr = std::shared_ptr<response_type>;
 
@@ -111,57 +277,122 @@ protected:
         return strand_;
     }
 
+    utility::error_source get_error_source()
+    {
+        return {error_reporter_, peer_};
+    }
+
     virtual void handshake(on_completed_func on_handshake) = 0;
     virtual void close(boost::system::error_code &ec) = 0;
-    virtual void read(buffer_ptr, request_ptr, on_completed_func on_read) = 0;
+    virtual void read_header(buffer_ptr, header_parser_ptr, on_completed_func on_read) = 0;
+    virtual void read(buffer_ptr, request_parser_ptr, on_completed_func on_read) = 0;
     virtual void write(response_ptr response, on_completed_func on_write) = 0;
 
+    // A stream is read till the body buffer of the parser is full, the written buffers
+    // are kept by the caller till the completion.
+    virtual void read_stream(buffer_ptr buffer, stream_parser_ptr parser, on_completed_func on_read) = 0;
+    virtual void write_stream(std::vector<boost::asio::const_buffer> const &buffers, on_completed_func on_write) = 0;
+
 private:
-    core::type::executor_map const &executors_;
-    core::type::error_handler const &error_handler_;
+    detail::handlers &handlers_;
+    core::error_reporter &error_reporter_;
 
     socket_type socket_;
     strand_type strand_;
+    std::string peer_;
+
+    bool stream_entered_ = false;
+    std::shared_ptr<stream_waiter> waiter_;
+
+    // Returns false when the session was closed by the error.
+    bool check_read(boost::system::error_code const &ec)
+    {
+        if (ec == boost::asio::error::operation_aborted)
+            return false;
+
+        if (ec == boost::beast::http::error::end_of_stream)
+        {
+            close();
+            return false;
+        }
+
+        if (ec)
+        {
+            utility::handle_error<exception::server>(get_error_source(),
+                    std::make_exception_ptr(std::runtime_error{ec.message()}),
+                    "[nanorpc::http::detail::server::session::read] ",
+                    "Failed to read request.");
+            close();
+            return false;
+        }
+
+        return true;
+    }
 
     void read()
     {
         auto buffer = std::make_shared<buffer_type>();
-        auto request = std::make_shared<request_type>();
+        auto parser = std::make_shared<header_parser_type>();
 
-        auto on_read = [self = shared_from_this(), request] (boost::system::error_code const &ec) noexcept
+        auto on_read_body = [self = shared_from_this()] (request_parser_ptr parser, boost::system::error_code const &ec) noexcept
             {
                 try
                 {
-                    if (ec == boost::asio::error::operation_aborted)
+                    if (!self->check_read(ec))
                         return;
 
-                    if (ec == boost::beast::http::error::end_of_stream)
-                    {
-                        self->close();
+                    // The next request is read when the response to this one has been written.
+                    self->handle_request(std::make_shared<request_type>(parser->release()));
+                }
+                catch (std::exception const &e)
+                {
+                    utility::handle_error<exception::server>(self->get_error_source(), e,
+                            "[nanorpc::http::detail::server::session::read] ",
+                            "Failed to handle request.");
+                    self->close();
+                }
+            };
+
+        auto on_read_header = [self = shared_from_this(), buffer, parser, on_read_body]
+            (boost::system::error_code const &ec) noexcept
+            {
+                try
+                {
+                    if (!self->check_read(ec))
                         return;
-                    }
 
-                    auto const keep_alive = request->keep_alive();
-                    auto const need_eof = request->need_eof();
+                    auto const target = parser->get().target().to_string();
 
-                    self->handle_request(std::move(request));
+                    auto const &async_streams = self->handlers_.async_streams;
+                    if (auto const iter = async_streams.find(target) ; iter != std::end(async_streams))
+                    {
+                        self->handle_stream(buffer, std::make_shared<stream_parser_type>(std::move(*parser)), iter->second);
+                        return;
+                    }
 
-                    if (keep_alive && self->get_socket().is_open())
-                        self->read();
+                    auto const &streams = self->handlers_.streams;
+                    if (auto const iter = streams.find(target) ; iter != std::end(streams))
+                    {
+                        self->handle_stream(buffer, std::make_shared<stream_parser_type>(std::move(*parser)), iter->second);
+                        return;
+                    }
 
-                    if ((need_eof || !keep_alive) && self->get_socket().is_open())
-                        self->close();
+                    auto body_parser = std::make_shared<request_parser_type>(std::move(*parser));
+                    self->read(buffer, body_parser, [body_parser, func = on_read_body]
+                            (boost::system::error_code const &ec)
+                            { func(body_parser, ec); }
+                        );
                 }
                 catch (std::exception const &e)
                 {
-                    utility::handle_error<exception::server>(self->error_handler_, e,
+                    utility::handle_error<exception::server>(self->get_error_source(), e,
                             "[nanorpc::http::detail::server::session::read] ",
                             "Failed to handle request.");
                     self->close();
                 }
             };
 
-        read(buffer, request, std::move(on_read));
+        read_header(buffer, parser, std::move(on_read_header));
     }
 
     void close()
@@ -178,35 +409,437 @@ private:
                     {
                         if (ec != boost::asio::error::operation_aborted)
                         {
-                            utility::handle_error<exception::server>(self->error_handler_,
+                            utility::handle_error<exception::server>(self->get_error_source(),
                                     std::make_exception_ptr(std::runtime_error{ec.message()}),
                                     "[nanorpc::http::detail::server::session::close] ",
                                     "Failed to close socket.");
                         }
                     }
                 },
-                error_handler_
+                &error_reporter_
+            );
+    }
+
+    // A write of a stream: the header and the chunk prefix, the chunk and the line end.
+    struct stream_write final
+    {
+        std::string head;
+        core::type::buffer chunk;
+        std::string_view tail;
+        on_completed_func on_write;
+    };
+
+    // The stream is used on the strand only. One read is done at a time, the writes go in their order.
+    // The response goes by chunks, the header is sent with the first one, so the error before it
+    // is answered by 500, the later one breaks the connection and the client sees the response unfinished.
+    struct stream_type final
+    {
+        buffer_ptr buffer;
+        stream_parser_ptr parser;
+        core::type::buffer chunk;
+        unsigned version = constants::http_version;
+        bool keep_alive = false;
+        bool header_sent = false;
+        bool ended = false;
+        std::deque<stream_write> writes;
+    };
+
+    using stream_ptr = std::shared_ptr<stream_type>;
+
+    // The asynchronous handler is called on the strand, the I/O it asks for is posted to the strand.
+    void handle_stream(buffer_ptr buffer, stream_parser_ptr parser, core::type::async_stream_executor const &executor)
+    {
+        auto stream = open_stream(std::move(buffer), std::move(parser));
+        if (!stream)
+            return;
+
+        try
+        {
+            executor(make_reader(stream), make_writer(stream), make_completion(stream));
+        }
+        catch (...)
+        {
+            end_stream(stream, std::current_exception());
+        }
+    }
+
+    // The synchronous handler is run on the stream pool and waits there for the I/O done on the strand.
+    void handle_stream(buffer_ptr buffer, stream_parser_ptr parser, core::type::stream_executor const &executor)
+    {
+        if (!handlers_.stream_pool)
+        {
+            close();
+            return;
+        }
+
+        auto stream = open_stream(std::move(buffer), std::move(parser));
+        if (!stream)
+            return;
+
+        handlers_.stream_pool->post([self = shared_from_this(), reader = make_reader(stream),
+                writer = make_writer(stream), done = make_completion(stream), &executor]
+                {
+                    auto waiter = std::make_shared<stream_waiter>();
+
+                    {
+                        std::lock_guard lock{self->handlers_.streams_lock};
+                        if (self->handlers_.streams_stopped)
+                            return;
+                        self->waiter_ = waiter;
+                    }
+
+                    std::exception_ptr error;
+
+                    try
+                    {
+                        executor([&waiter, &reader] { return waiter->read(reader); },
+                                [&waiter, &writer] (core::type::buffer chunk) { waiter->write(writer, std::move(chunk)); }
+                            );
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                    }
+
+                    {
+                        std::lock_guard lock{self->handlers_.streams_lock};
+                        self->waiter_.reset();
+                    }
+
+                    done(std::move(error));
+                }
+            );
+    }
+
+    stream_ptr open_stream(buffer_ptr buffer, stream_parser_ptr parser)
+    {
+        // The size of a stream is not limited, it's never kept in memory.
+        parser->body_limit(std::numeric_limits<std::uint64_t>::max());
+
+        {
+            std::lock_guard lock{handlers_.streams_lock};
+            if (handlers_.streams_stopped)
+            {
+                close();
+                return {};
+            }
+            handlers_.active_streams.insert(this);
+            stream_entered_ = true;
+        }
+
+        auto stream = std::make_shared<stream_type>();
+        auto const &request = parser->get();
+        stream->version = request.version();
+        stream->keep_alive = request.keep_alive() && !request.need_eof();
+        stream->buffer = std::move(buffer);
+        stream->parser = std::move(parser);
+        return stream;
+    }
+
+    // The synchronous handler waiting for the stream broken by the error is woken up by it.
+    void leave_stream(std::exception_ptr error) noexcept
+    {
+        std::lock_guard lock{handlers_.streams_lock};
+        handlers_.active_streams.erase(this);
+        stream_entered_ = false;
+        if (waiter_ && error)
+            waiter_->abort(std::move(error));
+    }
+
+    core::type::async_chunk_reader make_reader(stream_ptr const &stream)
+    {
+        return [self = shared_from_this(), stream] (core::type::chunk_read_handler on_read)
+            {
+                boost::asio::post(self->strand_, [self, stream, func = std::move(on_read)] () mutable
+                        { self->read_chunk(stream, std::move(func)); }
+                    );
+            };
+    }
+
+    core::type::async_chunk_writer make_writer(stream_ptr const &stream)
+    {
+        return [self = shared_from_this(), stream] (core::type::buffer chunk, core::type::chunk_write_handler on_write)
+            {
+                boost::asio::post(self->strand_, [self, stream, chunk = std::move(chunk), func = std::move(on_write)] () mutable
+                        { self->write_chunk(stream, std::move(chunk), std::move(func)); }
+                    );
+            };
+    }
+
+    core::type::stream_completion make_completion(stream_ptr const &stream)
+    {
+        return [self = shared_from_this(), stream] (std::exception_ptr error)
+            {
+                boost::asio::post(self->strand_, [self, stream, error = std::move(error)]
+                        { self->end_stream(stream, error); }
+                    );
+            };
+    }
+
+    // The error of a handler breaks the stream.
+    template <typename THandler, typename ... TArgs>
+    void call_handler(stream_ptr const &stream, THandler const &handler, TArgs && ... args) noexcept
+    {
+        try
+        {
+            handler(std::forward<TArgs>(args) ... );
+        }
+        catch (...)
+        {
+            end_stream(stream, std::current_exception());
+        }
+    }
+
+    void read_chunk(stream_ptr const &stream, core::type::chunk_read_handler on_read) noexcept
+    {
+        try
+        {
+            if (stream->ended)
+            {
+                throw exception::server{"[nanorpc::http::detail::server::session::read_chunk] "
+                        "The stream has been ended."};
+            }
+
+            if (stream->parser->is_done())
+            {
+                call_handler(stream, on_read, nullptr, std::nullopt);
+                return;
+            }
+
+            stream->chunk.resize(constants::stream_chunk_size);
+            auto &body = stream->parser->get().body();
+            body.data = stream->chunk.data();
+            body.size = stream->chunk.size();
+
+            read_stream(stream->buffer, stream->parser, [self = shared_from_this(), stream, func = on_read]
+                    (boost::system::error_code const &ec)
+                    {
+                        self->on_read_chunk(stream, func, ec);
+                    }
+                );
+        }
+        catch (...)
+        {
+            call_handler(stream, on_read, std::current_exception(), std::nullopt);
+        }
+    }
+
+    void on_read_chunk(stream_ptr const &stream, core::type::chunk_read_handler const &on_read,
+            boost::system::error_code const &ec) noexcept
+    {
+        try
+        {
+            if (ec && ec != boost::beast::http::error::need_buffer)
+            {
+                throw exception::server{"[nanorpc::http::detail::server::session::read_chunk] "
+                        "Failed to read the stream. " + ec.message()};
+            }
+
+            auto &chunk = stream->chunk;
+            chunk.resize(chunk.size() - stream->parser->get().body().size);
+            if (!chunk.empty())
+            {
+                call_handler(stream, on_read, nullptr, std::move(chunk));
+                return;
+            }
+
+            if (!stream->parser->is_done())
+            {
+                read_chunk(stream, on_read);
+                return;
+            }
+
+            call_handler(stream, on_read, nullptr, std::nullopt);
+        }
+        catch (...)
+        {
+            call_handler(stream, on_read, std::current_exception(), std::nullopt);
+        }
+    }
+
+    void write_chunk(stream_ptr const &stream, core::type::buffer chunk, core::type::chunk_write_handler on_write) noexcept
+    {
+        try
+        {
+            if (stream->ended)
+            {
+                throw exception::server{"[nanorpc::http::detail::server::session::write_chunk] "
+                        "The stream has been ended."};
+            }
+
+            if (chunk.empty())
+            {
+                call_handler(stream, on_write, nullptr);
+                return;
+            }
+
+            auto head = make_header(*stream) + chunk::make_prefix(chunk.size());
+            std::string_view const tail{chunk::line_end, sizeof(chunk::line_end) - 1};
+            auto on_written = [self = shared_from_this(), stream, func = on_write] (boost::system::error_code const &ec)
+                {
+                    try
+                    {
+                        if (ec)
+                        {
+                            throw exception::server{"[nanorpc::http::detail::server::session::write_chunk] "
+                                    "Failed to write the stream. " + ec.message()};
+                        }
+
+                        self->call_handler(stream, func, nullptr);
+                    }
+                    catch (...)
+                    {
+                        self->call_handler(stream, func, std::current_exception());
+                    }
+                };
+
+            push_write(stream, {std::move(head), std::move(chunk), tail, std::move(on_written)});
+        }
+        catch (...)
+        {
+            call_handler(stream, on_write, std::current_exception());
+        }
+    }
+
+    // The stream is ended by the last chunk, the next request is read after it.
+    void end_stream(stream_ptr const &stream, std::exception_ptr error) noexcept
+    {
+        if (std::exchange(stream->ended, true))
+            return;
+
+        leave_stream(error);
+
+        try
+        {
+            if (!error)
+            {
+                std::string_view const tail{chunk::last, sizeof(chunk::last) - 1};
+                push_write(stream, {make_header(*stream), {}, tail,
+                        [self = shared_from_this(), stream] (boost::system::error_code const &ec)
+                        {
+                            // The rest of the request not taken by the handler would be read as the next one.
+                            if (ec || !stream->keep_alive || !stream->parser->is_done())
+                            {
+                                self->close();
+                                return;
+                            }
+
+                            self->read();
+                        }
+                    });
+
+                return;
+            }
+
+            utility::handle_error<exception::server>(get_error_source(), error,
+                    "[nanorpc::http::detail::server::session::end_stream] ",
+                    "Failed to handle stream.");
+
+            if (stream->header_sent)
+            {
+                close();
+                return;
+            }
+
+            response_type response{boost::beast::http::status::internal_server_error, stream->version};
+            response.set(boost::beast::http::field::server, constants::server_name);
+            response.set(boost::beast::http::field::content_type, constants::content_type);
+            response.keep_alive(false);
+            response.body() = "An error occurred: \"Handling error.\"";
+            response.prepare_payload();
+
+            std::ostringstream out;
+            out << response;
+            push_write(stream, {out.str(), {}, {},
+                    [self = shared_from_this()] (boost::system::error_code const &) { self->close(); }
+                });
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::server>(get_error_source(), e,
+                    "[nanorpc::http::detail::server::session::end_stream] ",
+                    "Failed to end stream.");
+            close();
+        }
+    }
+
+    std::string make_header(stream_type &stream)
+    {
+        if (std::exchange(stream.header_sent, true))
+            return {};
+
+        boost::beast::http::response<boost::beast::http::empty_body> response{boost::beast::http::status::ok, stream.version};
+        response.set(boost::beast::http::field::server, constants::server_name);
+        response.set(boost::beast::http::field::content_type, constants::content_type);
+        response.keep_alive(stream.keep_alive);
+        response.chunked(true);
+
+        std::ostringstream out;
+        out << response.base();
+        return out.str();
+    }
+
+    void push_write(stream_ptr const &stream, stream_write write)
+    {
+        stream->writes.push_back(std::move(write));
+        if (stream->writes.size() == 1)
+            write_next(stream);
+    }
+
+    // The failed write fails the ones queued after it.
+    void write_next(stream_ptr const &stream)
+    {
+        auto const &write = stream->writes.front();
+        write_stream({boost::asio::buffer(write.head), boost::asio::buffer(write.chunk),
+                    boost::asio::buffer(write.tail.data(), write.tail.size())},
+                [self = shared_from_this(), stream] (boost::system::error_code const &ec)
+                {
+                    auto &writes = stream->writes;
+                    auto done = std::move(writes.front().on_write);
+                    writes.pop_front();
+
+                    if (ec)
+                    {
+                        auto failed = std::move(writes);
+                        writes.clear();
+                        done(ec);
+                        for (auto &i : failed)
+                            i.on_write(ec);
+                        return;
+                    }
+
+                    if (!writes.empty())
+                        self->write_next(stream);
+
+                    done(ec);
+                }
             );
     }
 
     void handle_request(request_ptr req)
     {
         auto const target = req->target().to_string();
-        auto const need_eof = req->need_eof();
+        auto const keep_alive = req->keep_alive() && !req->need_eof();
 
-        auto reply = [self = shared_from_this()] (auto resp)
+        auto reply = [self = shared_from_this(), keep_alive] (auto resp)
             {
                 auto response = std::make_shared<response_type>(std::move(resp));
 
-                auto on_write = [self] (boost::system::error_code const &ec)
+                auto on_write = [self, keep_alive] (boost::system::error_code const &ec)
                     {
                         if (ec == boost::asio::error::operation_aborted || ec == boost::asio::error::broken_pipe)
                             return;
 
                         if (!ec)
+                        {
+                            if (keep_alive && self->get_socket().is_open())
+                                self->read();
+                            else
+                                self->close();
                             return;
+                        }
 
-                        utility::handle_error<exception::server>(self->error_handler_,
+                        utility::handle_error<exception::server>(self->get_error_source(),
                                 std::make_exception_ptr(std::runtime_error{ec.message()}),
                                 "[nanorpc::http::detail::server::session::on_write] ",
                                 "Failed to write data.");
@@ -218,7 +851,7 @@ private:
             };
 
         auto const ok =
-            [&req](core::type::buffer buffer)
+            [req](core::type::buffer buffer)
             {
                 response_type res{boost::beast::http::status::ok, req->version()};
                 res.set(boost::beast::http::field::server, constants::server_name);
@@ -229,6 +862,15 @@ private:
                 return res;
             };
 
+        auto const no_content =
+            [req]
+            {
+                response_type res{boost::beast::http::status::no_content, req->version()};
+                res.set(boost::beast::http::field::server, constants::server_name);
+                res.keep_alive(req->keep_alive() && !req->need_eof());
+                return res;
+            };
+
         auto const not_found = [&req, &target]
             {
                 response_type res{boost::beast::http::status::not_found, req->version()};
@@ -241,7 +883,7 @@ private:
             };
 
         auto const server_error =
-            [&req](boost::beast::string_view what)
+            [req](boost::beast::string_view what)
             {
                 response_type res{boost::beast::http::status::internal_server_error, req->version()};
                 res.set(boost::beast::http::field::server, constants::server_name);
@@ -270,10 +912,11 @@ private:
             return;
         }
 
-        auto const iter = executors_.find(target);
-        if (iter == end(executors_))
+        auto const &executors = handlers_.executors;
+        auto const iter = executors.find(target);
+        if (iter == end(executors))
         {
-            utility::handle_error<exception::server>(error_handler_,
+            utility::handle_error<exception::server>(get_error_source(),
                     "[nanorpc::http::detail::server::session::handle_request] ",
                     "Resource \"", target, "\" not found.");
 
@@ -285,7 +928,7 @@ private:
         auto &executor = iter->second;
         if (!executor)
         {
-            utility::handle_error<exception::server>(error_handler_,
+            utility::handle_error<exception::server>(get_error_source(),
                     "[nanorpc::http::detail::server::session::handle_request] ",
                     "No exicutor.");
 
@@ -295,10 +938,10 @@ private:
         }
 
 
-        auto const &content = req->body();
+        auto &content = req->body();
         if (content.empty())
         {
-            utility::handle_error<exception::server>(error_handler_,
+            utility::handle_error<exception::server>(get_error_source(),
                     "[nanorpc::http::detail::server::session::handle_request] ",
                     "The request has no a content.");
 
@@ -308,19 +951,56 @@ private:
         }
 
 
+        // The executor can complete the request on another thread, so the response
+        // is written on the strand of the session.
+        // An empty response (e.g. of a one-way call) is sent as 204 without a body.
+        auto on_executed = [self = shared_from_this(), reply, ok, no_content, server_error]
+            (std::exception_ptr error, core::type::buffer response_data)
+            {
+                boost::asio::post(self->get_strand(),
+                        [self, reply, ok, no_content, server_error, error, data = std::move(response_data)] () mutable
+                        {
+                            if (!error)
+                            {
+                                reply(data.empty() ? no_content() : ok(std::move(data)));
+                                return;
+                            }
+
+                            reply(server_error("Handling error."));
+
+                            utility::handle_error<exception::server>(self->get_error_source(), error,
+                                    "[nanorpc::http::detail::server::session::handle_request] ",
+                                    "Failed to handler request.");
+                        }
+                    );
+            };
+
+        // The handler pool takes the method of the call from the header of the request.
+        core::type::buffer request_data{begin(content), end(content)};
+        core::detail::header request_header;
+        auto const method = request_header.read(request_data) ? request_header.id : core::type::id{};
+
+        auto execute = [&executor, data = std::move(request_data), on_executed] () mutable
+            {
+                try
+                {
+                    executor(std::move(data), on_executed);
+                }
+                catch (...)
+                {
+                    on_executed(std::current_exception(), {});
+                }
+            };
+
         try
         {
-            auto response_data = executor({begin(content), end(content)});
-            reply(ok(std::move(response_data)));
-
-            if (need_eof)
-                close();
+            handlers_.handler_pool->execute(method, std::move(execute));
         }
         catch (std::exception const &e)
         {
             reply(server_error("Handling error."));
 
-            utility::handle_error<exception::server>(error_handler_, e,
+            utility::handle_error<exception::server>(get_error_source(), e,
                     "[nanorpc::http::detail::server::session::handle_request] ",
                     "Failed to handler request.");
 
@@ -334,66 +1014,73 @@ class listener final
 {
 public:
     using session_ptr = std::shared_ptr<session>;
-    using session_factory  = std::function<session_ptr (boost::asio::ip::tcp::socket,
-            core::type::executor_map const &, core::type::error_handler const &)>;
+    using session_factory  = std::function<session_ptr (net::socket_type,
+            detail::handlers &, core::error_reporter &)>;
 
-    listener(boost::asio::io_context &context, boost::asio::ip::tcp::endpoint const &endpoint,
+    listener(boost::asio::io_context &context, net::endpoint_type const &endpoint,
             session_factory make_session,
-            core::type::executor_map &executors, core::type::error_handler &error_handler)
+            detail::handlers &handlers, core::error_reporter &error_reporter)
         : make_session_{std::move(make_session)}
-        , executors_{executors}
-        , error_handler_{error_handler}
+        , handlers_{handlers}
+        , error_reporter_{error_reporter}
         , context_{context}
+        , strand_{context_.get_executor()}
         , acceptor_{context_}
         , socket_{context_}
     {
-        boost::system::error_code ec;
-
-        acceptor_.open(endpoint.protocol(), ec);
-        if (ec)
-            throw std::runtime_error{"Failed to open acceptor. Message: " + ec.message()};
-
-        acceptor_.set_option(boost::asio::socket_base::reuse_address{true}, ec);
-        if (ec)
-            throw std::runtime_error{"Failed to set option \"reuse_address\". Message: " + ec.message()};
-
-        acceptor_.bind(endpoint, ec);
-        if (ec)
-            throw std::runtime_error{"Failed to bind acceptor. Message: " + ec.message()};
-
-        acceptor_.listen(boost::asio::socket_base::max_listen_connections, ec);
-        if (ec)
-            throw std::runtime_error{"Failed to start listen. Message: " + ec.message()};
+        net::listen(acceptor_, endpoint);
     }
 
     void run()
     {
-        utility::post(context_, [self = shared_from_this()] { self->accept(); }, error_handler_ );
+        boost::asio::post(strand_, [self = shared_from_this()] { self->accept(); });
+    }
+
+    // The acceptor is closed on the strand of the accepts, so the pending accept is completed
+    // by the error and releases the listener. The workers must be running.
+    void stop()
+    {
+        std::promise<void> closed;
+        auto future = closed.get_future();
+
+        boost::asio::post(strand_, [self = shared_from_this(), &closed]
+                {
+                    boost::system::error_code ec;
+                    self->acceptor_.close(ec);
+                    closed.set_value();
+                }
+            );
+
+        future.wait();
     }
 
 private:
     session_factory make_session_;
-    core::type::executor_map const &executors_;
-    core::type::error_handler const &error_handler_;
+    detail::handlers &handlers_;
+    core::error_reporter &error_reporter_;
 
     boost::asio::io_context &context_;
-    boost::asio::ip::tcp::acceptor acceptor_;
-    boost::asio::ip::tcp::socket socket_;
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    net::acceptor_type acceptor_;
+    net::socket_type socket_;
 
     void accept() noexcept
     {
         try
         {
-            acceptor_.async_accept(socket_,
-                    [self = this] (boost::system::error_code const &ec)
+            acceptor_.async_accept(socket_, boost::asio::bind_executor(strand_,
+                    [self = shared_from_this()] (boost::system::error_code const &ec)
                     {
+                        if (!self->acceptor_.is_open())
+                            return;
+
                         try
                         {
                             if (ec)
                             {
                                 if (ec != boost::asio::error::operation_aborted)
                                 {
-                                    utility::handle_error<exception::server>(self->error_handler_,
+                                    utility::handle_error<exception::server>(self->error_reporter_,
                                             std::make_exception_ptr(std::runtime_error{ec.message()}),
                                             "[nanorpc::http::detail::listener::accept] ",
                                             "Failed to accept connection.");
@@ -402,22 +1089,22 @@ private:
                             else
                             {
                                 self->make_session_(std::move(self->socket_),
-                                        self->executors_, self->error_handler_)->run();
+                                        self->handlers_, self->error_reporter_)->run();
                             }
                         }
                         catch (std::exception const &e)
                         {
-                            utility::handle_error<exception::server>(self->error_handler_, e,
+                            utility::handle_error<exception::server>(self->error_reporter_, e,
                                     "[nanorpc::http::detail::listener::accept] ",
                                     "Failed to process the accept method.");
                         }
-                        utility::post(self->context_, [self] { self->accept(); }, self->error_handler_ );
+                        boost::asio::post(self->strand_, [self] { self->accept(); });
                     }
-                );
+                ));
         }
         catch (std::exception const &e)
         {
-            utility::handle_error<exception::server>(error_handler_, e,
+            utility::handle_error<exception::server>(error_reporter_, e,
                     "[nanorpc::http::detail::listener::accept] ",
                     "Failed to call asynk_accept.");
         }
@@ -432,31 +1119,20 @@ public:
     server& operator = (server const &) = delete;
 
     server(std::string_view address, std::string_view port, std::size_t workers,
-            core::type::executor_map executors, core::type::error_handler error_handler)
-        : executors_{std::move(executors)}
-        , error_handler_{std::move(error_handler)}
+            core::type::async_executor_map executors, core::type::stream_executor_map streams,
+            core::type::async_stream_executor_map async_streams, core::handler_options const &handler_options,
+            core::type::error_handler error_handler)
+        : error_reporter_{std::move(error_handler)}
+        , handlers_{std::move(executors), std::move(streams), std::move(async_streams), handler_options}
         , workers_count_{std::max<int>(1, workers)}
         , context_{workers_count_}
-        , endpoint_{boost::asio::ip::make_address(address),
-                static_cast<unsigned short>(std::stol(port.data()))}
+        , endpoint_{net::make_endpoint(address, port)}
     {
     }
 
     virtual ~server() noexcept
     {
-        if (stopped())
-            return;
-
-        try
-        {
-            stop();
-        }
-        catch (std::exception const &e)
-        {
-            utility::handle_error<exception::server>(error_handler_, e,
-                    "[nanorpc::http::server::~sserver] ",
-                    "Failed to stop server.");
-        }
+        done();
     }
 
     void run()
@@ -465,7 +1141,21 @@ public:
             throw std::runtime_error{"[" + std::string{__func__ } + "] Already running."};
 
         auto factory = std::bind(&server::make_session, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
-        auto new_listener = std::make_shared<listener>(context_, endpoint_, std::move(factory), executors_, error_handler_);
+        auto new_listener = std::make_shared<listener>(context_, endpoint_, std::move(factory), handlers_, error_reporter_);
+
+        handlers_.handler_pool = std::make_unique<core::handler_pool>(handlers_.options,
+                [this] (std::exception_ptr error)
+                {
+                    utility::handle_error<exception::server>(error_reporter_, error,
+                            "[nanorpc::http::server::handler_pool] ",
+                            "Failed to run handler.");
+                }
+            );
+
+        handlers_.streams_stopped = false;
+        if (!handlers_.streams.empty())
+            handlers_.stream_pool = std::make_unique<core::thread_pool>(workers_count_);
+
         new_listener->run();
 
         threads_type workers;
@@ -482,7 +1172,7 @@ public:
                         }
                         catch (std::exception const &e)
                         {
-                            utility::handle_error<exception::server>(self->error_handler_, e,
+                            utility::handle_error<exception::server>(self->error_reporter_, e,
                                     "[nanorpc::http::server::run] ",
                                     "Failed to run server.");
 
@@ -501,7 +1191,9 @@ public:
         if (stopped())
             throw std::runtime_error{"[" + std::string{__func__ } + "] Not runned."};
 
+        listener_->stop();
         listener_.reset();
+        net::remove_unix_file(endpoint_);
         context_.stop();
         for_each(begin(workers_), end(workers_), [&] (std::thread &t)
                 {
@@ -511,7 +1203,7 @@ public:
                     }
                     catch (std::exception const &e)
                     {
-                        utility::handle_error<exception::server>(error_handler_, e,
+                        utility::handle_error<exception::server>(error_reporter_, e,
                                 "[nanorpc::http::server::stop] ",
                                 "Failed to stop server.");
 
@@ -521,6 +1213,12 @@ public:
             );
 
         workers_.clear();
+
+        // The io threads which post the handlers and the streams have been joined.
+        // The handlers in progress complete their calls, the responses are dropped.
+        // The streams wait for the I/O never completed.
+        handlers_.handler_pool.reset();
+        stop_streams();
     }
 
     bool stopped() const noexcept
@@ -531,21 +1229,64 @@ public:
 protected:
     using session_ptr = listener::session_ptr;
 
-    virtual session_ptr make_session(boost::asio::ip::tcp::socket socket,
-            core::type::executor_map const &executors,
-            core::type::error_handler const &error_handler) = 0;
+    // The derived servers stop the server by their own destructors, the workers make
+    // the sessions of the derived ones till they are joined.
+    void done() noexcept
+    {
+        if (stopped())
+            return;
+
+        try
+        {
+            stop();
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::server>(error_reporter_, e,
+                    "[nanorpc::http::server::~sserver] ",
+                    "Failed to stop server.");
+        }
+    }
+
+    virtual session_ptr make_session(net::socket_type socket,
+            detail::handlers &handlers,
+            core::error_reporter &error_reporter) = 0;
 
 private:
     using threads_type = std::vector<std::thread>;
 
-    core::type::executor_map executors_;
-    core::type::error_handler error_handler_;
+    // The reporter is destroyed the last, the workers report the errors till they are joined.
+    core::error_reporter error_reporter_;
+    detail::handlers handlers_;
 
     int workers_count_;
     boost::asio::io_context context_;
-    boost::asio::ip::tcp::endpoint endpoint_;
+    net::endpoint_type endpoint_;
     std::shared_ptr<listener> listener_;
     threads_type workers_;
+
+    // The streams in progress are broken, the ones in the queue are not started.
+    void stop_streams()
+    {
+        std::exception_ptr error;
+        try
+        {
+            throw exception::server{"[nanorpc::http::server::stop] The server has been stopped."};
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock{handlers_.streams_lock};
+            handlers_.streams_stopped = true;
+            for (auto *stream : handlers_.active_streams)
+                stream->abort(error);
+        }
+
+        handlers_.stream_pool.reset();
+    }
 };
 
 }   // namespace
@@ -557,12 +1298,17 @@ class server::impl final
 public:
     using server::server;
 
+    virtual ~impl() noexcept override
+    {
+        done();
+    }
+
 private:
-    virtual session_ptr make_session(boost::asio::ip::tcp::socket socket,
-            core::type::executor_map const &executors,
-            core::type::error_handler const &error_handler) override final
+    virtual session_ptr make_session(detail::net::socket_type socket,
+            detail::handlers &handlers,
+            core::error_reporter &error_reporter) override final
     {
-        return std::make_shared<session>(std::move(socket), executors, error_handler);
+        return std::make_shared<session>(std::move(socket), handlers, error_reporter);
     }
 
     class session final
@@ -579,14 +1325,25 @@ private:
 
         virtual void close(boost::system::error_code &ec) override final
         {
-            get_socket().shutdown(boost::asio::ip::tcp::socket::shutdown_send, ec);
+            get_socket().shutdown(detail::net::socket_type::shutdown_send, ec);
+        }
+
+        virtual void read_header(buffer_ptr buffer, header_parser_ptr parser, on_completed_func on_read) override final
+        {
+            boost::beast::http::async_read_header(get_socket(), *buffer, *parser,
+                    boost::asio::bind_executor(get_strand(),
+                            [func = std::move(on_read), buffer, parser]
+                            (boost::system::error_code const &ec, auto)
+                            { func(ec); }
+                        )
+                    );
         }
 
-        virtual void read(buffer_ptr buffer, request_ptr request, on_completed_func on_read) override final
+        virtual void read(buffer_ptr buffer, request_parser_ptr parser, on_completed_func on_read) override final
         {
-            boost::beast::http::async_read(get_socket(), *buffer, *request,
+            boost::beast::http::async_read(get_socket(), *buffer, *parser,
                     boost::asio::bind_executor(get_strand(),
-                            [func = std::move(on_read), buffer, request]
+                            [func = std::move(on_read), buffer, parser]
                             (boost::system::error_code const &ec, auto)
                             { func(ec); }
                         )
@@ -602,13 +1359,71 @@ private:
                         )
                 );
         }
+
+        virtual void read_stream(buffer_ptr buffer, stream_parser_ptr parser, on_completed_func on_read) override final
+        {
+            boost::beast::http::async_read(get_socket(), *buffer, *parser,
+                    boost::asio::bind_executor(get_strand(),
+                            [func = std::move(on_read), buffer, parser]
+                            (boost::system::error_code const &ec, auto)
+                            { func(ec); }
+                        )
+                    );
+        }
+
+        virtual void write_stream(std::vector<boost::asio::const_buffer> const &buffers,
+                on_completed_func on_write) override final
+        {
+            boost::asio::async_write(get_socket(), buffers,
+                    boost::asio::bind_executor(get_strand(),
+                            [func = std::move(on_write)]
+                            (boost::system::error_code const &ec, auto) { func(ec); }
+                        )
+                );
+        }
     };
 };
 
 server::server(std::string_view address, std::string_view port, std::size_t workers,
         core::type::executor_map executors, core::type::error_handler error_handler)
     : impl_{std::make_shared<impl>(std::move(address), std::move(port), workers,
-            std::move(executors), std::move(error_handler))}
+            detail::to_async(std::move(executors)), core::type::stream_executor_map{},
+            core::type::async_stream_executor_map{}, core::make_handler_options(workers), std::move(error_handler))}
+{
+}
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::async_executor_map executors, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(address), std::move(port), workers,
+            std::move(executors), core::type::stream_executor_map{},
+            core::type::async_stream_executor_map{}, core::make_handler_options(workers), std::move(error_handler))}
+{
+}
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::async_executor_map executors, core::handler_options const &handler_options,
+        core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(address), std::move(port), workers,
+            std::move(executors), core::type::stream_executor_map{},
+            core::type::async_stream_executor_map{}, handler_options, std::move(error_handler))}
+{
+}
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::async_executor_map executors, core::type::stream_executor_map streams,
+        core::handler_options const &handler_options, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(address), std::move(port), workers,
+            std::move(executors), std::move(streams), core::type::async_stream_executor_map{},
+            handler_options, std::move(error_handler))}
+{
+}
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::async_executor_map executors, core::type::async_stream_executor_map streams,
+        core::handler_options const &handler_options, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(address), std::move(port), workers,
+            std::move(executors), core::type::stream_executor_map{}, std::move(streams),
+            handler_options, std::move(error_handler))}
 {
 }
 
@@ -643,29 +1458,37 @@ class server::impl final
 {
 public:
     impl(boost::asio::ssl::context ssl_context, std::string_view address, std::string_view port,
-            std::size_t workers, core::type::executor_map executors, core::type::error_handler error_handler)
-        : server{std::move(address), std::move(port), workers, std::map(executors), std::move(error_handler)}
+            std::size_t workers, core::type::async_executor_map executors, core::type::stream_executor_map streams,
+            core::type::async_stream_executor_map async_streams, core::handler_options const &handler_options,
+            core::type::error_handler error_handler)
+        : server{std::move(address), std::move(port), workers, std::move(executors), std::move(streams),
+                std::move(async_streams), handler_options, std::move(error_handler)}
         , ssl_context_{std::move(ssl_context)}
     {
     }
 
+    virtual ~impl() noexcept override
+    {
+        done();
+    }
+
 private:
     boost::asio::ssl::context ssl_context_;
 
-    virtual session_ptr make_session(boost::asio::ip::tcp::socket socket,
-            core::type::executor_map const &executors,
-            core::type::error_handler const &error_handler) override final
+    virtual session_ptr make_session(http::detail::net::socket_type socket,
+            http::detail::handlers &handlers,
+            core::error_reporter &error_reporter) override final
     {
-        return std::make_shared<session>(ssl_context_, std::move(socket), executors, error_handler);
+        return std::make_shared<session>(ssl_context_, std::move(socket), handlers, error_reporter);
     }
 
     class session final
         : public http::detail::session
     {
     public:
-        session(boost::asio::ssl::context &ssl_context, boost::asio::ip::tcp::socket socket,
-                core::type::executor_map const &executors, core::type::error_handler const &error_handler)
-            : http::detail::session{std::move(socket), executors, error_handler}
+        session(boost::asio::ssl::context &ssl_context, http::detail::net::socket_type socket,
+                http::detail::handlers &handlers, core::error_reporter &error_reporter)
+            : http::detail::session{std::move(socket), handlers, error_reporter}
             , stream_{std::in_place, get_socket(), ssl_context}
         {
         }
@@ -676,7 +1499,7 @@ private:
         }
 
     private:
-        std::optional<boost::asio::ssl::stream<boost::asio::ip::tcp::socket&>> stream_;
+        std::optional<boost::asio::ssl::stream<http::detail::net::socket_type&>> stream_;
 
         virtual void handshake(on_completed_func on_handshake) override final
         {
@@ -687,15 +1510,26 @@ private:
         virtual void close(boost::system::error_code &ec) override final
         {
             boost::ignore_unused(ec);
-            stream_->async_shutdown([] (boost::system::error_code const &ec)
+            stream_->async_shutdown([self = shared_from_this()] (boost::system::error_code const &ec)
                     { boost::ignore_unused(ec); } );
         }
 
-        virtual void read(buffer_ptr buffer, request_ptr request, on_completed_func on_read) override final
+        virtual void read_header(buffer_ptr buffer, header_parser_ptr parser, on_completed_func on_read) override final
         {
-            boost::beast::http::async_read(*stream_, *buffer, *request,
+            boost::beast::http::async_read_header(*stream_, *buffer, *parser,
                     boost::asio::bind_executor(get_strand(),
-                            [func = std::move(on_read), buffer, request]
+                            [func = std::move(on_read), buffer, parser]
+                            (boost::system::error_code const &ec, auto)
+                            { func(ec); }
+                        )
+                    );
+        }
+
+        virtual void read(buffer_ptr buffer, request_parser_ptr parser, on_completed_func on_read) override final
+        {
+            boost::beast::http::async_read(*stream_, *buffer, *parser,
+                    boost::asio::bind_executor(get_strand(),
+                            [func = std::move(on_read), buffer, parser]
                             (boost::system::error_code const &ec, auto)
                             { func(ec); }
                         )
@@ -711,13 +1545,71 @@ private:
                         )
                 );
         }
+
+        virtual void read_stream(buffer_ptr buffer, stream_parser_ptr parser, on_completed_func on_read) override final
+        {
+            boost::beast::http::async_read(*stream_, *buffer, *parser,
+                    boost::asio::bind_executor(get_strand(),
+                            [func = std::move(on_read), buffer, parser]
+                            (boost::system::error_code const &ec, auto)
+                            { func(ec); }
+                        )
+                    );
+        }
+
+        virtual void write_stream(std::vector<boost::asio::const_buffer> const &buffers,
+                on_completed_func on_write) override final
+        {
+            boost::asio::async_write(*stream_, buffers,
+                    boost::asio::bind_executor(get_strand(),
+                            [func = std::move(on_write)]
+                            (boost::system::error_code const &ec, auto) { func(ec); }
+                        )
+                );
+        }
     };
 };
 
 server::server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
         std::size_t workers, core::type::executor_map executors, core::type::error_handler error_handler)
     : impl_{std::make_shared<impl>(std::move(context), std::move(address), std::move(port),
-            workers, std::move(executors), std::move(error_handler))}
+            workers, http::detail::to_async(std::move(executors)), core::type::stream_executor_map{},
+            core::type::async_stream_executor_map{}, core::make_handler_options(workers), std::move(error_handler))}
+{
+}
+
+server::server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+        std::size_t workers, core::type::async_executor_map executors, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(context), std::move(address), std::move(port),
+            workers, std::move(executors), core::type::stream_executor_map{},
+            core::type::async_stream_executor_map{}, core::make_handler_options(workers), std::move(error_handler))}
+{
+}
+
+server::server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+        std::size_t workers, core::type::async_executor_map executors, core::handler_options const &handler_options,
+        core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(context), std::move(address), std::move(port),
+            workers, std::move(executors), core::type::stream_executor_map{},
+            core::type::async_stream_executor_map{}, handler_options, std::move(error_handler))}
+{
+}
+
+server::server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+        std::size_t workers, core::type::async_executor_map executors, core::type::stream_executor_map streams,
+        core::handler_options const &handler_options, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(context), std::move(address), std::move(port),
+            workers, std::move(executors), std::move(streams), core::type::async_stream_executor_map{},
+            handler_options, std::move(error_handler))}
+{
+}
+
+server::server(boost::asio::ssl::context context, std::string_view address, std::string_view port,
+        std::size_t workers, core::type::async_executor_map executors, core::type::async_stream_executor_map streams,
+        core::handler_options const &handler_options, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(context), std::move(address), std::move(port),
+            workers, std::move(executors), core::type::stream_executor_map{}, std::move(streams),
+            handler_options, std::move(error_handler))}
 {
 }
 
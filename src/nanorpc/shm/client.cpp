@@ -0,0 +1,597 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+// POSIX
+#include <signal.h>
+#include <unistd.h>
+
+// BOOST
+#include <boost/asio.hpp>
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/error_reporter.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/stop_token.h"
+#include "nanorpc/shm/client.h"
+
+// THIS
+#include "../http/detail/utility.h"
+#include "../tcp/detail/frame.h"
+#include "detail/segment.h"
+
+namespace nanorpc::shm
+{
+
+namespace utility = http::detail::utility;
+using tcp::detail::frame_header;
+
+// The requests are written by the calling threads one at a time, the responses are read by
+// the reading thread of the attached segment. A synchronous call waits for its response by itself,
+// the reading thread hands it over and wakes the caller up. The only thread of the client runs
+// the timers of the asynchronous calls with a budget and their completions, so the reading thread
+// is never held by them.
+class client::impl final
+    : public std::enable_shared_from_this<impl>
+{
+public:
+    impl(std::string_view name, options const &opts, core::type::error_handler error_handler)
+        : error_reporter_{std::move(error_handler)}
+        , name_{name}
+        , options_{opts}
+    {
+    }
+
+    ~impl() noexcept
+    {
+        try
+        {
+            if (stopped())
+                return;
+
+            stop();
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::client>(error_reporter_, e,
+                    "[nanorpc::shm::client::~client] Failed to done.");
+        }
+    }
+
+    void init_executors()
+    {
+        async_executor_ = [this_ = std::weak_ptr{shared_from_this()}]
+            (core::type::buffer request, core::type::completion done)
+            {
+                auto self = this_.lock();
+                if (!self)
+                {
+                    done(std::make_exception_ptr(exception::client{"No owner object."}), {});
+                    return;
+                }
+
+                if (self->stopped())
+                {
+                    done(std::make_exception_ptr(exception::client{"The client was not started."}), {});
+                    return;
+                }
+
+                auto token = get_stop_token(request);
+                self->send(std::move(request), call{std::move(done), nullptr, nullptr}, token);
+            };
+
+        executor_ = [this_ = std::weak_ptr{shared_from_this()}] (core::type::buffer request)
+            {
+                auto self = this_.lock();
+                if (!self)
+                    throw exception::client{"[nanorpc::shm::client::executor] No owner object."};
+
+                if (self->stopped())
+                    throw exception::client{"[nanorpc::shm::client::executor] The client was not started."};
+
+                auto const token = get_stop_token(request);
+                auto slot = std::make_shared<sync_slot>();
+                auto const id = self->send(std::move(request), call{nullptr, nullptr, slot}, token);
+
+                return self->wait(*slot, id, token);
+            };
+    }
+
+    void run()
+    {
+        if (!stopped())
+            throw exception::client{"Already running."};
+
+        timers_.restart();
+        work_guard_.emplace(boost::asio::make_work_guard(timers_));
+
+        timer_thread_ = std::thread{[self = this]
+                {
+                    try
+                    {
+                        self->timers_.run();
+                    }
+                    catch (std::exception const &e)
+                    {
+                        utility::handle_error<exception::client>(self->error_reporter_, e,
+                                "[nanorpc::shm::client::run] Failed to run.");
+                        std::exit(EXIT_FAILURE);
+                    }
+                }
+            };
+    }
+
+    // The calls in flight fail, the segment is left to the next client.
+    void stop()
+    {
+        if (stopped())
+            throw exception::client{"Not runned."};
+
+        {
+            std::lock_guard lock{writer_lock_};
+            detach();
+        }
+
+        fail_all(make_error("The client was stopped."), false);
+
+        // The completions posted before are called before the thread ends.
+        work_guard_.reset();
+        boost::asio::post(timers_, [this] { timers_.stop(); });
+        timer_thread_.join();
+    }
+
+    bool stopped() const noexcept
+    {
+        return !timer_thread_.joinable();
+    }
+
+    core::type::executor const& get_executor() const
+    {
+        return executor_;
+    }
+
+    core::type::async_executor const& get_async_executor() const
+    {
+        return async_executor_;
+    }
+
+private:
+    using work_guard_type = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    // The response of a synchronous call. The reading thread fills it and wakes the caller up
+    // only if it sleeps.
+    struct sync_slot final
+    {
+        std::atomic<std::uint32_t> ready{0};
+        std::atomic<std::uint32_t> waiting{0};
+        std::exception_ptr error;
+        core::type::buffer response;
+    };
+
+    // The asynchronous call has the completion, the synchronous one has the slot.
+    struct call final
+    {
+        core::type::completion done;
+        std::shared_ptr<boost::asio::steady_timer> timer;
+        std::shared_ptr<sync_slot> slot;
+    };
+
+    // The segment of the running server. The reading thread gives up when the server
+    // has been stopped or the segment is being detached.
+    struct attachment final
+    {
+        std::unique_ptr<detail::segment> segment;
+        std::atomic<bool> stopping{false};
+        std::optional<detail::ring> requests;
+        std::optional<detail::ring> responses;
+        std::thread reader;
+
+        bool open() noexcept
+        {
+            return segment->get_header().state.load(std::memory_order_acquire) == detail::segment_header::state_open;
+        }
+    };
+
+    // How long the attached client waits for the server to empty the rings.
+    static constexpr std::chrono::seconds attach_timeout{5};
+
+    // The workers report the errors till they are joined.
+    core::error_reporter error_reporter_;
+    std::string name_;
+    options options_;
+
+    core::type::executor executor_;
+    core::type::async_executor async_executor_;
+
+    // The requests are written under the lock, the segment is attached and detached under it as well.
+    std::mutex writer_lock_;
+    std::unique_ptr<attachment> attachment_;
+    // The ids are unique among the clients of the segment, so a new client doesn't take
+    // the responses to the calls of the previous one for its own.
+    std::uint64_t last_id_ = static_cast<std::uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+
+    std::mutex calls_lock_;
+    std::map<std::uint64_t, call> calls_;
+
+    boost::asio::io_context timers_;
+    std::optional<work_guard_type> work_guard_;
+    std::thread timer_thread_;
+
+    static std::exception_ptr make_timeout()
+    {
+        return std::make_exception_ptr(core::exception::timeout{"[nanorpc::shm::client::executor] Timeout."});
+    }
+
+    static std::exception_ptr make_error(std::string const &message)
+    {
+        return std::make_exception_ptr(exception::client{"[nanorpc::shm::client::executor] " + message});
+    }
+
+    static core::stop_token get_stop_token(core::type::buffer const &request)
+    {
+        core::detail::header request_header;
+        return request_header.read(request) ?
+                core::stop_token::from_budget(request_header.budget) : core::stop_token{};
+    }
+
+    // Returns the id of the call, 0 - the call has been completed at once.
+    std::uint64_t send(core::type::buffer request, call entry, core::stop_token const &token)
+    {
+        if (token.stop_requested())
+        {
+            finish(entry, make_timeout(), {});
+            return 0;
+        }
+
+        std::unique_lock lock{writer_lock_};
+
+        if (!attachment_ || !attachment_->open())
+        {
+            try
+            {
+                attach();
+            }
+            catch (std::exception const &e)
+            {
+                lock.unlock();
+                finish(entry, make_error(e.what()), {});
+                return 0;
+            }
+        }
+
+        auto const id = ++last_id_;
+
+        {
+            // The synchronous caller keeps its deadline by itself.
+            if (token.stop_possible() && !entry.slot)
+            {
+                entry.timer = std::make_shared<boost::asio::steady_timer>(timers_, *token.deadline());
+                entry.timer->async_wait([this_ = std::weak_ptr{shared_from_this()}, id] (boost::system::error_code const &ec)
+                        {
+                            auto self = this_.lock();
+                            if (!ec && self)
+                                self->complete(id, make_timeout(), {});
+                        }
+                    );
+            }
+
+            std::lock_guard calls_lock{calls_lock_};
+            calls_.emplace(id, std::move(entry));
+        }
+
+        frame_header header;
+        header.message_size = static_cast<std::uint32_t>(request.size());
+        header.status = frame_header::status_good;
+        header.id = id;
+        auto const buffer = header.write();
+
+        auto &item = *attachment_;
+        auto const written = item.requests->write(buffer.data(), buffer.size()) &&
+                item.requests->write(request.data(), request.size());
+
+        // The reading thread fails the calls it has found when the server is stopped,
+        // the ones registered after that are failed here.
+        auto const open = item.open();
+        lock.unlock();
+
+        if (!written || !open)
+            complete(id, make_error("The server \"" + name_ + "\" has been stopped."), {});
+
+        return id;
+    }
+
+    // The caller spins for a while as the rings do and then sleeps till it's woken up by the reading
+    // thread or its deadline. The expired call is taken back unless it's being completed.
+    core::type::buffer wait(sync_slot &slot, std::uint64_t id, core::stop_token const &token)
+    {
+        static auto const single_core = std::thread::hardware_concurrency() == 1;
+
+        auto const spin_deadline = std::chrono::steady_clock::now() + options_.spin;
+        for (std::uint32_t i = 1 ; !slot.ready.load(std::memory_order_acquire) &&
+                (options_.busy_poll || !single_core) ; ++i)
+        {
+            if (i % 64)
+            {
+                detail::cpu_relax();
+                continue;
+            }
+
+            if (token.stop_requested() || (!options_.busy_poll && std::chrono::steady_clock::now() >= spin_deadline))
+                break;
+
+            std::this_thread::yield();
+        }
+
+        while (!slot.ready.load(std::memory_order_acquire))
+        {
+            std::chrono::nanoseconds timeout = std::chrono::milliseconds{100};
+            if (auto const deadline = token.deadline())
+            {
+                auto const left = *deadline - core::stop_token::clock_type::now();
+                if (left <= left.zero() && abandon(id))
+                    std::rethrow_exception(make_timeout());
+                timeout = std::max<std::chrono::nanoseconds>(std::min<std::chrono::nanoseconds>(timeout, left),
+                        std::chrono::microseconds{1});
+            }
+
+            slot.waiting.store(1);
+            if (!slot.ready.load())
+                detail::futex_wait(slot.ready, 0, timeout);
+            slot.waiting.store(0);
+        }
+
+        if (slot.error)
+            std::rethrow_exception(slot.error);
+
+        return std::move(slot.response);
+    }
+
+    bool abandon(std::uint64_t id)
+    {
+        std::lock_guard lock{calls_lock_};
+        return calls_.erase(id) != 0;
+    }
+
+    // The synchronous caller is woken up, the completion is called by the current thread.
+    static void finish(call &item, std::exception_ptr error, core::type::buffer response)
+    {
+        if (!item.slot)
+        {
+            item.done(std::move(error), std::move(response));
+            return;
+        }
+
+        auto &slot = *item.slot;
+        slot.error = std::move(error);
+        slot.response = std::move(response);
+        slot.ready.store(1);
+        if (slot.waiting.load())
+            detail::futex_wake(slot.ready);
+    }
+
+    void attach()
+    {
+        detach();
+
+        auto item = std::make_unique<attachment>();
+        item->segment = detail::segment::open(name_);
+
+        auto &header = item->segment->get_header();
+        auto const pid = static_cast<std::uint32_t>(::getpid());
+
+        // The slot of a process which doesn't exist any more is taken over.
+        std::uint32_t owner = 0;
+        if (!header.client.compare_exchange_strong(owner, pid) &&
+                !(::kill(static_cast<pid_t>(owner), 0) == -1 && errno == ESRCH &&
+                        header.client.compare_exchange_strong(owner, pid)))
+        {
+            throw std::runtime_error{"The segment \"" + item->segment->get_name() + "\" is used by another client."};
+        }
+
+        // The rings of the previous generation are given up by the server.
+        auto const generation = header.generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+        item->requests.emplace(header.requests, item->segment->get_requests(), header.capacity, options_,
+                header.state, detail::segment_header::state_open, header.generation, generation, item->stopping);
+        item->responses.emplace(header.responses, item->segment->get_responses(), header.capacity, options_,
+                header.state, detail::segment_header::state_open, header.generation, generation, item->stopping);
+
+        item->requests->wake_up();
+        item->responses->wake_up();
+
+        auto const deadline = std::chrono::steady_clock::now() + attach_timeout;
+        for (auto acknowledged = header.acknowledged.load(std::memory_order_acquire) ; acknowledged != generation ;
+                acknowledged = header.acknowledged.load(std::memory_order_acquire))
+        {
+            if (!item->open() || std::chrono::steady_clock::now() >= deadline)
+            {
+                owner = pid;
+                header.client.compare_exchange_strong(owner, 0);
+                throw std::runtime_error{"The server of the segment \"" + item->segment->get_name() +
+                        "\" doesn't respond."};
+            }
+
+            detail::futex_wait(header.acknowledged, acknowledged);
+        }
+
+        item->reader = std::thread{[self = this, ptr = item.get()] { self->read(*ptr); }};
+        attachment_ = std::move(item);
+    }
+
+    void detach() noexcept
+    {
+        if (!attachment_)
+            return;
+
+        attachment_->stopping = true;
+        attachment_->responses->wake_up();
+        attachment_->reader.join();
+        auto owner = static_cast<std::uint32_t>(::getpid());
+        attachment_->segment->get_header().client.compare_exchange_strong(owner, 0);
+        attachment_.reset();
+    }
+
+    void read(attachment &item) noexcept
+    {
+        for (;;)
+        {
+            frame_header::buffer_type buffer;
+            if (!item.responses->read(buffer.data(), buffer.size()))
+                break;
+
+            frame_header header;
+            header.read(buffer);
+
+            if (header.message_size > frame_header::max_message_size)
+            {
+                utility::handle_error<exception::client>({error_reporter_, name_},
+                        "[nanorpc::shm::client::read] ",
+                        "The response is too large.");
+                break;
+            }
+
+            core::type::buffer message(header.message_size);
+            if (!item.responses->read(message.data(), message.size()))
+                break;
+
+            if (header.status == frame_header::status_good)
+            {
+                complete(header.id, nullptr, std::move(message));
+            }
+            else
+            {
+                complete(header.id, make_error("The server has failed. " +
+                        std::string{std::begin(message), std::end(message)}), {});
+            }
+        }
+
+        if (!item.stopping)
+            fail_all(make_error("The server \"" + name_ + "\" has been stopped."));
+    }
+
+    void complete(std::uint64_t id, std::exception_ptr error, core::type::buffer response)
+    {
+        call item;
+
+        {
+            std::lock_guard lock{calls_lock_};
+            auto const iter = calls_.find(id);
+            if (iter == std::end(calls_))
+                return;
+
+            item = std::move(iter->second);
+            calls_.erase(iter);
+        }
+
+        if (item.slot)
+        {
+            finish(item, std::move(error), std::move(response));
+            return;
+        }
+
+        boost::asio::post(timers_, [item = std::move(item), error = std::move(error),
+                response = std::move(response)] () mutable
+                {
+                    if (item.timer)
+                        item.timer->cancel();
+                    item.done(std::move(error), std::move(response));
+                }
+            );
+    }
+
+    // The stopping client completes the calls by itself, its thread is going to be stopped.
+    void fail_all(std::exception_ptr error, bool post = true)
+    {
+        std::map<std::uint64_t, call> calls;
+
+        {
+            std::lock_guard lock{calls_lock_};
+            std::swap(calls, calls_);
+        }
+
+        for (auto &i : calls)
+        {
+            if (i.second.slot)
+            {
+                finish(i.second, error, {});
+                continue;
+            }
+
+            if (post)
+            {
+                boost::asio::post(timers_, [item = std::move(i.second), error]
+                        {
+                            if (item.timer)
+                                item.timer->cancel();
+                            item.done(error, {});
+                        }
+                    );
+                continue;
+            }
+
+            if (i.second.timer)
+                boost::asio::post(timers_, [timer = std::move(i.second.timer)] { timer->cancel(); });
+            finish(i.second, error, {});
+        }
+    }
+};
+
+client::client(std::string_view name, options const &opts, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(name), opts, std::move(error_handler))}
+{
+    impl_->init_executors();
+}
+
+client::~client() noexcept
+{
+    impl_.reset();
+}
+
+void client::run()
+{
+    impl_->run();
+}
+
+void client::stop()
+{
+    impl_->stop();
+}
+
+bool client::stopped() const noexcept
+{
+    return impl_->stopped();
+}
+
+core::type::executor const& client::get_executor() const
+{
+    return impl_->get_executor();
+}
+
+core::type::async_executor const& client::get_async_executor() const
+{
+    return impl_->get_async_executor();
+}
+
+}   // namespace nanorpc::shm
@@ -0,0 +1,281 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_SHM_DETAIL_RING_H__
+#define __NANO_RPC_SHM_DETAIL_RING_H__
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#ifdef __linux__
+
+// LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#endif  // !__linux__
+
+// NANORPC
+#include "nanorpc/shm/options.h"
+
+namespace nanorpc::shm::detail
+{
+
+inline constexpr std::size_t cache_line_size = 64;
+
+// The atomics are shared by the processes, so they must not have the locks inside.
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+        std::atomic<std::uint32_t>::is_always_lock_free, "The atomics must be lock-free.");
+
+// The control block of a ring in the shared memory. The positions only grow,
+// the offset in the data is the position modulo the capacity.
+struct ring_control final
+{
+    // The read position, it's changed by the reader only.
+    alignas(cache_line_size) std::atomic<std::uint64_t> head;
+    // The write position, it's changed by the writer only.
+    alignas(cache_line_size) std::atomic<std::uint64_t> tail;
+
+    // The futex words and the counts of the sleeping threads: the reader sleeps
+    // till the data are written, the writer sleeps till the space is freed.
+    alignas(cache_line_size) std::atomic<std::uint32_t> data_signal;
+    std::atomic<std::uint32_t> data_waiters;
+    alignas(cache_line_size) std::atomic<std::uint32_t> space_signal;
+    std::atomic<std::uint32_t> space_waiters;
+};
+
+// The ring is emptied for the next client. Neither of its sides may use it meanwhile,
+// the waiters left by a client which has died are dropped as well.
+inline void reset(ring_control &control) noexcept
+{
+    control.head.store(0, std::memory_order_relaxed);
+    control.tail.store(0, std::memory_order_relaxed);
+    control.data_waiters.store(0, std::memory_order_relaxed);
+    control.space_waiters.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+// The sleeping thread wakes up now and then by itself to see whether it has been closed,
+// e.g. the process of the other side has died without a word.
+inline void futex_wait(std::atomic<std::uint32_t> &word, std::uint32_t expected,
+        std::chrono::nanoseconds timeout = std::chrono::milliseconds{100}) noexcept
+{
+#ifdef __linux__
+    timespec const span{static_cast<time_t>(timeout.count() / 1000000000), static_cast<long>(timeout.count() % 1000000000)};
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAIT, expected, &span, nullptr, 0);
+#else
+    if (word.load() == expected)
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds{100}));
+#endif  // !__linux__
+}
+
+inline void futex_wake(std::atomic<std::uint32_t> &word) noexcept
+{
+#ifdef __linux__
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    static_cast<void>(word);
+#endif  // !__linux__
+}
+
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// One side of a ring: its writer or its reader, every ring has one of each. The ring is
+// a stream of bytes, so a message bigger than the ring is passed in parts. The waiting
+// side spins for a while and then sleeps on the futex. All the waits give up when the
+// segment is not open any more, the owner of the side has been stopped or another
+// client has been attached to the segment.
+class ring final
+{
+public:
+    ring(ring_control &control, char *data, std::size_t capacity, options const &opts,
+            std::atomic<std::uint32_t> const &segment_state, std::uint32_t open_state,
+            std::atomic<std::uint32_t> const &segment_generation, std::uint32_t generation,
+            std::atomic<bool> const &stopped) noexcept
+        : control_{control}
+        , data_{data}
+        , capacity_{capacity}
+        , options_{opts}
+        , segment_state_{segment_state}
+        , open_state_{open_state}
+        , segment_generation_{segment_generation}
+        , generation_{generation}
+        , stopped_{stopped}
+    {
+    }
+
+    bool write(void const *data, std::size_t size) noexcept
+    {
+        auto const *from = static_cast<char const *>(data);
+
+        while (size)
+        {
+            auto const tail = control_.tail.load(std::memory_order_relaxed);
+            std::uint64_t head = 0;
+
+            auto const has_space = [this, tail, &head]
+                {
+                    head = control_.head.load(std::memory_order_acquire);
+                    return tail - head < capacity_;
+                };
+
+            if (!wait(control_.space_signal, control_.space_waiters, has_space))
+                return false;
+
+            auto const count = std::min<std::uint64_t>(size, capacity_ - (tail - head));
+            auto const offset = tail & (capacity_ - 1);
+            auto const first = std::min<std::uint64_t>(count, capacity_ - offset);
+
+            std::memcpy(data_ + offset, from, first);
+            std::memcpy(data_, from + first, count - first);
+
+            control_.tail.store(tail + count, std::memory_order_release);
+            signal(control_.data_signal, control_.data_waiters);
+
+            from += count;
+            size -= count;
+        }
+
+        return true;
+    }
+
+    bool read(void *data, std::size_t size) noexcept
+    {
+        auto *to = static_cast<char *>(data);
+
+        while (size)
+        {
+            auto const head = control_.head.load(std::memory_order_relaxed);
+            std::uint64_t tail = 0;
+
+            auto const has_data = [this, head, &tail]
+                {
+                    tail = control_.tail.load(std::memory_order_acquire);
+                    return tail != head;
+                };
+
+            if (!wait(control_.data_signal, control_.data_waiters, has_data))
+                return false;
+
+            auto const count = std::min<std::uint64_t>(size, tail - head);
+            auto const offset = head & (capacity_ - 1);
+            auto const first = std::min<std::uint64_t>(count, capacity_ - offset);
+
+            std::memcpy(to, data_ + offset, first);
+            std::memcpy(to + first, data_, count - first);
+
+            control_.head.store(head + count, std::memory_order_release);
+            signal(control_.space_signal, control_.space_waiters);
+
+            to += count;
+            size -= count;
+        }
+
+        return true;
+    }
+
+    // Wakes the both sides up, e.g. to let them see that the segment has been closed.
+    void wake_up() noexcept
+    {
+        control_.data_signal.fetch_add(1);
+        futex_wake(control_.data_signal);
+        control_.space_signal.fetch_add(1);
+        futex_wake(control_.space_signal);
+    }
+
+private:
+    ring_control &control_;
+    char *data_;
+    std::size_t capacity_;
+    options options_;
+    std::atomic<std::uint32_t> const &segment_state_;
+    std::uint32_t open_state_;
+    std::atomic<std::uint32_t> const &segment_generation_;
+    std::uint32_t generation_;
+    std::atomic<bool> const &stopped_;
+
+    bool closed() const noexcept
+    {
+        return segment_state_.load(std::memory_order_acquire) != open_state_ ||
+                segment_generation_.load(std::memory_order_acquire) != generation_ ||
+                stopped_.load(std::memory_order_acquire);
+    }
+
+    // The futex is touched only if the other side sleeps, so the busy sides don't make the syscalls.
+    static void signal(std::atomic<std::uint32_t> &word, std::atomic<std::uint32_t> &waiters) noexcept
+    {
+        word.fetch_add(1);
+        if (waiters.load())
+            futex_wake(word);
+    }
+
+    // The side counts itself as the waiter before it checks the ring for the last time,
+    // so the other side either sees the waiter or has already changed the futex word.
+    template <typename TReady>
+    bool wait(std::atomic<std::uint32_t> &word, std::atomic<std::uint32_t> &waiters, TReady const &ready) const noexcept
+    {
+        if (ready())
+            return true;
+
+        // The spinning side would only take the time of the other one on a single core.
+        static auto const single_core = std::thread::hardware_concurrency() == 1;
+
+        auto const deadline = std::chrono::steady_clock::now() + options_.spin;
+        for (std::uint32_t i = 1 ; options_.busy_poll || !single_core ; ++i)
+        {
+            if (ready())
+                return true;
+            if (closed())
+                return false;
+
+            if (i % 64)
+            {
+                cpu_relax();
+                continue;
+            }
+
+            if (!options_.busy_poll && std::chrono::steady_clock::now() >= deadline)
+                break;
+
+            // The other threads of the core are let run now and then.
+            std::this_thread::yield();
+        }
+
+        for (;;)
+        {
+            auto const value = word.load();
+            waiters.fetch_add(1);
+            if (!ready() && !closed())
+                futex_wait(word, value);
+            waiters.fetch_sub(1);
+
+            if (ready())
+                return true;
+            if (closed())
+                return false;
+        }
+    }
+};
+
+}   // namespace nanorpc::shm::detail
+
+#endif  // !__NANO_RPC_SHM_DETAIL_RING_H__
@@ -0,0 +1,195 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_SHM_DETAIL_SEGMENT_H__
+#define __NANO_RPC_SHM_DETAIL_SEGMENT_H__
+
+// STD
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// THIS
+#include "ring.h"
+
+namespace nanorpc::shm::detail
+{
+
+// The beginning of the segment, the data of the request ring and then the data of the response ring follow it.
+struct segment_header final
+{
+    static constexpr std::uint32_t magic_value = 0x4E525043;   // NRPC
+    static constexpr std::uint32_t version_value = 2;
+
+    static constexpr std::uint32_t state_open = 1;
+    static constexpr std::uint32_t state_closed = 2;
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t capacity;
+
+    // It's set open by the server when the segment is ready and closed by its stop.
+    std::atomic<std::uint32_t> state;
+    // The pid of the attached client, the rings have one writer and one reader.
+    // The slot of a client which has died without a word is taken by the next one.
+    std::atomic<std::uint32_t> client;
+    // Every attached client advances the generation. The server drops the responses
+    // to the previous client, empties the rings and acknowledges the generation,
+    // only then the client writes its requests.
+    std::atomic<std::uint32_t> generation;
+    std::atomic<std::uint32_t> acknowledged;
+
+    ring_control requests;
+    ring_control responses;
+};
+
+// The mapping of the segment. The server creates and removes the segment, the client opens it.
+class segment final
+{
+public:
+    segment(segment const &) = delete;
+    segment& operator = (segment const &) = delete;
+
+    ~segment() noexcept
+    {
+        if (address_ != MAP_FAILED)
+            ::munmap(address_, size_);
+        if (owner_)
+            ::shm_unlink(name_.c_str());
+    }
+
+    // The segment left by a previous server of the name is replaced.
+    static std::unique_ptr<segment> create(std::string_view name, std::size_t capacity)
+    {
+        std::size_t ring_size = cache_line_size;
+        while (ring_size < capacity)
+            ring_size <<= 1;
+
+        std::unique_ptr<segment> item{new segment{make_name(name)}};
+
+        ::shm_unlink(item->name_.c_str());
+        auto const fd = ::shm_open(item->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd == -1)
+            throw std::runtime_error{"Failed to create the segment \"" + item->name_ + "\". " + std::strerror(errno)};
+
+        item->owner_ = true;
+        item->map(fd, sizeof(segment_header) + 2 * ring_size, true);
+
+        auto *header = new (item->address_) segment_header{};
+        header->magic = segment_header::magic_value;
+        header->version = segment_header::version_value;
+        header->capacity = ring_size;
+        header->state.store(segment_header::state_open, std::memory_order_release);
+
+        return item;
+    }
+
+    static std::unique_ptr<segment> open(std::string_view name)
+    {
+        std::unique_ptr<segment> item{new segment{make_name(name)}};
+
+        auto const fd = ::shm_open(item->name_.c_str(), O_RDWR, 0);
+        if (fd == -1)
+            throw std::runtime_error{"Failed to open the segment \"" + item->name_ + "\". " + std::strerror(errno)};
+
+        struct stat info{};
+        if (::fstat(fd, &info) == -1 || static_cast<std::size_t>(info.st_size) < sizeof(segment_header))
+        {
+            ::close(fd);
+            throw std::runtime_error{"The segment \"" + item->name_ + "\" is not ready."};
+        }
+
+        item->map(fd, static_cast<std::size_t>(info.st_size), false);
+
+        auto const &header = item->get_header();
+        if (header.magic != segment_header::magic_value || header.version != segment_header::version_value ||
+                sizeof(segment_header) + 2 * header.capacity != item->size_)
+        {
+            throw std::runtime_error{"The segment \"" + item->name_ + "\" is not of the nanorpc server."};
+        }
+
+        if (header.state.load(std::memory_order_acquire) != segment_header::state_open)
+            throw std::runtime_error{"The server of the segment \"" + item->name_ + "\" is not running."};
+
+        return item;
+    }
+
+    segment_header& get_header() noexcept
+    {
+        return *static_cast<segment_header *>(address_);
+    }
+
+    char* get_requests() noexcept
+    {
+        return static_cast<char *>(address_) + sizeof(segment_header);
+    }
+
+    char* get_responses() noexcept
+    {
+        return get_requests() + get_header().capacity;
+    }
+
+    std::string const& get_name() const noexcept
+    {
+        return name_;
+    }
+
+private:
+    std::string name_;
+    bool owner_ = false;
+    void *address_ = MAP_FAILED;
+    std::size_t size_ = 0;
+
+    explicit segment(std::string name)
+        : name_{std::move(name)}
+    {
+    }
+
+    // The names of the POSIX segments begin with the slash.
+    static std::string make_name(std::string_view name)
+    {
+        if (name.empty())
+            throw std::invalid_argument{"Empty name of the segment."};
+        return name.front() == '/' ? std::string{name} : "/" + std::string{name};
+    }
+
+    void map(int fd, std::size_t size, bool resize)
+    {
+        if (resize && ::ftruncate(fd, static_cast<off_t>(size)) == -1)
+        {
+            auto const message = std::string{std::strerror(errno)};
+            ::close(fd);
+            throw std::runtime_error{"Failed to allocate the segment \"" + name_ + "\". " + message};
+        }
+
+        address_ = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        auto const error = errno;
+        ::close(fd);
+
+        if (address_ == MAP_FAILED)
+            throw std::runtime_error{"Failed to map the segment \"" + name_ + "\". " + std::strerror(error)};
+
+        size_ = size;
+    }
+};
+
+}   // namespace nanorpc::shm::detail
+
+#endif  // !__NANO_RPC_SHM_DETAIL_SEGMENT_H__
@@ -0,0 +1,334 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#include "nanorpc/core/error_reporter.h"
+#include "nanorpc/core/thread_pool.h"
+#include "nanorpc/shm/server.h"
+
+// THIS
+#include "../http/detail/utility.h"
+#include "../tcp/detail/frame.h"
+#include "detail/segment.h"
+
+namespace nanorpc::shm
+{
+
+namespace utility = http::detail::utility;
+using tcp::detail::frame_header;
+
+// The requests are read one after another by the reading thread. The responses are written
+// in the order of completion by the threads which complete the calls, one at a time.
+// The reading thread empties the rings for every new client of the segment.
+class server::impl final
+    : public std::enable_shared_from_this<impl>
+{
+public:
+    impl(std::string_view name, std::size_t workers, core::type::async_executor executor,
+            options const &opts, core::type::error_handler error_handler)
+        : error_reporter_{std::move(error_handler)}
+        , executor_{std::move(executor)}
+        , name_{name}
+        , workers_count_{workers}
+        , options_{opts}
+    {
+    }
+
+    ~impl() noexcept
+    {
+        if (stopped())
+            return;
+
+        try
+        {
+            stop();
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::server>(error_reporter_, e,
+                    "[nanorpc::shm::server::~server] ",
+                    "Failed to stop server.");
+        }
+    }
+
+    void run()
+    {
+        if (!stopped())
+            throw exception::server{"[nanorpc::shm::server::run] Already running."};
+
+        std::unique_ptr<detail::segment> new_segment;
+        try
+        {
+            new_segment = detail::segment::create(name_, options_.capacity);
+        }
+        catch (std::exception const &e)
+        {
+            throw exception::server{"[nanorpc::shm::server::run] " + std::string{e.what()}};
+        }
+
+        stopping_ = false;
+
+        if (workers_count_)
+            pool_ = std::make_unique<core::thread_pool>(workers_count_);
+
+        {
+            std::lock_guard lock{writer_lock_};
+            segment_ = std::move(new_segment);
+            attach(0);
+        }
+
+        reader_ = std::thread{[self = this] { self->read(); }};
+    }
+
+    // The calls in progress are completed by the workers, their responses are dropped.
+    void stop()
+    {
+        if (stopped())
+            throw exception::server{"[nanorpc::shm::server::stop] Not runned."};
+
+        stopping_ = true;
+        segment_->get_header().state.store(detail::segment_header::state_closed, std::memory_order_release);
+
+        {
+            // The rings are replaced by the reading thread under the lock.
+            std::lock_guard lock{writer_lock_};
+            requests_->wake_up();
+            responses_->wake_up();
+        }
+
+        reader_.join();
+        pool_.reset();
+
+        std::lock_guard lock{writer_lock_};
+        segment_.reset();
+    }
+
+    bool stopped() const noexcept
+    {
+        return !reader_.joinable();
+    }
+
+private:
+    // The reporter is destroyed the last, the completions report the errors till the end.
+    core::error_reporter error_reporter_;
+    core::type::async_executor executor_;
+
+    std::string name_;
+    std::size_t workers_count_;
+    options options_;
+
+    std::atomic<bool> stopping_{false};
+    std::optional<detail::ring> requests_;
+    std::optional<detail::ring> responses_;
+
+    // The responses are written under the lock, the segment is removed and the rings
+    // are emptied under it as well.
+    std::mutex writer_lock_;
+    std::unique_ptr<detail::segment> segment_;
+    // The acknowledged generation of the segment, the responses of the others are dropped.
+    std::uint32_t generation_ = 0;
+
+    std::unique_ptr<core::thread_pool> pool_;
+    std::thread reader_;
+
+    void attach(std::uint32_t generation) noexcept
+    {
+        auto &header = segment_->get_header();
+
+        generation_ = generation;
+        requests_.emplace(header.requests, segment_->get_requests(), header.capacity, options_,
+                header.state, detail::segment_header::state_open, header.generation, generation, stopping_);
+        responses_.emplace(header.responses, segment_->get_responses(), header.capacity, options_,
+                header.state, detail::segment_header::state_open, header.generation, generation, stopping_);
+    }
+
+    // The reading and the writing threads have given up the rings of the previous client,
+    // the parts of its frames left in them are dropped.
+    bool reset() noexcept
+    {
+        auto &header = segment_->get_header();
+        if (stopping_ || header.state.load(std::memory_order_acquire) != detail::segment_header::state_open)
+            return false;
+
+        {
+            std::lock_guard lock{writer_lock_};
+            auto const generation = header.generation.load(std::memory_order_acquire);
+            detail::reset(header.requests);
+            detail::reset(header.responses);
+            attach(generation);
+            header.acknowledged.store(generation, std::memory_order_release);
+        }
+
+        detail::futex_wake(header.acknowledged);
+        return true;
+    }
+
+    void read() noexcept
+    {
+        for (;;)
+        {
+            frame_header::buffer_type buffer;
+            if (!requests_->read(buffer.data(), buffer.size()))
+            {
+                if (!reset())
+                    return;
+                continue;
+            }
+
+            frame_header header;
+            header.read(buffer);
+
+            // The stream of the ring can't be read after the broken frame.
+            if (header.message_size > frame_header::max_message_size)
+            {
+                utility::handle_error<exception::server>(error_reporter_,
+                        "[nanorpc::shm::server::read] ",
+                        "The message is too large. The segment is closed.");
+                segment_->get_header().state.store(detail::segment_header::state_closed, std::memory_order_release);
+                responses_->wake_up();
+                return;
+            }
+
+            core::type::buffer message(header.message_size);
+            if (!requests_->read(message.data(), message.size()))
+            {
+                if (!reset())
+                    return;
+                continue;
+            }
+
+            // The reading thread changes the generation only, so it's read without the lock.
+            auto const generation = generation_;
+
+            if (!pool_)
+            {
+                execute(generation, header.id, std::move(message));
+                continue;
+            }
+
+            try
+            {
+                pool_->post([self = shared_from_this(), generation, id = header.id, message = std::move(message)] () mutable
+                        {
+                            self->execute(generation, id, std::move(message));
+                        }
+                    );
+            }
+            catch (std::exception const &e)
+            {
+                utility::handle_error<exception::server>(error_reporter_, e,
+                        "[nanorpc::shm::server::read] ",
+                        "Failed to post request.");
+            }
+        }
+    }
+
+    // The executor can complete the call on another thread.
+    void execute(std::uint32_t generation, std::uint64_t id, core::type::buffer message) noexcept
+    {
+        auto on_executed = [self = shared_from_this(), generation, id] (std::exception_ptr error, core::type::buffer response)
+            {
+                auto status = frame_header::status_good;
+
+                if (error)
+                {
+                    utility::handle_error<exception::server>(self->error_reporter_, error,
+                            "[nanorpc::shm::server::execute] ",
+                            "Failed to handle request.");
+
+                    std::string const text = "Handling error.";
+                    response.assign(std::begin(text), std::end(text));
+                    status = frame_header::status_fail;
+                }
+
+                self->write(generation, id, status, response);
+            };
+
+        try
+        {
+            executor_(std::move(message), std::move(on_executed));
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::server>(error_reporter_, e,
+                    "[nanorpc::shm::server::execute] ",
+                    "Failed to handle request.");
+
+            std::string const text = "Handling error.";
+            write(generation, id, frame_header::status_fail, {std::begin(text), std::end(text)});
+        }
+    }
+
+    void write(std::uint32_t generation, std::uint64_t id, std::uint32_t status,
+            core::type::buffer const &message) noexcept
+    {
+        frame_header header;
+        header.message_size = static_cast<std::uint32_t>(message.size());
+        header.status = status;
+        header.id = id;
+        auto const buffer = header.write();
+
+        std::lock_guard lock{writer_lock_};
+        if (!segment_ || generation != generation_)
+            return;
+
+        // A false means the server is being stopped, the client gets nothing more.
+        if (responses_->write(buffer.data(), buffer.size()))
+            responses_->write(message.data(), message.size());
+    }
+};
+
+server::server(std::string_view name, std::size_t workers,
+        core::type::executor executor, options const &opts, core::type::error_handler error_handler)
+    : server{std::move(name), workers,
+            core::type::async_executor{[func = std::move(executor)] (core::type::buffer request, core::type::completion done)
+                {
+                    done(nullptr, func(std::move(request)));
+                }
+            },
+            opts, std::move(error_handler)}
+{
+}
+
+server::server(std::string_view name, std::size_t workers,
+        core::type::async_executor executor, options const &opts, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(name), workers, std::move(executor), opts, std::move(error_handler))}
+{
+}
+
+server::~server() noexcept
+{
+}
+
+void server::run()
+{
+    impl_->run();
+}
+
+void server::stop()
+{
+    impl_->stop();
+}
+
+bool server::stopped() const noexcept
+{
+    return impl_->stopped();
+}
+
+}   // namespace nanorpc::shm
@@ -0,0 +1,596 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// BOOST
+#include <boost/asio.hpp>
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/error_reporter.h"
+#include "nanorpc/core/exception.h"
+#include "nanorpc/core/stop_token.h"
+#include "nanorpc/tcp/client.h"
+
+// THIS
+#include "../http/detail/socket.h"
+#include "../http/detail/utility.h"
+#include "detail/frame.h"
+
+namespace nanorpc::tcp
+{
+namespace detail
+{
+namespace
+{
+
+namespace net = http::detail::net;
+namespace utility = http::detail::utility;
+
+// One connection to a server for all calls. The calls are sent with the ids of their frames
+// and completed by the responses with the same ids in any order. All state of the connection
+// is changed on its strand; the completions are called there as well.
+class connection final
+    : public std::enable_shared_from_this<connection>
+{
+public:
+    connection(boost::asio::io_context &context, net::endpoints_type endpoints,
+            std::string const &name, core::error_reporter &error_reporter)
+        : context_{context}
+        , endpoints_(std::move(endpoints))
+        , name_{name}
+        , error_reporter_{error_reporter}
+        , strand_{context.get_executor()}
+        , socket_{context}
+    {
+    }
+
+    void send(core::type::buffer request, core::type::completion done, core::stop_token token)
+    {
+        boost::asio::post(strand_,
+                [self = shared_from_this(), request = std::move(request), done = std::move(done), token] () mutable
+                {
+                    self->start(std::move(request), std::move(done), std::move(token));
+                }
+            );
+    }
+
+    // Completes the calls in flight with the error. It's called on the strand or when
+    // the workers have been stopped.
+    void reset(std::exception_ptr error)
+    {
+        ++generation_;
+        state_ = state::closed;
+
+        if (socket_.is_open())
+        {
+            boost::system::error_code ec;
+            socket_.shutdown(net::socket_type::shutdown_both, ec);
+            socket_.close(ec);
+        }
+
+        outbox_.clear();
+        writing_.reset();
+
+        auto calls = std::move(calls_);
+        calls_.clear();
+
+        for (auto &i : calls)
+        {
+            if (i.second.timer)
+                i.second.timer->cancel();
+            i.second.done(error, {});
+        }
+    }
+
+private:
+    using strand_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+    using frames_type = std::vector<frame>;
+
+    enum class state
+    {
+        closed,
+        connecting,
+        open
+    };
+
+    struct call final
+    {
+        core::type::completion done;
+        std::shared_ptr<boost::asio::steady_timer> timer;
+    };
+
+    boost::asio::io_context &context_;
+    net::endpoints_type endpoints_;
+    std::string name_;
+    core::error_reporter &error_reporter_;
+
+    strand_type strand_;
+    net::socket_type socket_;
+    state state_ = state::closed;
+    // The handlers of the previous sockets are ignored.
+    std::uint64_t generation_ = 0;
+
+    std::uint64_t last_id_ = 0;
+    std::map<std::uint64_t, call> calls_;
+
+    frame_header::buffer_type header_;
+    frames_type outbox_;
+    // The frames being written are kept by the write until it's completed.
+    std::shared_ptr<frames_type> writing_;
+
+    static std::exception_ptr make_timeout()
+    {
+        return std::make_exception_ptr(core::exception::timeout{"[nanorpc::tcp::client::executor] Timeout."});
+    }
+
+    static std::exception_ptr make_error(std::string const &message)
+    {
+        return std::make_exception_ptr(exception::client{"[nanorpc::tcp::client::executor] " + message});
+    }
+
+    void start(core::type::buffer request, core::type::completion done, core::stop_token token)
+    {
+        if (token.stop_requested())
+        {
+            done(make_timeout(), {});
+            return;
+        }
+
+        auto const id = ++last_id_;
+
+        call item{std::move(done), nullptr};
+
+        if (token.stop_possible())
+        {
+            item.timer = std::make_shared<boost::asio::steady_timer>(context_, *token.deadline());
+            item.timer->async_wait(boost::asio::bind_executor(strand_,
+                    [self = shared_from_this(), id] (boost::system::error_code const &ec)
+                    {
+                        if (!ec)
+                            self->complete(id, make_timeout(), {});
+                    }
+                ));
+        }
+
+        calls_.emplace(id, std::move(item));
+        outbox_.push_back(make_frame(id, frame_header::status_good, std::move(request)));
+
+        if (state_ == state::closed)
+            connect();
+        else if (state_ == state::open && !writing_)
+            write_outbox();
+    }
+
+    void complete(std::uint64_t id, std::exception_ptr error, core::type::buffer response)
+    {
+        auto const iter = calls_.find(id);
+        if (iter == std::end(calls_))
+            return;
+
+        auto item = std::move(iter->second);
+        calls_.erase(iter);
+
+        if (item.timer)
+            item.timer->cancel();
+
+        item.done(std::move(error), std::move(response));
+    }
+
+    void connect()
+    {
+        state_ = state::connecting;
+        auto const generation = ++generation_;
+        socket_ = net::socket_type{context_};
+
+        boost::asio::async_connect(socket_, std::begin(endpoints_), std::end(endpoints_),
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this(), generation] (boost::system::error_code const &ec, auto)
+                        {
+                            if (generation != self->generation_)
+                                return;
+
+                            if (ec)
+                            {
+                                self->reset(make_error("Failed to connect to \"" + self->name_ + "\". " + ec.message()));
+                                return;
+                            }
+
+                            boost::system::error_code option_ec;
+                            net::set_no_delay(self->socket_, option_ec);
+
+                            self->state_ = state::open;
+                            self->read(generation);
+
+                            if (!self->outbox_.empty())
+                                self->write_outbox();
+                        }
+                    )
+            );
+    }
+
+    void read(std::uint64_t generation)
+    {
+        boost::asio::async_read(socket_, boost::asio::buffer(header_),
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this(), generation] (boost::system::error_code const &ec, std::size_t)
+                        {
+                            if (generation != self->generation_)
+                                return;
+
+                            if (ec)
+                            {
+                                self->on_error(ec);
+                                return;
+                            }
+
+                            frame_header header;
+                            header.read(self->header_);
+                            if (header.message_size > frame_header::max_message_size)
+                            {
+                                self->reset(make_error("The response is too large."));
+                                return;
+                            }
+
+                            self->read_message(generation, header);
+                        }
+                    )
+            );
+    }
+
+    void read_message(std::uint64_t generation, frame_header header)
+    {
+        auto message = std::make_shared<core::type::buffer>(header.message_size);
+
+        boost::asio::async_read(socket_, boost::asio::buffer(*message),
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this(), generation, header, message]
+                        (boost::system::error_code const &ec, std::size_t)
+                        {
+                            if (generation != self->generation_)
+                                return;
+
+                            if (ec)
+                            {
+                                self->on_error(ec);
+                                return;
+                            }
+
+                            self->read(generation);
+
+                            if (header.status == frame_header::status_good)
+                            {
+                                self->complete(header.id, nullptr, std::move(*message));
+                            }
+                            else
+                            {
+                                self->complete(header.id, make_error("The server has failed. " +
+                                        std::string{std::begin(*message), std::end(*message)}), {});
+                            }
+                        }
+                    )
+            );
+    }
+
+    void write_outbox()
+    {
+        writing_ = std::make_shared<frames_type>(std::move(outbox_));
+        outbox_.clear();
+
+        std::vector<boost::asio::const_buffer> buffers;
+        buffers.reserve(writing_->size() * 2);
+        for (auto const &i : *writing_)
+        {
+            buffers.emplace_back(boost::asio::buffer(i.header));
+            buffers.emplace_back(boost::asio::buffer(i.message));
+        }
+
+        boost::asio::async_write(socket_, buffers,
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this(), generation = generation_, frames = writing_]
+                        (boost::system::error_code const &ec, std::size_t)
+                        {
+                            if (generation != self->generation_)
+                                return;
+
+                            self->writing_.reset();
+
+                            if (ec)
+                            {
+                                self->on_error(ec);
+                                return;
+                            }
+
+                            if (!self->outbox_.empty())
+                                self->write_outbox();
+                        }
+                    )
+            );
+    }
+
+    void on_error(boost::system::error_code const &ec)
+    {
+        if (!calls_.empty() && ec != boost::asio::error::operation_aborted)
+        {
+            utility::handle_error<exception::client>({error_reporter_, name_},
+                    std::make_exception_ptr(std::runtime_error{ec.message()}),
+                    "[nanorpc::tcp::detail::client::connection] ",
+                    "The connection has been lost.");
+        }
+
+        reset(make_error("The connection to \"" + name_ + "\" has been lost. " + ec.message()));
+    }
+};
+
+class client
+    : public std::enable_shared_from_this<client>
+{
+public:
+    // All servers share the workers, every server has its own connection.
+    client(tcp::endpoints const &endpoints, std::size_t workers, core::type::error_handler error_handler)
+        : error_reporter_{std::move(error_handler)}
+        , workers_count_{std::max<int>(1, workers)}
+        , context_{workers_count_}
+        , work_guard_{boost::asio::make_work_guard(context_)}
+        , targets_(endpoints.size())
+    {
+        if (endpoints.empty())
+            throw exception::client{"No endpoints."};
+
+        for (std::size_t i = 0 ; i < endpoints.size() ; ++i)
+        {
+            auto &item = targets_[i];
+            item.name = net::get_name(endpoints[i].host, endpoints[i].port);
+
+            boost::system::error_code ec;
+            auto resolved = net::resolve(context_, endpoints[i].host, endpoints[i].port, ec);
+            if (ec)
+                throw exception::client{"Failed to resolve endpoint \"" + item.name + "\""};
+
+            item.channel = std::make_shared<connection>(context_, std::move(resolved), item.name, error_reporter_);
+        }
+    }
+
+    virtual ~client() noexcept
+    {
+        try
+        {
+            if (stopped())
+                return;
+
+            stop();
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::client>(error_reporter_, e,
+                    "[nanorpc::tcp::detail::client::~client] Failed to done.");
+        }
+    }
+
+    void init_executors()
+    {
+        for (std::size_t i = 0 ; i < targets_.size() ; ++i)
+            init_executor(i);
+    }
+
+    void run()
+    {
+        if (!stopped())
+            throw exception::client{"Already running."};
+
+        threads_type workers;
+        workers.reserve(workers_count_);
+
+        for (auto i = workers_count_ ; i ; --i)
+        {
+            workers.emplace_back(
+                    [self = this]
+                    {
+                        try
+                        {
+                            self->context_.run();
+                        }
+                        catch (std::exception const &e)
+                        {
+                            utility::handle_error<exception::client>(self->error_reporter_, e,
+                                    "[nanorpc::tcp::client::run] Failed to run.");
+                            std::exit(EXIT_FAILURE);
+                        }
+                    }
+                );
+        }
+
+        workers_ = std::move(workers);
+    }
+
+    // The calls in flight fail when the workers have been stopped.
+    void stop()
+    {
+        if (stopped())
+            throw exception::client{"Not runned."};
+
+        work_guard_.reset();
+        context_.stop();
+
+        for (auto &i : workers_)
+            i.join();
+
+        workers_.clear();
+
+        auto const error = std::make_exception_ptr(exception::client{"[nanorpc::tcp::client::stop] The client was stopped."});
+        for (auto &i : targets_)
+            i.channel->reset(error);
+    }
+
+    bool stopped() const noexcept
+    {
+        return workers_.empty();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return targets_.size();
+    }
+
+    core::type::executor const& get_executor(std::size_t index) const
+    {
+        return get_target(index).executor;
+    }
+
+    core::type::async_executor const& get_async_executor(std::size_t index) const
+    {
+        return get_target(index).async_executor;
+    }
+
+private:
+    using threads_type = std::vector<std::thread>;
+
+    struct target final
+    {
+        // host:port or unix:<path>
+        std::string name;
+        std::shared_ptr<connection> channel;
+        core::type::executor executor;
+        core::type::async_executor async_executor;
+    };
+
+    // The workers report the errors till they are joined.
+    core::error_reporter error_reporter_;
+    int workers_count_;
+    boost::asio::io_context context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+
+    std::vector<target> targets_;
+    threads_type workers_;
+
+    target const& get_target(std::size_t index) const
+    {
+        if (index >= targets_.size())
+            throw exception::client{"[nanorpc::tcp::client] Bad index of the server."};
+        return targets_[index];
+    }
+
+    // The deadline of the call is taken from the budget of the request.
+    void init_executor(std::size_t index)
+    {
+        auto async_executor = [this_ = std::weak_ptr{shared_from_this()}, index]
+            (core::type::buffer request, core::type::completion done)
+            {
+                auto self = this_.lock();
+                if (!self)
+                {
+                    done(std::make_exception_ptr(exception::client{"No owner object."}), {});
+                    return;
+                }
+
+                if (self->stopped())
+                {
+                    done(std::make_exception_ptr(exception::client{"The client was not started."}), {});
+                    return;
+                }
+
+                core::detail::header request_header;
+                auto token = request_header.read(request) ?
+                        core::stop_token::from_budget(request_header.budget) : core::stop_token{};
+
+                self->targets_[index].channel->send(std::move(request), std::move(done), std::move(token));
+            };
+
+        auto executor = [async_executor] (core::type::buffer request)
+            {
+                auto promise = std::make_shared<std::promise<core::type::buffer>>();
+                auto future = promise->get_future();
+
+                async_executor(std::move(request), [promise] (std::exception_ptr exception, core::type::buffer response)
+                        {
+                            if (exception)
+                                promise->set_exception(std::move(exception));
+                            else
+                                promise->set_value(std::move(response));
+                        }
+                    );
+
+                return future.get();
+            };
+
+        targets_[index].executor = std::move(executor);
+        targets_[index].async_executor = std::move(async_executor);
+    }
+};
+
+}   // namespace
+}   // namespace detail
+
+class client::impl final
+    : public detail::client
+{
+public:
+    using detail::client::client;
+};
+
+client::client(std::string_view host, std::string_view port, std::size_t workers,
+        core::type::error_handler error_handler)
+    : client{endpoints{{std::string{host}, std::string{port}}}, workers, std::move(error_handler)}
+{
+}
+
+client::client(endpoints const &servers, std::size_t workers, core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(servers, workers, std::move(error_handler))}
+{
+    impl_->init_executors();
+}
+
+client::~client() noexcept
+{
+    impl_.reset();
+}
+
+void client::run()
+{
+    impl_->run();
+}
+
+void client::stop()
+{
+    impl_->stop();
+}
+
+bool client::stopped() const noexcept
+{
+    return impl_->stopped();
+}
+
+std::size_t client::size() const noexcept
+{
+    return impl_->size();
+}
+
+core::type::executor const& client::get_executor(std::size_t index) const
+{
+    return impl_->get_executor(index);
+}
+
+core::type::async_executor const& client::get_async_executor(std::size_t index) const
+{
+    return impl_->get_async_executor(index);
+}
+
+}   // namespace nanorpc::tcp
@@ -0,0 +1,99 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+#ifndef __NANO_RPC_TCP_DETAIL_FRAME_H__
+#define __NANO_RPC_TCP_DETAIL_FRAME_H__
+
+// STD
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// NANORPC
+#include "nanorpc/core/type.h"
+
+namespace nanorpc::tcp::detail
+{
+
+// Every message on the connection is prefixed by the frame header. The id of the frame
+// is chosen by the client and returned with the response, so many calls can be in flight
+// on one connection and their responses can come in any order. The frame id is apart from
+// the request id of the message, which belongs to the core (e.g. the subscriptions).
+//
+// Layout (all fields are little-endian):
+//   0  size            u32     the size of the message after the header
+//   4  status          u32     0 - the message, otherwise the server has failed and the message is the error text
+//   8  id              u64
+struct frame_header final
+{
+    static constexpr std::size_t size = 16;
+    // The bound of the message, the connection with a bigger one is closed.
+    static constexpr std::uint32_t max_message_size = 256 * 1024 * 1024;
+
+    static constexpr std::uint32_t status_good = 0;
+    static constexpr std::uint32_t status_fail = 1;
+
+    using buffer_type = std::array<char, size>;
+
+    std::uint32_t message_size = 0;
+    std::uint32_t status = status_good;
+    std::uint64_t id = 0;
+
+    void read(buffer_type const &data) noexcept
+    {
+        message_size = get<std::uint32_t>(data.data());
+        status = get<std::uint32_t>(data.data() + 4);
+        id = get<std::uint64_t>(data.data() + 8);
+    }
+
+    buffer_type write() const noexcept
+    {
+        buffer_type data;
+        put(data.data(), message_size);
+        put(data.data() + 4, status);
+        put(data.data() + 8, id);
+        return data;
+    }
+
+private:
+    template <typename T>
+    static T get(char const *data) noexcept
+    {
+        T value = 0;
+        for (std::size_t i = 0 ; i < sizeof(T) ; ++i)
+            value |= static_cast<T>(static_cast<std::uint8_t>(data[i])) << (i * 8);
+        return value;
+    }
+
+    template <typename T>
+    static void put(char *data, T value) noexcept
+    {
+        for (std::size_t i = 0 ; i < sizeof(T) ; ++i)
+            data[i] = static_cast<char>(static_cast<std::uint8_t>(value >> (i * 8)));
+    }
+};
+
+// The header and the message are written by one gathered write.
+struct frame final
+{
+    frame_header::buffer_type header;
+    core::type::buffer message;
+};
+
+inline frame make_frame(std::uint64_t id, std::uint32_t status, core::type::buffer message)
+{
+    frame_header header;
+    header.message_size = static_cast<std::uint32_t>(message.size());
+    header.status = status;
+    header.id = id;
+
+    return {header.write(), std::move(message)};
+}
+
+}   // namespace nanorpc::tcp::detail
+
+#endif  // !__NANO_RPC_TCP_DETAIL_FRAME_H__
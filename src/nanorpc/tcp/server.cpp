@@ -0,0 +1,535 @@
+//-------------------------------------------------------------------
+//  Nano RPC
+//  https://github.com/tdv/nanorpc
+//  Created:     05.2018
+//  Copyright (C) 2018 tdv
+//-------------------------------------------------------------------
+
+// STD
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// BOOST
+#include <boost/asio.hpp>
+
+// NANORPC
+#include "nanorpc/core/detail/config.h"
+#include "nanorpc/core/detail/header.h"
+#include "nanorpc/core/error_reporter.h"
+#include "nanorpc/core/handler_pool.h"
+#include "nanorpc/tcp/server.h"
+
+// THIS
+#include "../http/detail/socket.h"
+#include "../http/detail/utility.h"
+#include "detail/frame.h"
+
+namespace nanorpc::tcp
+{
+namespace detail
+{
+namespace
+{
+
+namespace net = http::detail::net;
+namespace utility = http::detail::utility;
+
+// The frames are read one after another on the strand of the session and every call is
+// executed by the handler pool, so the calls of the connection are executed at the same time.
+// Their responses are written in the order of completion; the frames completed while a write
+// is in progress are gathered into the next one.
+class session final
+    : public std::enable_shared_from_this<session>
+{
+public:
+    session(boost::asio::io_context &context, net::socket_type socket,
+            core::type::async_executor const &executor, core::handler_pool &handler_pool,
+            core::error_reporter &error_reporter)
+        : executor_{executor}
+        , handler_pool_{handler_pool}
+        , error_reporter_{error_reporter}
+        , context_{context}
+        , socket_{std::move(socket)}
+        , strand_{context.get_executor()}
+        , peer_{net::get_peer_name(socket_)}
+    {
+        boost::system::error_code ec;
+        net::set_no_delay(socket_, ec);
+    }
+
+    void run()
+    {
+        boost::asio::post(strand_, [self = shared_from_this()] { self->read(); });
+    }
+
+private:
+    using strand_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    core::type::async_executor const &executor_;
+    core::handler_pool &handler_pool_;
+    core::error_reporter &error_reporter_;
+
+    boost::asio::io_context &context_;
+    net::socket_type socket_;
+    strand_type strand_;
+    std::string peer_;
+
+    frame_header::buffer_type header_;
+    std::vector<frame> outbox_;
+    std::vector<frame> writing_;
+
+    utility::error_source get_error_source()
+    {
+        return {error_reporter_, peer_};
+    }
+
+    void read()
+    {
+        boost::asio::async_read(socket_, boost::asio::buffer(header_),
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this()] (boost::system::error_code const &ec, std::size_t)
+                        {
+                            if (ec)
+                            {
+                                self->on_error(ec, "[nanorpc::tcp::detail::server::session::read] ");
+                                return;
+                            }
+
+                            frame_header header;
+                            header.read(self->header_);
+                            if (header.message_size > frame_header::max_message_size)
+                            {
+                                utility::handle_error<exception::server>(self->get_error_source(),
+                                        "[nanorpc::tcp::detail::server::session::read] ",
+                                        "The message is too large.");
+                                self->close();
+                                return;
+                            }
+
+                            self->read_message(header.id, header.message_size);
+                        }
+                    )
+            );
+    }
+
+    void read_message(std::uint64_t id, std::size_t size)
+    {
+        auto message = std::make_shared<core::type::buffer>(size);
+
+        boost::asio::async_read(socket_, boost::asio::buffer(*message),
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this(), id, message] (boost::system::error_code const &ec, std::size_t)
+                        {
+                            if (ec)
+                            {
+                                self->on_error(ec, "[nanorpc::tcp::detail::server::session::read] ");
+                                return;
+                            }
+
+                            self->read();
+
+                            // The handler pool takes the method of the call from the header of the message.
+                            core::detail::header message_header;
+                            auto const method = message_header.read(*message) ? message_header.id : core::type::id{};
+
+                            try
+                            {
+                                self->handler_pool_.execute(method, [self, id, message]
+                                        {
+                                            self->execute(id, std::move(*message));
+                                        }
+                                    );
+                            }
+                            catch (std::exception const &e)
+                            {
+                                self->reject(id, e);
+                            }
+                        }
+                    )
+            );
+    }
+
+    // The executor can complete the call on another thread, the response is written on the strand.
+    void execute(std::uint64_t id, core::type::buffer message)
+    {
+        auto on_executed = [self = shared_from_this(), id] (std::exception_ptr error, core::type::buffer response)
+            {
+                auto status = frame_header::status_good;
+
+                if (error)
+                {
+                    utility::handle_error<exception::server>(self->get_error_source(), error,
+                            "[nanorpc::tcp::detail::server::session::execute] ",
+                            "Failed to handle request.");
+
+                    std::string const text = "Handling error.";
+                    response.assign(std::begin(text), std::end(text));
+                    status = frame_header::status_fail;
+                }
+
+                boost::asio::post(self->strand_,
+                        [self, item = make_frame(id, status, std::move(response))] () mutable
+                        {
+                            self->write(std::move(item));
+                        }
+                    );
+            };
+
+        try
+        {
+            executor_(std::move(message), std::move(on_executed));
+        }
+        catch (std::exception const &e)
+        {
+            reject(id, e);
+        }
+    }
+
+    void reject(std::uint64_t id, std::exception const &e)
+    {
+        utility::handle_error<exception::server>(get_error_source(), e,
+                "[nanorpc::tcp::detail::server::session::execute] ",
+                "Failed to handle request.");
+
+        std::string const text = "Handling error.";
+        boost::asio::post(strand_,
+                [self = shared_from_this(), item = make_frame(id, frame_header::status_fail, {std::begin(text), std::end(text)})]
+                () mutable
+                {
+                    self->write(std::move(item));
+                }
+            );
+    }
+
+    void write(frame item)
+    {
+        if (!socket_.is_open())
+            return;
+
+        outbox_.push_back(std::move(item));
+        if (writing_.empty())
+            write_outbox();
+    }
+
+    void write_outbox()
+    {
+        std::swap(writing_, outbox_);
+
+        std::vector<boost::asio::const_buffer> buffers;
+        buffers.reserve(writing_.size() * 2);
+        for (auto const &i : writing_)
+        {
+            buffers.emplace_back(boost::asio::buffer(i.header));
+            buffers.emplace_back(boost::asio::buffer(i.message));
+        }
+
+        boost::asio::async_write(socket_, buffers,
+                boost::asio::bind_executor(strand_,
+                        [self = shared_from_this()] (boost::system::error_code const &ec, std::size_t)
+                        {
+                            self->writing_.clear();
+
+                            if (ec)
+                            {
+                                self->on_error(ec, "[nanorpc::tcp::detail::server::session::write] ");
+                                return;
+                            }
+
+                            if (!self->outbox_.empty())
+                                self->write_outbox();
+                        }
+                    )
+            );
+    }
+
+    void on_error(boost::system::error_code const &ec, char const *site)
+    {
+        if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof &&
+                ec != boost::asio::error::connection_reset && ec != boost::asio::error::broken_pipe)
+        {
+            utility::handle_error<exception::server>(get_error_source(),
+                    std::make_exception_ptr(std::runtime_error{ec.message()}),
+                    site, "Failed to transfer data.");
+        }
+
+        close();
+    }
+
+    void close()
+    {
+        if (!socket_.is_open())
+            return;
+
+        boost::system::error_code ec;
+        socket_.shutdown(net::socket_type::shutdown_both, ec);
+        socket_.close(ec);
+    }
+};
+
+class listener final
+    : public std::enable_shared_from_this<listener>
+{
+public:
+    listener(boost::asio::io_context &context, net::endpoint_type const &endpoint,
+            core::type::async_executor const &executor, core::handler_pool &handler_pool,
+            core::error_reporter &error_reporter)
+        : executor_{executor}
+        , handler_pool_{handler_pool}
+        , error_reporter_{error_reporter}
+        , context_{context}
+        , acceptor_{context_}
+        , socket_{context_}
+    {
+        net::listen(acceptor_, endpoint);
+    }
+
+    void run()
+    {
+        utility::post(context_, [self = shared_from_this()] { self->accept(); }, &error_reporter_ );
+    }
+
+    void close()
+    {
+        boost::asio::post(context_, [self = shared_from_this()]
+                {
+                    boost::system::error_code ec;
+                    self->acceptor_.close(ec);
+                }
+            );
+    }
+
+private:
+    core::type::async_executor const &executor_;
+    core::handler_pool &handler_pool_;
+    core::error_reporter &error_reporter_;
+
+    boost::asio::io_context &context_;
+    net::acceptor_type acceptor_;
+    net::socket_type socket_;
+
+    void accept() noexcept
+    {
+        try
+        {
+            acceptor_.async_accept(socket_,
+                    [self = shared_from_this()] (boost::system::error_code const &ec)
+                    {
+                        if (ec == boost::asio::error::operation_aborted)
+                            return;
+
+                        try
+                        {
+                            if (ec)
+                            {
+                                utility::handle_error<exception::server>(self->error_reporter_,
+                                        std::make_exception_ptr(std::runtime_error{ec.message()}),
+                                        "[nanorpc::tcp::detail::listener::accept] ",
+                                        "Failed to accept connection.");
+                            }
+                            else
+                            {
+                                std::make_shared<session>(self->context_, std::move(self->socket_),
+                                        self->executor_, self->handler_pool_, self->error_reporter_)->run();
+                            }
+                        }
+                        catch (std::exception const &e)
+                        {
+                            utility::handle_error<exception::server>(self->error_reporter_, e,
+                                    "[nanorpc::tcp::detail::listener::accept] ",
+                                    "Failed to process the accept method.");
+                        }
+
+                        self->socket_ = net::socket_type{self->context_};
+                        self->accept();
+                    }
+                );
+        }
+        catch (std::exception const &e)
+        {
+            utility::handle_error<exception::server>(error_reporter_, e,
+                    "[nanorpc::tcp::detail::listener::accept] ",
+                    "Failed to call async_accept.");
+        }
+    }
+};
+
+}   // namespace
+}   // namespace detail
+
+class server::impl final
+{
+public:
+    impl(std::string_view address, std::string_view port, std::size_t workers,
+            core::type::async_executor executor, core::handler_options const &options,
+            core::type::error_handler error_handler)
+        : error_reporter_{std::move(error_handler)}
+        , executor_{std::move(executor)}
+        , options_{options}
+        , workers_count_{std::max<int>(1, workers)}
+        , context_{workers_count_}
+        , endpoint_{http::detail::net::make_endpoint(address, port)}
+    {
+    }
+
+    ~impl() noexcept
+    {
+        if (stopped())
+            return;
+
+        try
+        {
+            stop();
+        }
+        catch (std::exception const &e)
+        {
+            http::detail::utility::handle_error<exception::server>(error_reporter_, e,
+                    "[nanorpc::tcp::server::~server] ",
+                    "Failed to stop server.");
+        }
+    }
+
+    void run()
+    {
+        if (!stopped())
+            throw exception::server{"[nanorpc::tcp::server::run] Already running."};
+
+        // Without the shared pool the handlers are run by the workers doing the I/O.
+        auto new_handler_pool = std::make_unique<core::handler_pool>(options_,
+                [this] (std::exception_ptr error)
+                {
+                    http::detail::utility::handle_error<exception::server>(error_reporter_, error,
+                            "[nanorpc::tcp::server::handler_pool] ",
+                            "Failed to run handler.");
+                },
+                [this] (core::type::task task)
+                {
+                    boost::asio::post(context_, std::move(task));
+                }
+            );
+
+        auto new_listener = std::make_shared<detail::listener>(context_, endpoint_, executor_,
+                *new_handler_pool, error_reporter_);
+        new_listener->run();
+
+        threads_type workers;
+        workers.reserve(workers_count_);
+
+        for (auto i = workers_count_ ; i ; --i)
+        {
+            workers.emplace_back(
+                    [self = this]
+                    {
+                        try
+                        {
+                            self->context_.run();
+                        }
+                        catch (std::exception const &e)
+                        {
+                            http::detail::utility::handle_error<exception::server>(self->error_reporter_, e,
+                                    "[nanorpc::tcp::server::run] ",
+                                    "Failed to run server.");
+
+                            std::exit(EXIT_FAILURE);
+                        }
+                    }
+                );
+        }
+
+        handler_pool_ = std::move(new_handler_pool);
+        listener_ = std::move(new_listener);
+        workers_ = std::move(workers);
+    }
+
+    void stop()
+    {
+        if (stopped())
+            throw exception::server{"[nanorpc::tcp::server::stop] Not runned."};
+
+        listener_->close();
+        listener_.reset();
+        context_.stop();
+
+        for (auto &i : workers_)
+            i.join();
+
+        workers_.clear();
+
+        // The handlers still running complete their calls to the stopped sessions.
+        handler_pool_.reset();
+        http::detail::net::remove_unix_file(endpoint_);
+    }
+
+    bool stopped() const noexcept
+    {
+        return !listener_;
+    }
+
+private:
+    using threads_type = std::vector<std::thread>;
+
+    // The reporter is destroyed the last, the sessions are destroyed with the context.
+    core::error_reporter error_reporter_;
+    core::type::async_executor executor_;
+    core::handler_options options_;
+
+    int workers_count_;
+    boost::asio::io_context context_;
+    http::detail::net::endpoint_type endpoint_;
+    std::shared_ptr<detail::listener> listener_;
+    threads_type workers_;
+    std::unique_ptr<core::handler_pool> handler_pool_;
+};
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::executor executor, core::type::error_handler error_handler)
+    : server{std::move(address), std::move(port), workers,
+            core::type::async_executor{[func = std::move(executor)] (core::type::buffer request, core::type::completion done)
+                {
+                    done(nullptr, func(std::move(request)));
+                }
+            },
+            std::move(error_handler)}
+{
+}
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::async_executor executor, core::type::error_handler error_handler)
+    : server{std::move(address), std::move(port), workers, std::move(executor),
+            core::make_handler_options(workers), std::move(error_handler)}
+{
+}
+
+server::server(std::string_view address, std::string_view port, std::size_t workers,
+        core::type::async_executor executor, core::handler_options const &options,
+        core::type::error_handler error_handler)
+    : impl_{std::make_shared<impl>(std::move(address), std::move(port), workers,
+            std::move(executor), options, std::move(error_handler))}
+{
+}
+
+server::~server() noexcept
+{
+}
+
+void server::run()
+{
+    impl_->run();
+}
+
+void server::stop()
+{
+    impl_->stop();
+}
+
+bool server::stopped() const noexcept
+{
+    return impl_->stopped();
+}
+
+}   // namespace nanorpc::tcp